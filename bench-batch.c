@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* compares feeding batches to insertRBT one value at a time against
+ * insertManyRBT, for batch sizes in the range an ingestion pipeline delivers
+ * usage: bench-batch [tree size] [values per batch size]
+ */
+
+static double
+since(clock_t start)
+    {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+    }
+
+static RBT *
+tree(int n)
+    {
+    int i;
+    RBT *p = newRBT(compareINTEGER);
+    setRBTfree(p,freeINTEGER);
+    void **batch = malloc(sizeof(void *) * n);
+    for (i = 0; i < n; ++i)
+        batch[i] = newINTEGER(random());
+    insertManyRBT(p,batch,n);
+    free(batch);
+    return p;
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, b, n = argc > 1 ? atoi(argv[1]) : 1000000;
+    int total = argc > 2 ? atoi(argv[2]) : 1000000;
+    int sizes[] = { 10000, 100000, 1000000 };
+    void **batch = malloc(sizeof(void *) * total);
+    for (b = 0; b < 3; ++b)
+        {
+        int size = sizes[b] < total ? sizes[b] : total;
+        srandom(34);
+        RBT *p = tree(n);
+        clock_t start = clock();
+        for (i = 0; i < total; ++i)
+            insertRBT(p,newINTEGER(random()));
+        double single = since(start);
+        freeRBT(p);
+
+        srandom(34);
+        p = tree(n);
+        start = clock();
+        for (i = 0; i < total; i += size)
+            {
+            int j, count = total - i < size ? total - i : size;
+            for (j = 0; j < count; ++j)
+                batch[j] = newINTEGER(random());
+            insertManyRBT(p,batch,count);
+            }
+        double batched = since(start);
+        printf("%d values into %d, batches of %7d: insertRBT %.3fs, "
+            "insertManyRBT %.3fs, speedup %.2fx\n",
+            total,n,size,single,batched,single / batched);
+        freeRBT(p);
+        }
+    free(batch);
+    return 0;
+    }
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "rbt.h"
+#include "string.h"
+#include "interpreter.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* compares running a command file, mostly lookups, in the text form with
+ * running it after conversion to the binary form, each against the same
+ * small corpus
+ * usage: bench-binary [commands]
+ */
+
+#define CORPUS "bench-binary.corpus"
+#define TEXT "bench-binary.commands"
+#define BINARY "bench-binary.binary"
+
+static double
+since(clock_t start)
+    {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+    }
+
+static void
+word(FILE *fp,long k)
+    {
+    int j;
+    for (j = 0; j < 6; ++j, k /= 26) fputc((j ? 'a' : 'A') + k % 26,fp);
+    }
+
+static RBT *
+newTree(void)
+    {
+    RBT *p = newRBT(compareSTRING);
+    setRBTfree(p,freeSTRING);
+    setRBTdisplay(p,displaySTRING);
+    return p;
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, n = argc > 1 ? atoi(argv[1]) : 2000000;
+    clock_t start;
+    srandom(50);
+    FILE *fp = fopen(CORPUS,"w");
+    for (i = 0; i < 20000; ++i)
+        {
+        word(fp,random() % 10000);
+        fputc(i % 10 == 9 ? '\n' : ' ',fp);
+        }
+    fclose(fp);
+    fp = fopen(TEXT,"w");
+    for (i = 0; i < n; ++i)
+        {
+        int r = random() % 20;
+        fputs(r == 0 ? "i " : r == 1 ? "d " : "f ",fp);
+        word(fp,random() % 20000);
+        fputc('\n',fp);
+        }
+    fclose(fp);
+    FILE *sink = fopen("/dev/null","w");
+    char *args[] = { "trees", "-b", TEXT, BINARY, 0 };
+
+    start = clock();
+    CompileCommands(args,sink);
+    printf("%d commands converted once: %.3fs\n",n,since(start));
+
+    RBT *p = newTree();
+    start = clock();
+    readRBTCorpus(p,CORPUS);
+    double loaded = since(start);
+    freeRBT(p);
+
+    // the best of three runs of each form, less the corpus load
+    double text = 0, binary = 0;
+    for (i = 0; i < 6; ++i)
+        {
+        args[1] = i % 2 ? "-rb" : "-r";
+        args[2] = CORPUS;
+        args[3] = i % 2 ? BINARY : TEXT;
+        p = newTree();
+        start = clock();
+        if (i % 2) RBTBinary(p,args,sink);
+        else RBTInterpreter(p,args,sink);
+        double took = since(start) - loaded;
+        freeRBT(p);
+        double *best = i % 2 ? &binary : &text;
+        if (i < 2 || took < *best) *best = took;
+        }
+    printf("text commands: %.3fs\n",text);
+    printf("binary commands: %.3fs (%.2fx)\n",binary,binary / text);
+
+    fclose(sink);
+    remove(CORPUS);
+    remove(TEXT);
+    remove(BINARY);
+    return 0;
+    }
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* compares freqRBT and findRBT on a plain RBT against the same tree with a
+ * lookup cache, for a stream that repeats a few keys in bursts
+ * usage: bench-cache [nodes] [lookups]
+ */
+
+#define HOT 32
+#define BURST 1000
+
+static double
+since(clock_t start)
+    {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+    }
+
+static double
+run(RBT *p,INTEGER **keys,int q,long *hits)
+    {
+    int i;
+    *hits = 0;
+    clock_t start = clock();
+    for (i = 0; i < q; ++i)
+        {
+        if (freqRBT(p,keys[i])) ++*hits;
+        if (findRBT(p,keys[i])) ++*hits;
+        }
+    return since(start);
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, n = argc > 1 ? atoi(argv[1]) : 1000000;
+    int q = argc > 2 ? atoi(argv[2]) : 2000000;
+    srandom(43);
+    RBT *p = newRBT(compareINTEGER), *x = newRBT(compareINTEGER);
+    setRBTfree(p,freeINTEGER);
+    setRBTfree(x,freeINTEGER);
+    setRBTcache(x,256,hashINTEGER);
+    int *inserted = malloc(sizeof(int) * n);
+    for (i = 0; i < n; ++i)
+        {
+        int k = inserted[i] = random() % (2 * n);
+        insertRBT(p,newINTEGER(k));
+        insertRBT(x,newINTEGER(k));
+        }
+    printf("trees of %d nodes\n",sizeRBT(p));
+
+    /* each burst draws from HOT keys in the trees; one lookup in ten is of
+     * any key, and about half of those are absent */
+    INTEGER **keys = malloc(sizeof(INTEGER *) * q);
+    int hot[HOT];
+    for (i = 0; i < q; ++i)
+        {
+        int j;
+        if (i % BURST == 0)
+            for (j = 0; j < HOT; ++j) hot[j] = inserted[random() % n];
+        j = random() % 10 ? hot[random() % HOT] : random() % (2 * n);
+        keys[i] = newINTEGER(j);
+        }
+
+    long hits;
+    double plain = run(p,keys,q,&hits);
+    printf("tree:   %d lookups, %ld hits, %.3fs\n",2 * q,hits,plain);
+    double cached = run(x,keys,q,&hits);
+    printf("cached: %d lookups, %ld hits, %.3fs\n",2 * q,hits,cached);
+    printf("speedup: %.2fx\n",plain / cached);
+    statisticsRBT(x,stdout);
+
+    for (i = 0; i < q; ++i)
+        freeINTEGER(keys[i]);
+    free(keys);
+    free(inserted);
+    freeRBT(p);
+    freeRBT(x);
+    return 0;
+    }
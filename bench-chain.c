@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bst.h"
+#include "tnode.h"
+#include "integer.h"
+
+/* times whole-tree walks over a degenerate BST: a single right-leaning chain,
+ * as sorted input would build, but linked directly so the setup is linear
+ * usage: bench-chain [nodes]
+ */
+
+static double
+since(clock_t start)
+    {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+    }
+
+static void
+count(TNODE *n,void *arg)
+    {
+    (void)n;
+    ++*(long *)arg;
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, n = argc > 1 ? atoi(argv[1]) : 10000000;
+    BST *p = newBST(compareINTEGER);
+    setBSTdisplay(p,displayINTEGER);
+    setBSTfree(p,freeINTEGER);
+    FILE *sink = fopen("/dev/null","w");
+    clock_t start = clock();
+    TNODE *last = 0;
+    for (i = 0; i < n; ++i)
+        {
+        TNODE *node = newTNODE(newINTEGER(i),0,0,last);
+        setTNODEfree(node,freeINTEGER);
+        setTNODEdisplay(node,displayINTEGER);
+        if (last == 0) setBSTroot(p,node);
+        else setTNODEright(last,node);
+        last = node;
+        }
+    setBSTsize(p,n);
+    refreshBST(p,last);
+    printf("chain of %d nodes built in %.3fs\n",n,since(start));
+
+    start = clock();
+    statisticsBST(p,stdout);
+    printf("statistics: %.3fs\n",since(start));
+
+    start = clock();
+    depthsBST(p,sink);
+    printf("depth histogram: %.3fs\n",since(start));
+
+    start = clock();
+    long steps = 0;
+    TNODE *c;
+    for (c = firstBST(p); c != 0; c = nextBST(p,c)) ++steps;
+    printf("cursor walk (%ld steps): %.3fs\n",steps,since(start));
+
+    start = clock();
+    INTEGER *lo = newINTEGER(n / 4), *hi = newINTEGER(n / 2);
+    steps = 0;
+    rangeBST(p,lo,hi,count,&steps);
+    printf("range scan (%ld nodes): %.3fs\n",steps,since(start));
+    freeINTEGER(lo);
+    freeINTEGER(hi);
+
+    int level;
+    for (level = 1; level <= 3; ++level)
+        {
+        start = clock();
+        debugBST(p,level);
+        displayBST(p,sink);
+        printf("display at debug level %d: %.3fs\n",level,since(start));
+        }
+
+    start = clock();
+    freeBST(p);
+    printf("teardown: %.3fs\n",since(start));
+    fclose(sink);
+    return 0;
+    }
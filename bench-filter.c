@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* compares freqRBT, findRBT and deleteRBT of mostly absent keys on a plain
+ * RBT against the same tree with a filter, and reports what it costs
+ * usage: bench-filter [nodes] [lookups]
+ */
+
+static double
+since(clock_t start)
+    {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+    }
+
+static double
+run(RBT *p,INTEGER **keys,int q,long *hits)
+    {
+    int i;
+    *hits = 0;
+    clock_t start = clock();
+    for (i = 0; i < q; ++i)
+        {
+        if (freqRBT(p,keys[i])) ++*hits;
+        if (findRBT(p,keys[i])) ++*hits;
+        if (deleteRBT(p,keys[i]) > 0) ++*hits;
+        }
+    return since(start);
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, n = argc > 1 ? atoi(argv[1]) : 1000000;
+    int q = argc > 2 ? atoi(argv[2]) : 2000000;
+    srandom(42);
+    RBT *p = newRBT(compareINTEGER), *x = newRBT(compareINTEGER);
+    setRBTfree(p,freeINTEGER);
+    setRBTfree(x,freeINTEGER);
+    setRBTfilter(x,hashINTEGER);
+    for (i = 0; i < n; ++i)
+        {
+        int k = random() % (2 * n);
+        insertRBT(p,newINTEGER(k));
+        insertRBT(x,newINTEGER(k));
+        insertRBT(p,newINTEGER(k));
+        insertRBT(x,newINTEGER(k));
+        }
+    printf("trees of %d nodes\n",sizeRBT(p));
+
+    // nine keys in ten are absent, as in the text tests
+    INTEGER **keys = malloc(sizeof(INTEGER *) * q);
+    for (i = 0; i < q; ++i)
+        keys[i] = newINTEGER(random() % (20 * n));
+
+    long hits;
+    double plain = run(p,keys,q,&hits);
+    printf("tree:     %d lookups, %ld hits, %.3fs\n",3 * q,hits,plain);
+    double filtered = run(x,keys,q,&hits);
+    printf("filtered: %d lookups, %ld hits, %.3fs\n",3 * q,hits,filtered);
+    printf("speedup: %.2fx\n",plain / filtered);
+    statisticsRBT(x,stdout);
+
+    for (i = 0; i < q; ++i)
+        freeINTEGER(keys[i]);
+    free(keys);
+    freeRBT(p);
+    freeRBT(x);
+    return 0;
+    }
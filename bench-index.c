@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* compares freqRBT and findRBT on a plain RBT against the same tree with a
+ * hash index, and reports what the index costs in memory
+ * usage: bench-index [nodes] [lookups]
+ */
+
+static double
+since(clock_t start)
+    {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+    }
+
+static double
+run(RBT *p,INTEGER **keys,int q,long *hits)
+    {
+    int i;
+    *hits = 0;
+    clock_t start = clock();
+    for (i = 0; i < q; ++i)
+        {
+        if (freqRBT(p,keys[i])) ++*hits;
+        if (findRBT(p,keys[i])) ++*hits;
+        }
+    return since(start);
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, n = argc > 1 ? atoi(argv[1]) : 1000000;
+    int q = argc > 2 ? atoi(argv[2]) : 2000000;
+    srandom(40);
+    RBT *p = newRBT(compareINTEGER), *x = newRBT(compareINTEGER);
+    setRBTfree(p,freeINTEGER);
+    setRBTfree(x,freeINTEGER);
+    setRBTindex(x,hashINTEGER);
+    for (i = 0; i < n; ++i)
+        {
+        int k = random() % (2 * n);
+        insertRBT(p,newINTEGER(k));
+        insertRBT(x,newINTEGER(k));
+        }
+    printf("trees of %d nodes\n",sizeRBT(p));
+    printf("index: %ld bytes, %.1f bytes per key\n",indexBytesRBT(x),
+        (double) indexBytesRBT(x) / sizeRBT(x));
+
+    // about half the keys are absent
+    INTEGER **keys = malloc(sizeof(INTEGER *) * q);
+    for (i = 0; i < q; ++i)
+        keys[i] = newINTEGER(random() % (2 * n));
+
+    long hits;
+    double plain = run(p,keys,q,&hits);
+    printf("tree:    %d lookups, %ld hits, %.3fs\n",2 * q,hits,plain);
+    double indexed = run(x,keys,q,&hits);
+    printf("indexed: %d lookups, %ld hits, %.3fs\n",2 * q,hits,indexed);
+    printf("speedup: %.2fx\n",plain / indexed);
+
+    for (i = 0; i < q; ++i)
+        freeINTEGER(keys[i]);
+    free(keys);
+    freeRBT(p);
+    freeRBT(x);
+    return 0;
+    }
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "gst.h"
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* compares one-at-a-time findRBT against batched, prefetching findManyRBT
+ * on a tree meant to be much larger than the last-level cache
+ * usage: bench-lookup [nodes] [lookups]
+ */
+
+#define BATCH 1024
+
+static double
+since(clock_t start)
+    {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, n = argc > 1 ? atoi(argv[1]) : 4000000;
+    int q = argc > 2 ? atoi(argv[2]) : 4000000;
+    srandom(31);
+    RBT *p = newRBT(compareINTEGER);
+    setRBTfree(p,freeINTEGER);
+    for (i = 0; i < n; ++i)
+        insertRBT(p,newINTEGER(random()));
+    printf("tree of %d nodes\n",sizeRBT(p));
+
+    INTEGER **keys = malloc(sizeof(INTEGER *) * q);
+    for (i = 0; i < q; ++i)
+        keys[i] = newINTEGER(random());
+
+    long hits = 0;
+    clock_t start = clock();
+    for (i = 0; i < q; ++i)
+        if (findRBT(p,keys[i])) ++hits;
+    double single = since(start);
+    printf("findRBT:     %d lookups, %ld hits, %.3fs, %.0f lookups/s\n",
+        q,hits,single,q / single);
+
+    void *results[BATCH];
+    hits = 0;
+    start = clock();
+    for (i = 0; i < q; i += BATCH)
+        {
+        int j, count = q - i < BATCH ? q - i : BATCH;
+        findManyRBT(p,(void **)keys + i,count,results);
+        for (j = 0; j < count; ++j)
+            if (results[j]) ++hits;
+        }
+    double batched = since(start);
+    printf("findManyRBT: %d lookups, %ld hits, %.3fs, %.0f lookups/s\n",
+        q,hits,batched,q / batched);
+    printf("speedup: %.2fx\n",single / batched);
+
+    for (i = 0; i < q; ++i)
+        freeINTEGER(keys[i]);
+    free(keys);
+    freeRBT(p);
+    return 0;
+    }
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rbt.h"
+#include "mapped.h"
+#include "string.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* compares a worker building its own RBT of string keys from the tokens
+ * with a worker mapping the same counts published once, then times
+ * lookups in each
+ * usage: bench-mapped [tokens]
+ */
+
+#define MAP "bench-mapped.mapped"
+
+static double
+since(clock_t start)
+    {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+    }
+
+static char *
+text(void *v)
+    {
+    return getSTRING(v);
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, n = argc > 1 ? atoi(argv[1]) : 2000000;
+    srandom(45);
+    char **words = malloc(sizeof(char *) * n);
+    for (i = 0; i < n; ++i)
+        {
+        words[i] = malloc(12);
+        sprintf(words[i],"w%ld",random() % (n / 4));
+        }
+
+    RBT *p = newRBT(compareSTRING);
+    setRBTfree(p,freeSTRING);
+    clock_t start = clock();
+    for (i = 0; i < n; ++i)
+        insertRBT(p,newSTRING(strcpy(malloc(strlen(words[i]) + 1),words[i])));
+    double built = since(start);
+    printf("built from %d tokens, %d keys: %.3fs\n",n,sizeRBT(p),built);
+    start = clock();
+    publishRBT(p,MAP,text);
+    printf("published once: %.3fs\n",since(start));
+    start = clock();
+    MAPPED *m = openMAPPED(MAP);
+    double opened = since(start);
+    printf("mapped: %d keys, %ld bytes: %.6fs\n",sizeMAPPED(m),bytesMAPPED(m),
+        opened);
+
+    long sum = 0;
+    start = clock();
+    for (i = 0; i < n; ++i)
+        {
+        STRING *s = newSTRING(words[i]);
+        sum += freqRBT(p,s);
+        setSTRING(s,0);
+        freeSTRING(s);
+        }
+    double tree = since(start);
+    start = clock();
+    for (i = 0; i < n; ++i) sum -= freqMAPPED(m,words[i]);
+    double mapped = since(start);
+    printf("lookups: tree %.3fs, mapped %.3fs, %s\n",tree,mapped,
+        sum == 0 ? "same counts" : "counts differ");
+    closeMAPPED(m);
+    remove(MAP);
+    freeRBT(p);
+    for (i = 0; i < n; ++i) free(words[i]);
+    free(words);
+    return 0;
+    }
@@ -0,0 +1,67 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "gst.h"
+#include "pool.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* times mergeGST folding per-shard word counts into one tree as the pool
+ * grows from 1 to 32 threads; keys are skewed so that shards overlap
+ * heavily on the common ones, like word counts do
+ * usage: bench-merge [shards] [inserts per shard]
+ */
+
+static double
+now(void)
+    {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+    }
+
+static GST *
+shard(int inserts)
+    {
+    int i;
+    GST *g = newGST(compareINTEGER);
+    setGSTfree(g,freeINTEGER);
+    for (i = 0; i < inserts; ++i)
+        {
+        insertGST(g,newINTEGER(random() % (1 + random() % 2000000)));
+        }
+    return g;
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, threads, shards = argc > 1 ? atoi(argv[1]) : 32;
+    int inserts = argc > 2 ? atoi(argv[2]) : 100000;
+    GST **trees = malloc(sizeof(GST *) * shards);
+    double base = 0;
+    for (threads = 1; threads <= 32; threads *= 2)
+        {
+        srandom(33);
+        for (i = 0; i < shards; ++i)
+            trees[i] = shard(inserts);
+        POOL *pool = newPOOL(threads);
+        setGSTpool(trees[0],pool);
+        double start = now();
+        GST *all = mergeGST(trees,shards);
+        double took = now() - start;
+        if (threads == 1) base = took;
+        TNODE *root = getGSTroot(all);
+        printf("%2d threads: %d shards of %d into %d keys, %d duplicates, "
+            "depth %d, %.3fs, speedup %.2fx\n",threads,shards,inserts,
+            sizeGST(all),duplicatesGST(all),getTNODEmaxDepth(root),took,
+            base / took);
+        freeGST(all);
+        freePOOL(pool);
+        }
+    free(trees);
+    return 0;
+    }
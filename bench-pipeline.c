@@ -0,0 +1,141 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include "rbt.h"
+#include "pipeline.h"
+#include "string.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* compares reading, running and answering a stream of 'i' and 'f'
+ * commands one after another on one thread with the same three stages
+ * run as a pipeline; with a CPU for each stage, the pipeline's time
+ * approaches that of its slowest stage
+ * usage: bench-pipeline [commands]
+ */
+
+typedef struct command
+    {
+    int op;
+    char *key;
+    } COMMAND;
+
+typedef struct run
+    {
+    FILE *in;
+    RBT *tree;
+    } RUN;
+
+static double
+since(struct timespec *start)
+    {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return now.tv_sec - start->tv_sec + (now.tv_nsec - start->tv_nsec) / 1e9;
+    }
+
+// a command is a letter and a word, folded to lower case
+static void *
+parse(void *arg)
+    {
+    RUN *r = arg;
+    char op, word[64];
+    if (fscanf(r->in," %c %63s",&op,word) != 2) return 0;
+    COMMAND *c = malloc(sizeof(COMMAND));
+    int i, n = 0;
+    for (i = 0; word[i]; ++i)
+        if (isalpha((unsigned char) word[i])) word[n++] = tolower(word[i]);
+    word[n] = '\0';
+    c->op = op;
+    c->key = strcpy(malloc(n + 1),word);
+    return c;
+    }
+
+static void
+execute(void *item,FILE *out,void *arg)
+    {
+    RUN *r = arg;
+    COMMAND *c = item;
+    if (c == 0) return;
+    STRING *s = newSTRING(c->key);
+    if (c->op == 'i') insertRBT(r->tree,s);
+    else
+        {
+        fprintf(out,"Frequency of \"%s\": %d\n",c->key,freqRBT(r->tree,s));
+        freeSTRING(s);
+        }
+    free(c);
+    }
+
+static RUN
+start(char *text,size_t size)
+    {
+    RUN r;
+    r.in = fmemopen(text,size,"r");
+    r.tree = newRBT(compareSTRING);
+    setRBTfree(r.tree,freeSTRING);
+    return r;
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, n = argc > 1 ? atoi(argv[1]) : 1000000;
+    struct timespec begin;
+    char *text = 0;
+    size_t size = 0;
+    srandom(49);
+    FILE *fp = open_memstream(&text,&size);
+    for (i = 0; i < n; ++i)
+        {
+        // keys are letters, as the interpreter keeps nothing else
+        long k = random() % (n / 8);
+        char word[8];
+        int j;
+        for (j = 0; j < 6; ++j, k /= 26) word[j] = (j ? 'a' : 'A') + k % 26;
+        word[j] = '\0';
+        fprintf(fp,"%c %s\n",random() % 2 ? 'i' : 'f',word);
+        }
+    fclose(fp);
+    FILE *sink = fopen("/dev/null","w");
+    printf("%d commands, %ld CPUs\n",n,sysconf(_SC_NPROCESSORS_ONLN));
+
+    RUN r = start(text,size);
+    void *item;
+    clock_gettime(CLOCK_MONOTONIC,&begin);
+    while ((item = parse(&r)) != 0)
+        {
+        free(((COMMAND *) item)->key);
+        free(item);
+        }
+    double parsing = since(&begin);
+    fclose(r.in);
+    freeRBT(r.tree);
+
+    r = start(text,size);
+    clock_gettime(CLOCK_MONOTONIC,&begin);
+    while ((item = parse(&r)) != 0)
+        execute(item,sink,&r);
+    fflush(sink);
+    double serial = since(&begin);
+    printf("one thread: %.3fs, of which parsing %.3fs\n",serial,parsing);
+    fclose(r.in);
+    freeRBT(r.tree);
+
+    r = start(text,size);
+    clock_gettime(CLOCK_MONOTONIC,&begin);
+    runPIPELINE(parse,execute,&r,sink,4096);
+    double piped = since(&begin);
+    printf("pipelined: %.3fs (%.2fx)\n",piped,piped / serial);
+    fclose(r.in);
+    freeRBT(r.tree);
+
+    fclose(sink);
+    free(text);
+    return 0;
+    }
@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "rbt.h"
+#include "prbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* compares inserts and deletes on an RBT with the same changes made to a
+ * persistent RBT, first dropping each old version and then keeping one
+ * version in every thousand, as readers holding snapshots would
+ * usage: bench-prbt [changes]
+ */
+
+static double
+since(clock_t start)
+    {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, n = argc > 1 ? atoi(argv[1]) : 1000000;
+    srandom(47);
+    int *keys = malloc(sizeof(int) * n);
+    for (i = 0; i < n; ++i) keys[i] = random() % (n / 2);
+
+    RBT *r = newRBT(compareINTEGER);
+    setRBTfree(r,freeINTEGER);
+    clock_t start = clock();
+    for (i = 0; i < n; ++i)
+        {
+        if (i % 4 != 3) insertRBT(r,newINTEGER(keys[i]));
+        else
+            {
+            INTEGER *k = newINTEGER(keys[i - 1]);
+            INTEGER *held = findRBT(r,k);
+            if (held && deleteRBT(r,k) == 0) freeINTEGER(held);
+            freeINTEGER(k);
+            }
+        }
+    double plain = since(start);
+    printf("RBT, %d changes: %.3fs, %d keys\n",n,plain,sizeRBT(r));
+    freeRBT(r);
+
+    int keep;
+    for (keep = 0; keep <= 1; ++keep)
+        {
+        PRBT *t = newPRBT(compareINTEGER), *first = t;
+        PRBT **kept = malloc(sizeof(PRBT *) * (n / 1000 + 1));
+        int held = 0;
+        setPRBTfree(t,freeINTEGER);
+        start = clock();
+        for (i = 0; i < n; ++i)
+            {
+            PRBT *next;
+            if (i % 4 != 3) next = insertPRBT(t,newINTEGER(keys[i]));
+            else
+                {
+                INTEGER *k = newINTEGER(keys[i - 1]);
+                next = deletePRBT(t,k);
+                freeINTEGER(k);
+                }
+            if (keep && i % 1000 == 0) kept[held++] = t;
+            else if (t != first) freePRBT(t);
+            t = next;
+            }
+        double took = since(start);
+        printf("PRBT, %s: %.3fs (%.2fx), %d keys\n",
+            keep ? "a version in 1000 kept" : "old versions dropped",took,
+            took / plain,sizePRBT(t));
+        if (keep) statisticsPRBT(t,stdout);
+        for (i = 0; i < held; ++i) if (kept[i] != first) freePRBT(kept[i]);
+        freePRBT(t);
+        freePRBT(first);
+        free(kept);
+        }
+    free(keys);
+    return 0;
+    }
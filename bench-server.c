@@ -0,0 +1,127 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "rbt.h"
+#include "server.h"
+#include "string.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* compares building an RBT of string keys from the tokens, as each run of
+ * the interpreter does, with asking a server that keeps the tree resident
+ * one lookup at a time, each answer awaited before the next is sent
+ * usage: bench-server [tokens] [lookups]
+ */
+
+#define SOCKET "bench-server.sock"
+
+static RBT *tree;
+
+static double
+since(struct timespec *start)
+    {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return now.tv_sec - start->tv_sec + (now.tv_nsec - start->tv_nsec) / 1e9;
+    }
+
+// a line is a key, answered with its frequency
+static void
+serve(FILE *in,FILE *out,void *arg)
+    {
+    char line[32];
+    (void) arg;
+    while (fgets(line,sizeof(line),in))
+        {
+        line[strcspn(line,"\n")] = '\0';
+        STRING *s = newSTRING(line);
+        fprintf(out,"%d\n",freqRBT(tree,s));
+        setSTRING(s,0);
+        freeSTRING(s);
+        }
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, n = argc > 1 ? atoi(argv[1]) : 1000000;
+    int lookups = argc > 2 ? atoi(argv[2]) : 20000;
+    struct timespec start;
+    char word[32];
+    srandom(48);
+
+    clock_gettime(CLOCK_MONOTONIC,&start);
+    tree = newRBT(compareSTRING);
+    setRBTfree(tree,freeSTRING);
+    for (i = 0; i < n; ++i)
+        {
+        sprintf(word,"w%ld",random() % (n / 4));
+        insertRBT(tree,newSTRING(strcpy(malloc(strlen(word) + 1),word)));
+        }
+    double built = since(&start);
+    printf("built from %d tokens, %d keys: %.3fs\n",n,sizeRBT(tree),built);
+
+    SERVER *s = newSERVER(SOCKET);
+    if (s == 0)
+        {
+        printf("%s could not be listened on\n",SOCKET);
+        return 1;
+        }
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0)
+        {
+        runSERVER(s,serve,0);
+        freeSERVER(s);
+        freeRBT(tree);
+        exit(0);
+        }
+
+    struct sockaddr_un a;
+    memset(&a,0,sizeof(a));
+    a.sun_family = AF_UNIX;
+    strcpy(a.sun_path,SOCKET);
+    int fd = socket(AF_UNIX,SOCK_STREAM,0);
+    if (connect(fd,(struct sockaddr *)&a,sizeof(a)) != 0)
+        {
+        printf("no server answers at %s\n",SOCKET);
+        return 1;
+        }
+    long sum = 0;
+    clock_gettime(CLOCK_MONOTONIC,&start);
+    for (i = 0; i < lookups; ++i)
+        {
+        int length = sprintf(word,"w%ld\n",random() % (n / 4)), got = 0;
+        if (write(fd,word,length) != length) break;
+        // an answer is one line
+        while (got == 0 || word[got - 1] != '\n')
+            {
+            int more = read(fd,word + got,sizeof(word) - got);
+            if (more <= 0) break;
+            got += more;
+            }
+        sum += atoi(word);
+        }
+    double asked = since(&start);
+    printf("%d lookups through the server: %.3fs, %.1f microseconds each\n",
+        lookups,asked,asked / lookups * 1e6);
+    printf("loads of the tree the server saved: one per run, %.0f lookups' "
+        "worth each\n",built / (asked / lookups));
+    printf("(checksum %ld)\n",sum);
+
+    close(fd);
+    kill(child,SIGTERM);
+    waitpid(child,0,0);
+    freeSERVER(s);
+    freeRBT(tree);
+    return 0;
+    }
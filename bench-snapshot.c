@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "rbt.h"
+#include "string.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* compares building an RBT of string keys by insertion with loading the
+ * same tree from a snapshot
+ * usage: bench-snapshot [tokens]
+ */
+
+#define SNAP "bench-snapshot.snapshot"
+
+static double
+since(clock_t start)
+    {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+    }
+
+static RBT *
+newTree(void)
+    {
+    RBT *p = newRBT(compareSTRING);
+    setRBTfree(p,freeSTRING);
+    setRBTdisplay(p,displaySTRING);
+    return p;
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, n = argc > 1 ? atoi(argv[1]) : 2000000;
+    srandom(44);
+    char **words = malloc(sizeof(char *) * n);
+    for (i = 0; i < n; ++i)
+        {
+        words[i] = malloc(12);
+        sprintf(words[i],"w%ld",random() % (n / 4));
+        }
+
+    RBT *p = newTree();
+    clock_t start = clock();
+    for (i = 0; i < n; ++i) insertRBT(p,newSTRING(words[i]));
+    double inserted = since(start);
+    printf("inserted %d tokens, %d keys: %.3fs\n",n,sizeRBT(p),inserted);
+    start = clock();
+    saveRBT(p,SNAP,writeSTRING);
+    printf("saved: %.3fs\n",since(start));
+
+    RBT *q = newTree();
+    start = clock();
+    int result = loadRBT(q,SNAP,readSTRING);
+    double loaded = since(start);
+    printf("loaded (%d): %d keys, %d duplicates: %.3fs\n",result,sizeRBT(q),
+        duplicatesRBT(q),loaded);
+    printf("speedup: %.2fx\n",inserted / loaded);
+    remove(SNAP);
+    free(words);
+    freeRBT(p);
+    freeRBT(q);
+    return 0;
+    }
@@ -0,0 +1,137 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rbt.h"
+#include "wal.h"
+#include "string.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* times a stream of inserts and deletes on an RBT of string keys, then
+ * the writing of a write-ahead log of them, committing every 1024 changes,
+ * and then the recovery of the logged tree
+ * usage: bench-wal [changes] [group]
+ */
+
+#define LOG "bench-wal.log"
+#define ROUNDS 5
+
+static double
+now(void)
+    {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+    }
+
+static void
+clear(void)
+    {
+    remove(LOG);
+    remove(LOG ".1");
+    }
+
+static RBT *
+newTree(void)
+    {
+    RBT *p = newRBT(compareSTRING);
+    setRBTfree(p,freeSTRING);
+    return p;
+    }
+
+static void
+apply(int op,char *key,int length,void *tree)
+    {
+    STRING *s = newSTRING(strcpy(malloc(length + 1),key));
+    if (op == 'i')
+        {
+        insertRBT(tree,s);
+        return;
+        }
+    STRING *held = findRBT(tree,s);
+    if (held && deleteRBT(tree,s) == 0) freeSTRING(held);
+    freeSTRING(s);
+    }
+
+static int
+save(char *path,void *tree)
+    {
+    return saveRBT(tree,path,writeSTRING);
+    }
+
+int
+main(int argc,char **argv)
+    {
+    int i, round, n = argc > 1 ? atoi(argv[1]) : 500000;
+    int group = argc > 2 ? atoi(argv[2]) : 1024;
+    srandom(46);
+    char **keys = malloc(sizeof(char *) * n);
+    char *ops = malloc(n);
+    for (i = 0; i < n; ++i)
+        {
+        keys[i] = malloc(12);
+        sprintf(keys[i],"w%ld",random() % (n / 4));
+        ops[i] = random() % 4 ? 'i' : 'd';
+        }
+
+    // the log's cost is small beside the noise in timing the tree, so it
+    // is timed apart, over the same changes, and the fastest of ROUNDS
+    // runs of each kept
+    double plain = 1e9, alone = 1e9, start, took;
+    for (round = 0; round < ROUNDS; ++round)
+        {
+        RBT *p = newTree();
+        start = now();
+        for (i = 0; i < n; ++i) apply(ops[i],keys[i],strlen(keys[i]),p);
+        took = now() - start;
+        if (took < plain) plain = took;
+        freeRBT(p);
+
+        clear();
+        start = now();
+        WAL *w = openWAL(LOG,group);
+        for (i = 0; i < n; ++i) logWAL(w,ops[i],keys[i],strlen(keys[i]));
+        closeWAL(w);
+        took = now() - start;
+        if (took < alone) alone = took;
+        }
+    printf("%d changes, no log: %.3fs\n",n,plain);
+    printf("logging them, a commit every %d: %.3fs, overhead %.1f%%\n",
+        group,alone,100 * alone / plain);
+
+    clear();
+    WAL *w = openWAL(LOG,group);
+    RBT *q = newTree();
+    for (i = 0; i < n; ++i)
+        {
+        if (i == n / 2)
+            {
+            start = now();
+            checkpointWAL(w,save,q);
+            printf("a checkpoint of %d keys halfway: %.3fs\n",sizeRBT(q),
+                now() - start);
+            }
+        logWAL(w,ops[i],keys[i],strlen(keys[i]));
+        apply(ops[i],keys[i],strlen(keys[i]),q);
+        }
+    closeWAL(w);
+
+    RBT *r = newTree();
+    start = now();
+    w = openWAL(LOG,group);
+    loadRBT(r,snapshotWAL(w),readSTRING);
+    long replayed = replayWAL(w,apply,r);
+    printf("recovered from the checkpoint and %ld changes: %.3fs, %s\n",
+        replayed,now() - start,sizeRBT(r) == sizeRBT(q) ? "same size" : "sizes differ");
+    closeWAL(w);
+    clear();
+    freeRBT(q);
+    freeRBT(r);
+    for (i = 0; i < n; ++i) free(keys[i]);
+    free(keys);
+    free(ops);
+    return 0;
+    }
@@ -0,0 +1,142 @@
+/*File: binary.c
+ *Implements functions found in binary.h: command files in a compact
+ *binary form, written once from the text form and then read back with no
+ *more parsing than stepping a pointer through a mapped file
+*/
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "binary.h"
+
+// the first bytes of a command file, the last being the format's version
+#define MAGIC "CMD\001"
+
+/* after the magic, a command is its letter and a count written seven bits
+* a byte, low bits first, the high bit marking more; for 'f', 'd' and 'i'
+* the count is the length of the key, already cleaned, whose bytes follow
+* with a null after them, so a reader may use the key where it lies; for
+* 'k' the count is the k asked for, and for other commands it is 0
+*/
+struct binary {
+  FILE *fp; // when writing
+  const unsigned char *base; // when reading
+  const unsigned char *at;
+  const unsigned char *end;
+};
+
+static int keyed(int op);
+
+// starts a command file at path; returns 0 if it cannot be written
+extern BINARY *createBINARY(char *path) {
+  FILE *fp = fopen(path, "wb");
+  if (fp == 0) {
+    return 0;
+  }
+  BINARY *b = calloc(1, sizeof(BINARY));
+  assert(b != NULL);
+  b->fp = fp;
+  fwrite(MAGIC, 1, 4, fp);
+  return b;
+}
+
+// appends a command; length is the key's length, or the count for 'k'
+extern void putBINARY(BINARY *b, int op, char *key, int length) {
+  fputc(op, b->fp);
+  for (unsigned long n = (unsigned long)length; ; n >>= 7) {
+    fputc((n & 0x7f) | (n >= 0x80 ? 0x80 : 0), b->fp);
+    if (n < 0x80) {
+      break;
+    }
+  }
+  if (keyed(op)) {
+    fwrite(key, 1, length, b->fp);
+    fputc('\0', b->fp);
+  }
+}
+
+// maps the command file at path; returns 0 if it is not one
+extern BINARY *openBINARY(char *path) {
+  int fd = open(path, O_RDONLY);
+  struct stat s;
+  if (fd < 0) {
+    return 0;
+  }
+  if (fstat(fd, &s) != 0 || s.st_size < 4) {
+    close(fd);
+    return 0;
+  }
+  void *base = mmap(0, (size_t)s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    return 0;
+  }
+  if (memcmp(base, MAGIC, 4) != 0) {
+    munmap(base, (size_t)s.st_size);
+    return 0;
+  }
+  posix_madvise(base, (size_t)s.st_size, POSIX_MADV_SEQUENTIAL);
+  BINARY *b = calloc(1, sizeof(BINARY));
+  assert(b != NULL);
+  b->base = base;
+  b->at = b->base + 4;
+  b->end = b->base + s.st_size;
+  return b;
+}
+
+/* steps to the next command, setting its letter, its key, which lies in
+* the mapped file and is null-terminated, and its count; returns 1, 0 at
+* the end of the file, or -1 if the file is cut short
+*/
+extern int nextBINARY(BINARY *b, int *op, char **key, int *length) {
+  const unsigned char *at = b->at;
+  unsigned long n = 0;
+  int shift = 0;
+  if (at == b->end) {
+    return 0;
+  }
+  *op = *at++;
+  do {
+    if (at == b->end || shift > 28) {
+      return -1;
+    }
+    n |= (unsigned long)(*at & 0x7f) << shift;
+    shift += 7;
+  } while (*at++ & 0x80);
+  *length = (int)n;
+  *key = 0;
+  if (keyed(*op)) {
+    if ((unsigned long)(b->end - at) < n + 1 || at[n] != '\0') {
+      return -1;
+    }
+    *key = (char *)at;
+    at += n + 1;
+  }
+  b->at = at;
+  return 1;
+}
+
+// closes the file; returns -1 if a file being written could not be
+extern int closeBINARY(BINARY *b) {
+  int result = 0;
+  if (b->fp) {
+    result = ferror(b->fp) ? -1 : 0;
+    if (fclose(b->fp) != 0) {
+      result = -1;
+    }
+  }
+  else {
+    munmap((void *)b->base, (size_t)(b->end - b->base));
+  }
+  free(b);
+  return result;
+}
+
+static int keyed(int op) {
+  return op == 'f' || op == 'd' || op == 'i';
+}
@@ -0,0 +1,12 @@
+#ifndef __BINARY_INCLUDED__
+#define __BINARY_INCLUDED__
+
+typedef struct binary BINARY;
+
+extern BINARY *createBINARY(char *path);
+extern void    putBINARY(BINARY *b,int op,char *key,int length);
+extern BINARY *openBINARY(char *path);
+extern int     nextBINARY(BINARY *b,int *op,char **key,int *length);
+extern int     closeBINARY(BINARY *b);
+
+#endif
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bst.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+static int
+inOrder(BST *p)
+    {
+    TNODE *n, *prev = 0;
+    for (n = firstBST(p); n != 0; n = nextBST(p,n))
+        {
+        if (prev && compareINTEGER(getTNODEvalue(prev),getTNODEvalue(n)) >= 0)
+            return 0;
+        prev = n;
+        }
+    return 1;
+    }
+
+int
+main(void)
+    {
+    srandom(29);
+    printf("INTEGER test of BST, scapegoat and DSW rebalancing\n");
+    int i;
+    BST *p = newBST(compareINTEGER);
+    setBSTdisplay(p,displayINTEGER);
+    setBSTfree(p,freeINTEGER);
+    for (i = 0; i < 15; ++i)
+        insertBST(p,newINTEGER(i));
+    printf("sorted inserts, no policy:\n");
+    statisticsBST(p,stdout);
+    rebalanceBST(p);
+    printf("after rebalanceBST:\n");
+    debugBST(p,0);
+    displayBST(p,stdout);
+    statisticsBST(p,stdout);
+    freeBST(p);
+
+    p = newBST(compareINTEGER);
+    setBSTdisplay(p,displayINTEGER);
+    setBSTfree(p,freeINTEGER);
+    setBSTbalance(p,0.7);
+    for (i = 0; i < 100000; ++i)
+        insertBST(p,newINTEGER(i));
+    printf("100000 sorted inserts, alpha 0.7:\n");
+    statisticsBST(p,stdout);
+    printf("in order? %s\n",inOrder(p) ? "yes" : "no");
+    for (i = 0; i < 90000; ++i)
+        {
+        INTEGER *a = newINTEGER(random() % 100000);
+        INTEGER *x = findBST(p,a);
+        if (x)
+            {
+            deleteBST(p,a);
+            freeINTEGER(x);
+            }
+        freeINTEGER(a);
+        }
+    printf("after random deletes:\n");
+    statisticsBST(p,stdout);
+    printf("in order? %s\n",inOrder(p) ? "yes" : "no");
+    freeBST(p);
+    return 0;
+    }
@@ -17,6 +17,8 @@ typedef void (*DM)(void * ptr, FILE *fp);
 typedef void (*SM)(TNODE * one, TNODE * two);
 // stores a freeMethod function pointer in BST struct
 typedef void (*FM)(void * ptr);
+// stores an augment function pointer in BST struct
+typedef void (*AM)(TNODE * n);
 
 struct bst {
   TNODE * root;
@@ -26,17 +28,20 @@ struct bst {
   DM displayMethod;
   SM swapper;
   FM freeMethod;
+  int *histogram; // nodes per depth, rebuilt lazily by depthsBST
+  int levels;
+  int stale;
+  double alpha; // scapegoat balance factor, 0 when rebalancing is off
+  int maxSize; // largest size since the last full rebuild
+  int relink; // deletes move nodes instead of values
+  AM augment; // recomputes caller-defined subtree data, 0 for none
 };
 
 static int isLeftChild(TNODE *n);
 static int isRoot(TNODE *n);
 static int isRightChild(TNODE *n);
 static int isLeaf(TNODE *n);
-static int findMinDepth(TNODE *n);
-static int findMaxDepth(TNODE *n);
 static int getDebugVal(BST *t);
-static int min(int x, int y);
-static int max(int x, int y);
 
 static void displayNode(BST *t, TNODE *n, FILE *fp);
 static void displayLevel(BST *t, FILE *fp);
@@ -44,12 +49,38 @@ static void displayInOrder(BST *t, TNODE *n, FILE *fp);
 static void displayPreOrder(BST *t, TNODE *n, FILE *fp);
 static void displayPostOrder(BST *t, TNODE *n, FILE *fp);
 static void freeSubTree(TNODE *n);
+static void countDepths(BST *t);
+static void tour(BST *t, TNODE *start,
+    void (*f)(BST *t, TNODE *n, int when, int depth, void *arg), void *arg);
+static void inOrderStep(BST *t, TNODE *n, int when, int depth, void *arg);
+static void preOrderStep(BST *t, TNODE *n, int when, int depth, void *arg);
+static void postOrderStep(BST *t, TNODE *n, int when, int depth, void *arg);
+static void countStep(BST *t, TNODE *n, int when, int depth, void *arg);
+static void refreshStep(BST *t, TNODE *n, int when, int depth, void *arg);
+static void rebuild(BST *t, TNODE *n);
+static void compress(TNODE *pseudo, int count);
+static int tooDeep(BST *t, int depth);
+static void exchange(BST *t, TNODE *a, TNODE *b);
+static void transplant(BST *t, TNODE *old, TNODE *replacement);
+static void unlinkNode(BST *t, TNODE *n);
+
+// in-order steps fingerBST takes from its hint before searching from the root
+#define FINGER 8
+
+// the three times tour visits a node
+#define PRE 0
+#define IN 1
+#define POST 2
 
 static TNODE * swapVals(TNODE *x, TNODE *y);
 //static void swapVals(TNODE *x, TNODE *y);
 static TNODE *getPred(TNODE *n);
 static TNODE *getSucc(TNODE *n);
 static TNODE *findBSTNode(BST *tree, void *key);
+static TNODE *parentOf(TNODE *n);
+static TNODE *leftmost(TNODE *n);
+static TNODE *rightmost(TNODE *n);
+static TNODE *bound(BST *t, void *key, int below, int strict);
 ////////////////////////////////////////////////////////////////////////////////
 // BST constructor
 extern BST * newBST(int (*c)(void * one, void * two)) {
@@ -63,6 +94,13 @@ extern BST * newBST(int (*c)(void * one, void * two)) {
   //tree->swapper = (void *)swapVals;
   setBSTswapper(tree, (void *)swapVals);
   tree->freeMethod = 0;
+  tree->histogram = 0;
+  tree->levels = 0;
+  tree->stale = 1;
+  tree->alpha = 0;
+  tree->maxSize = 0;
+  tree->relink = 0;
+  tree->augment = 0;
 
   return tree;
 }
@@ -78,6 +116,13 @@ extern void setBSTswapper(BST *t, void (*s)(TNODE * one, TNODE * two)) {
 extern void setBSTfree(BST *t, void (*f)(void * ptr)) {
   t->freeMethod = f;
 }
+/* sets a function that refreshes whatever a wrapping tree caches about the
+* subtree under a node; it runs just after the node's own statistics are
+* recomputed and may read the already refreshed children
+*/
+extern void setBSTaugment(BST *t, void (*a)(TNODE *n)) {
+  t->augment = a;
+}
 // returns root of a tree
 extern TNODE * getBSTroot(BST *t) {
   return t->root;
@@ -85,27 +130,65 @@ extern TNODE * getBSTroot(BST *t) {
 // sets root of a tree
 extern void setBSTroot(BST *t, TNODE *replacement) {
   t->root = replacement;
-  setTNODEparent(replacement, replacement);
+  if (replacement) { setTNODEparent(replacement, replacement); }
 }
 // sets size of a tree
 extern void setBSTsize(BST *t, int s) {
   t->size = s;
 }
-// inserts a new node into the BST and returns inserted node
-extern TNODE *insertBST(BST *t, void * value) {
+/* turns scapegoat rebalancing on for 0.5 < alpha < 1, off for alpha == 0
+* with it on, an insert that lands deeper than log base 1/alpha of the size
+* rebuilds the subtree under the lowest ancestor whose child holds more than
+* alpha of its nodes, and deletes rebuild the whole tree once the size drops
+* below alpha times its peak; smaller alpha keeps the tree flatter
+*/
+extern void setBSTbalance(BST *t, double alpha) {
+  t->alpha = alpha;
+  t->maxSize = sizeBST(t);
+}
+/* with relink on, deletes move tree nodes rather than the values in them,
+* so every node keeps the value it was created with and a TNODE handle stays
+* valid until its own value is deleted
+*/
+extern void setBSTrelink(BST *t, int on) {
+  t->relink = on;
+}
+// returns a detached node holding value, set up like the tree's own nodes
+extern TNODE *newBSTnode(BST *t, void *value) {
   TNODE * newNode = newTNODE(value, 0, 0, 0);
   assert(newNode != NULL);
   setTNODEfree(newNode, (void *)t->freeMethod);
   setTNODEdisplay(newNode, (void *)t->displayMethod);
-  TNODE * temp = getBSTroot(t);
+  if (t->augment) { t->augment(newNode); }
+  return newNode;
+}
+// inserts a new node into the BST and returns inserted node
+extern TNODE *insertBST(BST *t, void * value) {
+  return insertBSTunder(t, getBSTroot(t), value);
+}
+/* inserts value into the subtree under top, which must be a subtree that
+* value's position falls in, such as the one fingerBST returns; a null top
+* means an empty tree
+*/
+extern TNODE *insertBSTunder(BST *t, TNODE *top, void *value) {
+  TNODE * newNode = newBSTnode(t, value);
+  TNODE * temp = top;
+  int depth = 0;
+  if (t->alpha > 0 && top) {
+    for (TNODE * up = parentOf(top); up; up = parentOf(up)) {
+      ++depth;
+    }
+  }
 
   // If tree is empty: set root, return
   if (temp == 0) {
     setBSTroot(t, newNode);
     setBSTsize(t, sizeBST(t) + 1);
+    t->stale = 1;
     return newNode;
   }
   while (temp != 0) {
+    ++depth;
     setTNODEparent(newNode, temp);
     if (t->comparator(getTNODEvalue(getTNODEparent(newNode)), value) >= 1) {
       // value of newNode's parent > value being inserted, so go left
@@ -127,9 +210,71 @@ extern TNODE *insertBST(BST *t, void * value) {
     setTNODEright(getTNODEparent(newNode), newNode);
   }
 
+  refreshBST(t, getTNODEparent(newNode));
   setBSTsize(t, sizeBST(t) + 1);
+  if (t->alpha > 0) {
+    if (sizeBST(t) > t->maxSize) {
+      t->maxSize = sizeBST(t);
+    }
+    if (tooDeep(t, depth)) {
+      // climb to the scapegoat; one must exist when the new node is too deep
+      TNODE * child = newNode;
+      TNODE * goat = parentOf(child);
+      while (goat && getTNODEsize(child) <= t->alpha * getTNODEsize(goat)) {
+        child = goat;
+        goat = parentOf(goat);
+      }
+      if (goat) {
+        rebuild(t, goat);
+      }
+    }
+  }
   return newNode;
 }
+/* returns the root of a small subtree that key's position falls in,
+* found by stepping in order from hint, a node of t, for up to FINGER
+* nodes; a search that starts there, as insertBSTunder's does, costs O(1)
+* comparisons when key lands near hint, as it does for nearly sorted input
+* a null hint, or a key too far away, gives the root
+*/
+extern TNODE *fingerBST(BST *t, TNODE *hint, void *key) {
+  if (hint == 0 || sizeBST(t) == 0) {
+    return getBSTroot(t);
+  }
+  TNODE * x = hint;
+  int here = t->comparator(getTNODEvalue(x), key);
+  if (here == 0) {
+    return x;
+  }
+  if (here < 0) {
+    for (int i = 0; i < FINGER; ++i) {
+      TNODE * s = nextBST(t, x);
+      int c = s ? t->comparator(getTNODEvalue(s), key) : 1;
+      if (c > 0) {
+        // key goes between x and s, under whichever has a free slot
+        return getTNODEright(x) ? s : x;
+      }
+      if (c == 0) {
+        return s;
+      }
+      x = s;
+    }
+  }
+  else {
+    for (int i = 0; i < FINGER; ++i) {
+      TNODE * p = prevBST(t, x);
+      int c = p ? t->comparator(getTNODEvalue(p), key) : -1;
+      if (c < 0) {
+        return getTNODEleft(x) ? p : x;
+      }
+      if (c == 0) {
+        return p;
+      }
+      x = p;
+    }
+  }
+  return getBSTroot(t);
+}
 // returns the value with the searched-for key
 // if key is not in the tree, the method returns null
 extern void * findBST(BST *t, void *key) {
@@ -153,12 +298,24 @@ extern TNODE * locateBST(BST *t, void *key) {
 */
 extern int deleteBST(BST *t, void *key) {
   TNODE * temp = findBSTNode(t, key);
-  if (temp) {
+  if (temp && t->relink) {
+    unlinkNode(t, temp); // predecessor node takes temp's place
+    free(temp);
+    setBSTsize(t, sizeBST(t) - 1); // decrement size
+    if (t->alpha > 0 && sizeBST(t) < t->alpha * t->maxSize) {
+      rebalanceBST(t);
+    }
+    return 0;
+  }
+  else if (temp) {
     temp = swapToLeafBST(t, temp); // temp now a leaf
     pruneLeafBST(t, temp); // prune leaf
     free(temp);
     //t->freeMethod(temp);
     setBSTsize(t, sizeBST(t) - 1); // decrement size
+    if (t->alpha > 0 && sizeBST(t) < t->alpha * t->maxSize) {
+      rebalanceBST(t);
+    }
     return 0;
   }
   else {
@@ -171,24 +328,29 @@ extern int deleteBST(BST *t, void *key) {
 * calls the BST’s swapper function to actually accomplish the swap,
 * sending the two nodes whose values need to be swapped.
 * The method returns the leaf node holding the swapped value.
+* In relink mode the node itself trades places with its neighbors instead,
+* so the returned leaf is the node that was passed in.
 */
 extern TNODE *swapToLeafBST(BST *t, TNODE *node) {
   if (node == 0) {
     return node;
   }
-  if (isLeaf(node)) {
-    return node;
-  }
   TNODE *temp = node;
-  if (getTNODEleft(temp)) {
-    //t->swapper(temp, getPred(temp));
-    temp = swapVals(temp, getPred(temp));
+  while (t->relink && !isLeaf(temp)) {
+    if (getTNODEleft(temp)) { exchange(t, temp, getPred(temp)); }
+    else { exchange(t, temp, getSucc(temp)); }
   }
-  else {
-    //t->swapper(temp, getSucc(temp));
-    temp = swapVals(temp, getSucc(temp));
+  while (!isLeaf(temp)) {
+    if (getTNODEleft(temp)) {
+      //t->swapper(temp, getPred(temp));
+      temp = swapVals(temp, getPred(temp));
+    }
+    else {
+      //t->swapper(temp, getSucc(temp));
+      temp = swapVals(temp, getSucc(temp));
+    }
   }
-  return swapToLeafBST(t, temp);
+  return temp;
 }
 /* method detaches given node from the tree
 * does not free the node nor decrement size
@@ -209,6 +371,12 @@ extern void pruneLeafBST(BST *t, TNODE *leaf) {
     setTNODEright(parent, 0); // detaches leaf from parent
     setTNODEparent(leaf, 0); // detaches parent from leaf
   }
+  if (parent != leaf) {
+    refreshBST(t, parent);
+  }
+  else {
+    t->stale = 1;
+  }
 }
 // returns the number of nodes currently in the tree
 extern int sizeBST(BST * t) {
@@ -218,6 +386,8 @@ extern int sizeBST(BST * t) {
 * number of nodes in the tree
 * minimum height
 * maximum height
+* average depth and the number of nodes at each depth, as depthsBST does
+* the depths are cached in the root, so all but the histogram is O(1)
 */
 extern void statisticsBST(BST *t, FILE *fp) {
   fprintf(fp, "Nodes: %d\n", sizeBST(t));
@@ -228,11 +398,12 @@ extern void statisticsBST(BST *t, FILE *fp) {
     maxDepth = -1;
   }
   else {
-    minDepth = findMinDepth(getBSTroot(t));
-    maxDepth = findMaxDepth(getBSTroot(t));
+    minDepth = getTNODEminDepth(getBSTroot(t));
+    maxDepth = getTNODEmaxDepth(getBSTroot(t));
   }
   fprintf(fp, "Minimum depth: %d\n", minDepth);
   fprintf(fp, "Maximum depth: %d\n", maxDepth);
+  depthsBST(t, fp);
 }
 /*
 * debugLevel == 0 : displayMethod prints a level-order traversal
@@ -284,13 +455,142 @@ extern int debugBST(BST *t, int level) {
 */
 extern void freeBST(BST *t) {
   TNODE * temp = getBSTroot(t);
-  if (temp == 0 || sizeBST(t) == 0) {
-    free(t);
-    return;
+  if (temp != 0 && sizeBST(t) != 0) {
+    freeSubTree(temp);
   }
-  freeSubTree(temp);
+  free(t->histogram);
   free(t);
 }
+/* displays:
+* average depth of a node, read from the statistics cached in the root
+* number of nodes at each depth
+* the histogram is only recounted after the shape of the tree has changed
+*/
+extern void depthsBST(BST *t, FILE *fp) {
+  if (sizeBST(t) == 0) {
+    fprintf(fp, "Average depth: -1\n");
+    return;
+  }
+  TNODE * root = getBSTroot(t);
+  fprintf(fp, "Average depth: %.2f\n",
+      (double)getTNODEpathLength(root) / getTNODEsize(root));
+  if (t->stale) {
+    countDepths(t);
+  }
+  for (int i = 0; i < t->levels; ++i) {
+    fprintf(fp, "%d: %d\n", i, t->histogram[i]);
+  }
+}
+/* rebuilds the whole tree into one of minimum height with Day-Stout-Warren:
+* rotations flatten it into a sorted vine, then repeated left rotations fold
+* the vine back into a balanced tree; O(n) time and O(1) extra memory
+*/
+extern void rebalanceBST(BST *t) {
+  if (getBSTroot(t) != 0 && sizeBST(t) > 0) {
+    rebuild(t, getBSTroot(t));
+  }
+  t->maxSize = sizeBST(t);
+}
+/* recomputes the cached subtree statistics of n and each of its ancestors
+* must be called, bottom-most change first, whenever the links below n change
+*/
+extern void refreshBST(BST *t, TNODE *n) {
+  while (n) {
+    updateBST(t, n);
+    n = parentOf(n);
+  }
+  t->stale = 1;
+}
+// recomputes the cached data of n alone from its children
+extern void updateBST(BST *t, TNODE *n) {
+  refreshTNODE(n);
+  if (t->augment) { t->augment(n); }
+}
+/* cursors walk the tree in order using the parent links, so each step is
+* O(1) amortized and nothing is allocated; a null return means the walk has
+* fallen off the end of the tree
+*/
+// returns the node holding the smallest value
+extern TNODE *firstBST(BST *t) {
+  if (getBSTroot(t) == 0 || sizeBST(t) == 0) {
+    return 0;
+  }
+  return leftmost(getBSTroot(t));
+}
+// returns the node holding the largest value
+extern TNODE *lastBST(BST *t) {
+  if (getBSTroot(t) == 0 || sizeBST(t) == 0) {
+    return 0;
+  }
+  return rightmost(getBSTroot(t));
+}
+// returns the in-order successor of n
+extern TNODE *nextBST(BST *t, TNODE *n) {
+  (void)t;
+  if (n == 0) {
+    return 0;
+  }
+  if (getTNODEright(n)) {
+    return leftmost(getTNODEright(n));
+  }
+  TNODE *p = parentOf(n);
+  while (p && getTNODEright(p) == n) {
+    n = p;
+    p = parentOf(p);
+  }
+  return p;
+}
+// returns the in-order predecessor of n
+extern TNODE *prevBST(BST *t, TNODE *n) {
+  (void)t;
+  if (n == 0) {
+    return 0;
+  }
+  if (getTNODEleft(n)) {
+    return rightmost(getTNODEleft(n));
+  }
+  TNODE *p = parentOf(n);
+  while (p && getTNODEleft(p) == n) {
+    n = p;
+    p = parentOf(p);
+  }
+  return p;
+}
+// positions a cursor at key or, if key is absent, at the node that follows it
+extern TNODE *seekBST(BST *t, void *key) {
+  return bound(t, key, 0, 0);
+}
+// returns the node holding the largest value <= key
+extern TNODE *floorBST(BST *t, void *key) {
+  return bound(t, key, 1, 0);
+}
+// returns the node holding the smallest value >= key
+extern TNODE *ceilingBST(BST *t, void *key) {
+  return bound(t, key, 0, 0);
+}
+// returns the node holding the largest value < key
+extern TNODE *predecessorBST(BST *t, void *key) {
+  return bound(t, key, 1, 1);
+}
+// returns the node holding the smallest value > key
+extern TNODE *successorBST(BST *t, void *key) {
+  return bound(t, key, 0, 1);
+}
+/* calls f on every node whose value lies in [lo, hi], in order
+* arg is passed through to f untouched
+* returns the number of nodes visited
+*/
+extern int rangeBST(BST *t, void *lo, void *hi,
+    void (*f)(TNODE *n, void *arg), void *arg) {
+  int count = 0;
+  TNODE *n = seekBST(t, lo);
+  while (n && t->comparator(getTNODEvalue(n), hi) <= 0) {
+    f(n, arg);
+    ++count;
+    n = nextBST(t, n);
+  }
+  return count;
+}
 ////////////////////////////////////////////////////////////////////////////////
 static int getDebugVal(BST *t) {
   return t->debugVal;
@@ -312,85 +612,347 @@ static TNODE * findBSTNode(BST *tree, void *key) {
   return temp;
 }
 
-static TNODE * swapVals(TNODE *x, TNODE *y) {
-  void *temp = getTNODEvalue(x);
-  setTNODEvalue(x, getTNODEvalue(y));
-  setTNODEvalue(y, temp);
-  return y;
+/* one descent serves all four point queries
+* below == 0 looks for the smallest value after key, below == 1 for the
+* largest value before it; strict excludes a node holding key itself
+*/
+static TNODE *bound(BST *t, void *key, int below, int strict) {
+  TNODE *temp = getBSTroot(t);
+  TNODE *best = 0;
+  if (temp == 0 || sizeBST(t) == 0) {
+    return 0;
+  }
+  while (temp) {
+    int c = t->comparator(getTNODEvalue(temp), key);
+    if (c == 0 && !strict) {
+      return temp;
+    }
+    if (below) {
+      if (c < 0) { best = temp; temp = getTNODEright(temp); }
+      else { temp = getTNODEleft(temp); }
+    }
+    else {
+      if (c > 0) { best = temp; temp = getTNODEleft(temp); }
+      else { temp = getTNODEright(temp); }
+    }
+  }
+  return best;
 }
 
-static TNODE *getPred(TNODE *n) {
-  TNODE *temp = getTNODEleft(n);
-  while (getTNODEright(temp)) {
-    temp = getTNODEright(temp);
+/* trades the tree positions of nodes a and b, values riding along
+* the shape is unchanged, so only the two nodes' cached statistics move
+*/
+static void exchange(BST *t, TNODE *a, TNODE *b) {
+  if (parentOf(a) == b || parentOf(b) == 0) {
+    TNODE *x = a;
+    a = b;
+    b = x;
   }
-  return temp;
+  // now a is never b's child and b is never the root
+  TNODE *al = getTNODEleft(a);
+  TNODE *ar = getTNODEright(a);
+  TNODE *bp = parentOf(b);
+  TNODE *bl = getTNODEleft(b);
+  TNODE *br = getTNODEright(b);
+  int bWasLeft = getTNODEleft(bp) == b;
+  transplant(t, a, b);
+  if (bp == a) { // b was a's child, a becomes b's child on the same side
+    if (bWasLeft) {
+      setTNODEleft(b, a);
+      setTNODEright(b, ar);
+      if (ar) { setTNODEparent(ar, b); }
+    }
+    else {
+      setTNODEright(b, a);
+      setTNODEleft(b, al);
+      if (al) { setTNODEparent(al, b); }
+    }
+    setTNODEparent(a, b);
+  }
+  else {
+    setTNODEleft(b, al);
+    setTNODEright(b, ar);
+    if (al) { setTNODEparent(al, b); }
+    if (ar) { setTNODEparent(ar, b); }
+    setTNODEparent(a, bp);
+    if (bWasLeft) { setTNODEleft(bp, a); }
+    else { setTNODEright(bp, a); }
+  }
+  setTNODEleft(a, bl);
+  setTNODEright(a, br);
+  if (bl) { setTNODEparent(bl, a); }
+  if (br) { setTNODEparent(br, a); }
+  updateBST(t, a);
+  updateBST(t, b);
 }
 
-static TNODE *getSucc(TNODE *n) {
-  TNODE *temp = getTNODEright(n);
-  while (getTNODEleft(temp)) temp = getTNODEleft(temp);
-  return temp;
+// hangs replacement (which may be null) where old hangs now
+static void transplant(BST *t, TNODE *old, TNODE *replacement) {
+  TNODE *p = parentOf(old);
+  if (p == 0) {
+    t->root = replacement;
+    if (replacement) { setTNODEparent(replacement, replacement); }
+    return;
+  }
+  if (getTNODEleft(p) == old) { setTNODEleft(p, replacement); }
+  else { setTNODEright(p, replacement); }
+  if (replacement) { setTNODEparent(replacement, p); }
 }
-// looks for a node with at least one null child
-static int findMinDepth(TNODE *n) { //FIXME
-  // Corner case. Should never be hit unless the code is
-  // called on root = NULL
-  if (n == 0) {
-    return 0;
+
+/* removes n from the tree by relinking: a node with two children is
+* replaced by its predecessor node, which is first spliced out of its own spot
+* n is left detached; it is neither freed nor counted out of the size
+*/
+static void unlinkNode(BST *t, TNODE *n) {
+  TNODE *lowest; // deepest node whose subtree changed
+  if (getTNODEleft(n) && getTNODEright(n)) {
+    TNODE *pred = getPred(n);
+    if (getTNODEparent(pred) == n) {
+      lowest = pred;
+    }
+    else {
+      lowest = parentOf(pred);
+      transplant(t, pred, getTNODEleft(pred));
+      setTNODEleft(pred, getTNODEleft(n));
+      setTNODEparent(getTNODEleft(pred), pred);
+    }
+    transplant(t, n, pred);
+    setTNODEright(pred, getTNODEright(n));
+    setTNODEparent(getTNODEright(pred), pred);
+  }
+  else {
+    TNODE *child = getTNODEleft(n) ? getTNODEleft(n) : getTNODEright(n);
+    lowest = parentOf(n);
+    transplant(t, n, child);
   }
+  setTNODEleft(n, 0);
+  setTNODEright(n, 0);
+  setTNODEparent(n, 0);
+  refreshBST(t, lowest);
+}
 
-  // Base case : Leaf Node. This accounts for height = 1.
-  if (getTNODEleft(n) == 0 || getTNODEright(n) == 0) {
-    return 0;
+// true when depth exceeds log base 1/alpha of the tree's size
+static int tooDeep(BST *t, int depth) {
+  double reach = 1;
+  for (int i = 0; i < depth; ++i) {
+    reach /= t->alpha;
+    if (reach > sizeBST(t)) {
+      return 1;
+    }
   }
+  return 0;
+}
+
+/* Day-Stout-Warren rebuild of the subtree rooted at n, in place
+* parent links are kept current through every rotation so the subtree's
+* statistics can be refreshed with a tour afterwards
+*/
+static void rebuild(BST *t, TNODE *n) {
+  TNODE *above = parentOf(n);
+  int wasLeft = above && getTNODEleft(above) == n;
+  int size = getTNODEsize(n);
+  TNODE *pseudo = newTNODE(0, 0, n, 0);
+  assert(pseudo != NULL);
+  setTNODEparent(n, pseudo);
 
-  // If left subtree is NULL, recur for right subtree
-  if (!getTNODEleft(n)) {
-    return findMinDepth(getTNODEright(n)) + 1;
+  // tree to vine: rotate every left child up until none remain
+  TNODE *tail = pseudo;
+  TNODE *rest = n;
+  while (rest) {
+    TNODE *l = getTNODEleft(rest);
+    if (l == 0) {
+      tail = rest;
+      rest = getTNODEright(rest);
+    }
+    else {
+      setTNODEleft(rest, getTNODEright(l));
+      if (getTNODEright(l)) { setTNODEparent(getTNODEright(l), rest); }
+      setTNODEright(l, rest);
+      setTNODEparent(rest, l);
+      setTNODEright(tail, l);
+      setTNODEparent(l, tail);
+      rest = l;
+    }
   }
 
-  // If right subtree is NULL, recur for left subtree
-  if (!getTNODEright(n)) {
-    return findMinDepth(getTNODEleft(n)) + 1;
+  // vine to tree: fold the leftover bottom level, then halve repeatedly
+  int full = 1;
+  while (full * 2 + 1 <= size) {
+    full = full * 2 + 1;
+  }
+  compress(pseudo, size - full);
+  while (full > 1) {
+    full /= 2;
+    compress(pseudo, full);
   }
 
-  return min(findMinDepth(getTNODEleft(n)), findMinDepth(getTNODEright(n))) + 1;
+  TNODE *top = getTNODEright(pseudo);
+  free(pseudo);
+  if (above == 0) {
+    setBSTroot(t, top);
+  }
+  else {
+    setTNODEparent(top, above);
+    if (wasLeft) { setTNODEleft(above, top); }
+    else { setTNODEright(above, top); }
+  }
+  tour(t, top, refreshStep, 0);
+  refreshBST(t, above);
 }
 
-static int findMaxDepth(TNODE *n) { //FIXME
-  // Corner case. Should never be hit unless the code is
-  // called on root = NULL
-  if (n == 0) {
-    return 0;
+// left-rotates every other node of the vine hanging right of pseudo
+static void compress(TNODE *pseudo, int count) {
+  TNODE *scanner = pseudo;
+  for (int i = 0; i < count; ++i) {
+    TNODE *child = getTNODEright(scanner);
+    setTNODEright(scanner, getTNODEright(child));
+    setTNODEparent(getTNODEright(scanner), scanner);
+    scanner = getTNODEright(scanner);
+    setTNODEright(child, getTNODEleft(scanner));
+    if (getTNODEleft(scanner)) { setTNODEparent(getTNODEleft(scanner), child); }
+    setTNODEleft(scanner, child);
+    setTNODEparent(child, scanner);
   }
+}
 
-  // Base case : Leaf Node. This accounts for height = 1.
-  if (getTNODEleft(n) == 0 && getTNODEright(n) == 0) {
-    return 0;
+static void refreshStep(BST *t, TNODE *n, int when, int depth, void *arg) {
+  (void)depth;
+  (void)arg;
+  if (when == POST) {
+    updateBST(t, n);
   }
+}
 
-  // If left subtree is NULL, recur for right subtree
-  if (!getTNODEleft(n)) {
-    return findMaxDepth(getTNODEright(n)) + 1;
+// recounts the nodes at each depth with a tour of the tree
+static void countDepths(BST *t) {
+  TNODE * root = getBSTroot(t);
+  t->levels = getTNODEmaxDepth(root) + 1;
+  t->histogram = realloc(t->histogram, sizeof(int) * t->levels);
+  assert(t->histogram != NULL);
+  for (int i = 0; i < t->levels; ++i) {
+    t->histogram[i] = 0;
   }
+  tour(t, root, countStep, t->histogram);
+  t->stale = 0;
+}
 
-  // If right subtree is NULL, recur for left subtree
-  if (!getTNODEright(n)) {
-    return findMaxDepth(getTNODEleft(n)) + 1;
+static void countStep(BST *t, TNODE *n, int when, int depth, void *arg) {
+  (void)t;
+  (void)n;
+  int *histogram = arg;
+  if (when == PRE) {
+    ++histogram[depth];
   }
+}
 
-  return max(findMaxDepth(getTNODEleft(n)), findMaxDepth(getTNODEright(n))) + 1;
+/* Euler tour of the subtree rooted at start, driven by the parent links
+* f sees each node three times: on the way down (PRE), between its subtrees
+* (IN) and on the way back up (POST), along with the node's depth below start
+* nothing is allocated and the C stack does not grow with the tree's height
+*/
+static void tour(BST *t, TNODE *start,
+    void (*f)(BST *t, TNODE *n, int when, int depth, void *arg), void *arg) {
+  TNODE *n = start;
+  int depth = 0;
+  while (1) {
+    f(t, n, PRE, depth, arg);
+    if (getTNODEleft(n)) {
+      n = getTNODEleft(n);
+      ++depth;
+      continue;
+    }
+    f(t, n, IN, depth, arg);
+    if (getTNODEright(n)) {
+      n = getTNODEright(n);
+      ++depth;
+      continue;
+    }
+    f(t, n, POST, depth, arg);
+    // climb until an unvisited right subtree turns up
+    while (1) {
+      if (n == start) {
+        return;
+      }
+      TNODE *p = parentOf(n);
+      --depth;
+      if (getTNODEleft(p) == n) {
+        n = p;
+        f(t, n, IN, depth, arg);
+        if (getTNODEright(n)) {
+          n = getTNODEright(n);
+          ++depth;
+          break;
+        }
+        f(t, n, POST, depth, arg);
+      }
+      else {
+        n = p;
+        f(t, n, POST, depth, arg);
+      }
+    }
+  }
 }
 
+// the root's parent pointer refers to the root itself (or is null once pruned)
+static TNODE *parentOf(TNODE *n) {
+  TNODE *p = getTNODEparent(n);
+  if (p == n) {
+    return 0;
+  }
+  return p;
+}
+
+static TNODE *leftmost(TNODE *n) {
+  while (getTNODEleft(n)) n = getTNODEleft(n);
+  return n;
+}
+
+static TNODE *rightmost(TNODE *n) {
+  while (getTNODEright(n)) n = getTNODEright(n);
+  return n;
+}
+
+static TNODE * swapVals(TNODE *x, TNODE *y) {
+  void *temp = getTNODEvalue(x);
+  setTNODEvalue(x, getTNODEvalue(y));
+  setTNODEvalue(y, temp);
+  return y;
+}
+
+static TNODE *getPred(TNODE *n) {
+  TNODE *temp = getTNODEleft(n);
+  while (getTNODEright(temp)) {
+    temp = getTNODEright(temp);
+  }
+  return temp;
+}
+
+static TNODE *getSucc(TNODE *n) {
+  TNODE *temp = getTNODEright(n);
+  while (getTNODEleft(temp)) temp = getTNODEleft(temp);
+  return temp;
+}
+/* frees every node below n in one linear sweep
+* a node is freed once both of its children are gone, then the sweep resumes
+* from its parent, so no stack is needed
+*/
 static void freeSubTree(TNODE *n) {
-  if (n == 0) {
-    return;
+  TNODE *stop = n ? parentOf(n) : 0;
+  while (n != stop) {
+    if (getTNODEleft(n)) {
+      n = getTNODEleft(n);
+    }
+    else if (getTNODEright(n)) {
+      n = getTNODEright(n);
+    }
+    else {
+      TNODE *p = parentOf(n);
+      if (p && getTNODEleft(p) == n) { setTNODEleft(p, 0); }
+      else if (p) { setTNODEright(p, 0); }
+      freeTNODE(n);
+      n = p;
+    }
   }
-  TNODE *ptr = n;
-  freeSubTree(getTNODEleft(ptr));
-  freeSubTree(getTNODEright(ptr));
-  freeTNODE(ptr);
 }
 
 static void displayNode(BST *t, TNODE *n, FILE *fp) {
@@ -471,7 +1033,7 @@ static void displayLevel(BST *t, FILE *fp) {
 * example:
 * [[7] 20 [33]]
 */
-static void displayInOrder(BST * t, TNODE * n, FILE * fp) { // FIXME
+static void displayInOrder(BST * t, TNODE * n, FILE * fp) {
   if (t == 0 || sizeBST(t) == 0) { // empty tree
     fprintf(fp, "[]");
     return;
@@ -485,29 +1047,27 @@ static void displayInOrder(BST * t, TNODE * n, FILE * fp) { // FIXME
   if (n == 0) {
     return;
   }
-  fprintf(fp, "["); // outer bracket
-  displayInOrder(t, getTNODEleft(n), fp); // recur left subtree first
-
-  if (getTNODEright(n) && getTNODEleft(n)) {
-    fprintf(fp, " ");
-  }
+  tour(t, n, inOrderStep, fp);
+}
 
-  if (!getTNODEright(n) && getTNODEleft(n)) {
-    fprintf(fp, " ");
+static void inOrderStep(BST *t, TNODE *n, int when, int depth, void *arg) {
+  (void)depth;
+  FILE *fp = arg;
+  if (when == PRE) {
+    fprintf(fp, "["); // outer bracket
   }
-
-  t->displayMethod(getTNODEvalue(n), fp); // curr node
-
-  if (getTNODEright(n) && getTNODEleft(n)) {
-    fprintf(fp, " ");
+  else if (when == IN) {
+    if (getTNODEleft(n)) {
+      fprintf(fp, " ");
+    }
+    t->displayMethod(getTNODEvalue(n), fp); // curr node, between subtrees
+    if (getTNODEright(n)) {
+      fprintf(fp, " ");
+    }
   }
-
-  if (getTNODEright(n) && !getTNODEleft(n)) {
-    fprintf(fp, " ");
+  else {
+    fprintf(fp, "]"); // outer bracket
   }
-
-  displayInOrder(t, getTNODEright(n), fp); // then right subtree
-  fprintf(fp, "]"); // outer bracket
 }
 /*
 * @ any given node, method displays left and right subtrees, each enclosed by
@@ -517,7 +1077,7 @@ static void displayInOrder(BST * t, TNODE * n, FILE * fp) { // FIXME
 * example:
 * [20 [7] [33]] pre
 */
-static void displayPreOrder(BST *t, TNODE *n, FILE *fp) { // FIXME
+static void displayPreOrder(BST *t, TNODE *n, FILE *fp) {
   if (t == 0 || sizeBST(t) == 0) { // empty tree
     fprintf(fp, "[]\n");
     return;
@@ -531,16 +1091,20 @@ static void displayPreOrder(BST *t, TNODE *n, FILE *fp) { // FIXME
   if (n == 0) {
     return;
   }
+  tour(t, n, preOrderStep, fp);
+}
 
-  if (n == getBSTroot(t)) { fprintf(fp, "["); } // outer bracket
-  else { fprintf(fp, " ["); } // outer bracket
-
-  t->displayMethod(getTNODEvalue(n), fp); // curr node
-
-  displayPreOrder(t, getTNODEleft(n), fp); // recur left subtree first
-  displayPreOrder(t, getTNODEright(n), fp); // then right subtree
-
-  fprintf(fp, "]"); // outer bracket
+static void preOrderStep(BST *t, TNODE *n, int when, int depth, void *arg) {
+  (void)depth;
+  FILE *fp = arg;
+  if (when == PRE) {
+    if (n == getBSTroot(t)) { fprintf(fp, "["); } // outer bracket
+    else { fprintf(fp, " ["); } // outer bracket
+    t->displayMethod(getTNODEvalue(n), fp); // curr node, before subtrees
+  }
+  else if (when == POST) {
+    fprintf(fp, "]"); // outer bracket
+  }
 }
 /*
 * @ any given node, method displays left and right subtrees, each enclosed by
@@ -564,31 +1128,22 @@ static void displayPostOrder(BST *t, TNODE *n, FILE *fp) {
   if (n == 0) {
     return;
   }
-  fprintf(fp, "["); // outer bracket
-
-  displayPostOrder(t, getTNODEleft(n), fp); // recur left subtree first
-  displayPostOrder(t, getTNODEright(n), fp); // then right subtree
-
-  t->displayMethod(getTNODEvalue(n), fp); // curr node
-
-  fprintf(fp, "]"); // outer bracket
-  if (n != getBSTroot(t)) {
-    fprintf(fp, " ");
-  }
+  tour(t, n, postOrderStep, fp);
 }
 
-static int min(int x, int y) {
-  if (x < y) {
-    return x;
+static void postOrderStep(BST *t, TNODE *n, int when, int depth, void *arg) {
+  (void)depth;
+  FILE *fp = arg;
+  if (when == PRE) {
+    fprintf(fp, "["); // outer bracket
   }
-  else { return y; }
-}
-
-static int max(int x, int y) {
-  if (x > y) {
-    return x;
+  else if (when == POST) {
+    t->displayMethod(getTNODEvalue(n), fp); // curr node, after subtrees
+    fprintf(fp, "]"); // outer bracket
+    if (n != getBSTroot(t)) {
+      fprintf(fp, " ");
+    }
   }
-  else { return y; }
 }
 
 static int isRightChild(TNODE *n) {
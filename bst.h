@@ -10,10 +10,16 @@ extern BST *newBST(int (*c)(void *,void *));
 extern void   setBSTdisplay(BST *t, void (*d)(void *,FILE *));
 extern void   setBSTswapper(BST *t, void (*s)(TNODE *,TNODE *));
 extern void   setBSTfree(BST *t, void (*f)(void * ptr));
+extern void   setBSTaugment(BST *t, void (*a)(TNODE *n));
 extern TNODE *getBSTroot(BST *t);
 extern void   setBSTroot(BST *t, TNODE *replacement);
 extern void   setBSTsize(BST *t, int s);
+extern void   setBSTbalance(BST *t, double alpha);
+extern void   setBSTrelink(BST *t, int on);
+extern TNODE *newBSTnode(BST *t, void *value);
 extern TNODE *insertBST(BST *t, void *value);
+extern TNODE *insertBSTunder(BST *t, TNODE *top, void *value);
+extern TNODE *fingerBST(BST *t, TNODE *hint, void *key);
 extern void  *findBST(BST *t, void *key);
 extern TNODE *locateBST(BST *t, void *key);
 extern int    deleteBST(BST *t, void *key);
@@ -24,5 +30,22 @@ extern void   statisticsBST(BST *t, FILE *fp);
 extern void   displayBST(BST *t, FILE *fp);
 extern int    debugBST(BST *t, int level);
 extern void   freeBST(BST *t);
+extern void   depthsBST(BST *t, FILE *fp);
+extern void   refreshBST(BST *t, TNODE *n);
+extern void   updateBST(BST *t, TNODE *n);
+extern void   rebalanceBST(BST *t);
+
+/* ordered cursors and point queries */
+extern TNODE *firstBST(BST *t);
+extern TNODE *lastBST(BST *t);
+extern TNODE *nextBST(BST *t, TNODE *n);
+extern TNODE *prevBST(BST *t, TNODE *n);
+extern TNODE *seekBST(BST *t, void *key);
+extern TNODE *floorBST(BST *t, void *key);
+extern TNODE *ceilingBST(BST *t, void *key);
+extern TNODE *predecessorBST(BST *t, void *key);
+extern TNODE *successorBST(BST *t, void *key);
+extern int    rangeBST(BST *t, void *lo, void *hi,
+                void (*f)(TNODE *n, void *arg), void *arg);
 
 #endif /* bst.h */
@@ -0,0 +1,115 @@
+/*File: cache.c
+ *Implements functions found in cache.h: a small, fixed-size, two-way set
+ *associative cache of items by hash, for keys that are asked for again
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "cache.h"
+
+/* a key's hash picks one set of two ways, the more recently used first;
+* a set is 32 bytes and the sets start on a cache-line boundary, so a
+* probe reads one line; a hit needs the hash and then the item to match
+* the key, and a miss leaves the set as it was; a new item takes the first
+* way and pushes the older one out
+*/
+typedef struct set {
+  unsigned long hash[2];
+  void *item[2];
+} SET;
+
+struct cache {
+  SET *sets;
+  void *base; // the block sets was carved from
+  int mask; // sets - 1, sets being a power of two
+  int (*compare)(void *item, void *key);
+  long probes;
+  long hits;
+};
+
+static SET *setOf(CACHE *x, unsigned long hash);
+
+// about entries items, in a power of two sets; items match keys as in INDEX
+extern CACHE *newCACHE(int entries, int (*c)(void *, void *)) {
+  CACHE *x = malloc(sizeof(CACHE));
+  assert(x != NULL);
+  int sets = 1;
+  while (sets * 2 < entries) { sets *= 2; }
+  x->mask = sets - 1;
+  x->compare = c;
+  x->base = malloc(sizeof(SET) * sets + 63);
+  assert(x->base != NULL);
+  x->sets = (SET *)(((uintptr_t)x->base + 63) & ~(uintptr_t)63);
+  clearCACHE(x);
+  x->probes = 0;
+  x->hits = 0;
+  return x;
+}
+
+extern void *findCACHE(CACHE *x, unsigned long hash, void *key) {
+  SET *s = setOf(x, hash);
+  ++x->probes;
+  if (s->item[0] && s->hash[0] == hash && x->compare(s->item[0], key) == 0) {
+    ++x->hits;
+    return s->item[0];
+  }
+  if (s->item[1] && s->hash[1] == hash && x->compare(s->item[1], key) == 0) {
+    void *item = s->item[1];
+    s->hash[1] = s->hash[0];
+    s->item[1] = s->item[0];
+    s->hash[0] = hash;
+    s->item[0] = item;
+    ++x->hits;
+    return item;
+  }
+  return 0;
+}
+
+extern void addCACHE(CACHE *x, unsigned long hash, void *item) {
+  SET *s = setOf(x, hash);
+  if (s->item[0] == item) { return; }
+  s->hash[1] = s->hash[0];
+  s->item[1] = s->item[0];
+  s->hash[0] = hash;
+  s->item[0] = item;
+}
+
+// forgets item, which is about to be freed or to stop matching its key
+extern void removeCACHE(CACHE *x, unsigned long hash, void *item) {
+  SET *s = setOf(x, hash);
+  if (s->item[1] == item) { s->item[1] = 0; }
+  if (s->item[0] == item) {
+    s->hash[0] = s->hash[1];
+    s->item[0] = s->item[1];
+    s->item[1] = 0;
+  }
+}
+
+extern void clearCACHE(CACHE *x) {
+  for (int i = 0; i <= x->mask; ++i) {
+    x->sets[i].item[0] = 0;
+    x->sets[i].item[1] = 0;
+  }
+}
+
+extern long bytesCACHE(CACHE *x) {
+  return (long)sizeof(CACHE) + (long)sizeof(SET) * (x->mask + 1);
+}
+
+extern void statisticsCACHE(CACHE *x, FILE *fp) {
+  fprintf(fp, "Cache: %d entries, %ld of %ld lookups hit (%.1f%%)\n",
+      2 * (x->mask + 1), x->hits, x->probes,
+      x->probes ? 100.0 * x->hits / x->probes : 0.0);
+}
+
+extern void freeCACHE(CACHE *x) {
+  free(x->base);
+  free(x);
+}
+
+// the set of a hash, from the high bits of its Fibonacci product
+static SET *setOf(CACHE *x, unsigned long hash) {
+  unsigned long long h = (unsigned long long)hash * 0x9e3779b97f4a7c15ULL;
+  return &x->sets[(int)(h >> 40) & x->mask];
+}
@@ -0,0 +1,17 @@
+#ifndef __CACHE_INCLUDED__
+#define __CACHE_INCLUDED__
+
+#include <stdio.h>
+
+typedef struct cache CACHE;
+
+extern CACHE *newCACHE(int entries,int (*c)(void *,void *));
+extern void  *findCACHE(CACHE *x,unsigned long hash,void *key);
+extern void   addCACHE(CACHE *x,unsigned long hash,void *item);
+extern void   removeCACHE(CACHE *x,unsigned long hash,void *item);
+extern void   clearCACHE(CACHE *x);
+extern long   bytesCACHE(CACHE *x);
+extern void   statisticsCACHE(CACHE *x,FILE *fp);
+extern void   freeCACHE(CACHE *x);
+
+#endif
@@ -0,0 +1,122 @@
+/*File: filter.c
+ *Implements functions found in filter.h: a counting Bloom filter, which
+ *answers "maybe present" or "certainly absent" for hashed keys and, unlike
+ *a plain Bloom filter, lets keys be taken out again
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "filter.h"
+
+// counters per block; a block of 4-bit counters fills one cache line
+#define BLOCK 128
+
+// a key takes 1.44 counters for each halving of the rate, and blocking
+// costs about a tenth more
+#define PERHALF 1.6
+
+/* the table is split into blocks of BLOCK counters, and all k counters of
+* a key lie in the one block its hash picks, so a probe touches a single
+* cache line; adding a key raises its k counters and removing it lowers
+* them, and a key is absent when any of its counters is zero; a counter
+* that reaches 15 sticks there, so a removal can never zero a counter some
+* other key still needs
+*/
+struct filter {
+  int capacity; // the keys the filter was sized for
+  int size;
+  int blocks;
+  int k;
+  unsigned char *counts; // two counters a byte, aligned to a cache line
+  void *base; // the block counts was carved from
+};
+
+static unsigned long long mix(unsigned long long z);
+static unsigned char *block(FILTER *f, unsigned long hash,
+    unsigned long long *bits);
+
+// sized so that, holding keys keys, a probe passes wrongly at about rate
+extern FILTER *newFILTER(int keys, double rate) {
+  FILTER *f = malloc(sizeof(FILTER));
+  assert(f != NULL);
+  if (keys < 1) { keys = 1; }
+  if (rate <= 0 || rate >= 1) { rate = 0.01; }
+  f->capacity = keys;
+  f->size = 0;
+  int halvings = 0;
+  for (double p = 1; p > rate; p /= 2) { ++halvings; }
+  f->k = halvings < 8 ? halvings : 8; // 7 bits of the hash each
+  double counters = (double)keys * halvings * PERHALF;
+  f->blocks = (int)(counters / BLOCK) + 1;
+  f->base = malloc((size_t)f->blocks * BLOCK / 2 + 63);
+  assert(f->base != NULL);
+  f->counts = (unsigned char *)(((uintptr_t)f->base + 63) & ~(uintptr_t)63);
+  for (long i = 0; i < (long)f->blocks * BLOCK / 2; ++i) { f->counts[i] = 0; }
+  return f;
+}
+
+extern void addFILTER(FILTER *f, unsigned long hash) {
+  unsigned long long bits;
+  unsigned char *b = block(f, hash, &bits);
+  for (int i = 0; i < f->k; ++i, bits >>= 7) {
+    int at = (int)(bits & (BLOCK - 1)), shift = (at & 1) * 4;
+    if (((b[at >> 1] >> shift) & 15) != 15) { b[at >> 1] += 1 << shift; }
+  }
+  ++f->size;
+}
+
+// the key must have been added, and not since removed
+extern void removeFILTER(FILTER *f, unsigned long hash) {
+  unsigned long long bits;
+  unsigned char *b = block(f, hash, &bits);
+  for (int i = 0; i < f->k; ++i, bits >>= 7) {
+    int at = (int)(bits & (BLOCK - 1)), shift = (at & 1) * 4;
+    if (((b[at >> 1] >> shift) & 15) != 15) { b[at >> 1] -= 1 << shift; }
+  }
+  --f->size;
+}
+
+// returns 0 if the key is certainly absent, 1 if it may be present
+extern int holdsFILTER(FILTER *f, unsigned long hash) {
+  unsigned long long bits;
+  unsigned char *b = block(f, hash, &bits);
+  for (int i = 0; i < f->k; ++i, bits >>= 7) {
+    int at = (int)(bits & (BLOCK - 1));
+    if (((b[at >> 1] >> ((at & 1) * 4)) & 15) == 0) { return 0; }
+  }
+  return 1;
+}
+
+extern int sizeFILTER(FILTER *f) {
+  return f->size;
+}
+
+extern int capacityFILTER(FILTER *f) {
+  return f->capacity;
+}
+
+extern long bytesFILTER(FILTER *f) {
+  return (long)sizeof(FILTER) + (long)f->blocks * BLOCK / 2;
+}
+
+extern void freeFILTER(FILTER *f) {
+  free(f->base);
+  free(f);
+}
+
+// splitmix64 finalizer
+static unsigned long long mix(unsigned long long z) {
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// the block of a key, with bits set to 7 bits of counter index per probe
+static unsigned char *block(FILTER *f, unsigned long hash,
+    unsigned long long *bits) {
+  unsigned long long h = mix(hash + 0x9e3779b97f4a7c15ULL);
+  *bits = mix(h);
+  long at = (long)(((h >> 32) * (unsigned long long)f->blocks) >> 32);
+  return f->counts + at * (BLOCK / 2);
+}
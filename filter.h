@@ -0,0 +1,15 @@
+#ifndef __FILTER_INCLUDED__
+#define __FILTER_INCLUDED__
+
+typedef struct filter FILTER;
+
+extern FILTER *newFILTER(int keys,double rate);
+extern void    addFILTER(FILTER *f,unsigned long hash);
+extern void    removeFILTER(FILTER *f,unsigned long hash);
+extern int     holdsFILTER(FILTER *f,unsigned long hash);
+extern int     sizeFILTER(FILTER *f);
+extern int     capacityFILTER(FILTER *f);
+extern long    bytesFILTER(FILTER *f);
+extern void    freeFILTER(FILTER *f);
+
+#endif
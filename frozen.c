@@ -0,0 +1,194 @@
+/*File: frozen.c
+ *Implements functions found in frozen.h: a read-only frequency table over
+ *a fixed set of hashed keys, addressed by a perfect hash built with the
+ *CHD (compress, hash and displace) method
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "frozen.h"
+
+// keys per bucket, on average
+#define LAMBDA 4
+
+// displacements tried per bucket before the build starts over
+#define TRIES (1 << 20)
+
+// about one slot in SPARE is left empty, which keeps the last placements quick
+#define SPARE 20
+
+// seeds tried before the build gives up
+#define SEEDS 8
+
+/* the n keys are hashed into n / LAMBDA buckets, and each key also gets
+* two values f1 < p and 0 < f2 < p, where p, the slot count, is a prime a
+* little above n; the buckets are placed largest first, each trying
+* displacements k = 0, 1, ... until every one of its keys lands on a free
+* slot (f1 + d0 * f2 + d1) mod p, with d0 = k % p and d1 = k / p; p being
+* prime, d0 alone reaches every slot; only k is kept per bucket, and each
+* slot holds its key's frequency and a 16-bit fingerprint, which turns away
+* all but 1 in 65536 keys that were never in the set
+*/
+struct frozen {
+  int n;
+  int slots;
+  int buckets;
+  unsigned long seed;
+  unsigned int *shift; // the displacement k of each bucket
+  int *freqs;
+  unsigned short *prints;
+};
+
+typedef struct place {
+  unsigned long hash;
+  int freq;
+  int bucket;
+} PLACE;
+
+static int build(FROZEN *f, unsigned long *hashes, int *freqs);
+static unsigned long long mix(unsigned long hash, unsigned long seed);
+static int slot(FROZEN *f, unsigned long hash, unsigned int k);
+static void largestFirst(int *sizes, int buckets, int *order);
+static int prime(int n);
+
+// returns 0 if the hashes cannot be told apart, as when two are equal
+extern FROZEN *newFROZEN(unsigned long *hashes, int *freqs, int n) {
+  FROZEN *f = malloc(sizeof(FROZEN));
+  assert(f != NULL);
+  f->n = n;
+  f->slots = n + n / SPARE + 1;
+  while (!prime(f->slots)) { ++f->slots; }
+  f->buckets = n / LAMBDA + 1;
+  f->shift = malloc(sizeof(unsigned int) * f->buckets);
+  f->freqs = malloc(sizeof(int) * f->slots);
+  f->prints = malloc(sizeof(unsigned short) * f->slots);
+  assert(f->shift != NULL && f->freqs != NULL && f->prints != NULL);
+  for (f->seed = 1; f->seed <= SEEDS; ++f->seed) {
+    if (build(f, hashes, freqs)) { return f; }
+  }
+  freeFROZEN(f);
+  return 0;
+}
+
+// the frequency of the key with this hash, or 0 if it was not in the set
+extern int freqFROZEN(FROZEN *f, unsigned long hash) {
+  unsigned long long h = mix(hash, f->seed);
+  int at = slot(f, hash, f->shift[(h >> 32) % f->buckets]);
+  return f->prints[at] == (unsigned short)h ? f->freqs[at] : 0;
+}
+
+extern int sizeFROZEN(FROZEN *f) {
+  return f->n;
+}
+
+extern long bytesFROZEN(FROZEN *f) {
+  return (long)sizeof(FROZEN) + (long)sizeof(unsigned int) * f->buckets
+      + (long)(sizeof(int) + sizeof(unsigned short)) * f->slots;
+}
+
+extern void freeFROZEN(FROZEN *f) {
+  free(f->shift);
+  free(f->freqs);
+  free(f->prints);
+  free(f);
+}
+
+// one attempt with f->seed; returns 0 if some bucket could not be placed
+static int build(FROZEN *f, unsigned long *hashes, int *freqs) {
+  int n = f->n, ok = 1;
+  for (int i = 0; i < f->slots; ++i) {
+    f->freqs[i] = 0;
+    f->prints[i] = 0;
+  }
+  PLACE *keys = malloc(sizeof(PLACE) * (n + 1));
+  int *start = calloc(f->buckets + 1, sizeof(int));
+  int *order = malloc(sizeof(int) * f->buckets);
+  char *taken = calloc(f->slots, 1);
+  int *spots = malloc(sizeof(int) * (n + 1));
+  int *sizes = calloc(f->buckets, sizeof(int));
+  assert(keys && start && order && taken && spots && sizes);
+  for (int i = 0; i < n; ++i) {
+    int b = (int)((mix(hashes[i], f->seed) >> 32) % f->buckets);
+    ++sizes[b];
+  }
+  for (int b = 0; b < f->buckets; ++b) { start[b + 1] = start[b] + sizes[b]; }
+  for (int i = 0; i < n; ++i) {
+    int b = (int)((mix(hashes[i], f->seed) >> 32) % f->buckets);
+    PLACE *p = &keys[start[b]++];
+    p->hash = hashes[i];
+    p->freq = freqs[i];
+    p->bucket = b;
+  }
+  for (int b = f->buckets; b > 0; --b) { start[b] = start[b - 1]; }
+  start[0] = 0;
+  largestFirst(sizes, f->buckets, order);
+  for (int i = 0; i < f->buckets && ok; ++i) {
+    int b = order[i], size = sizes[b];
+    PLACE *members = keys + start[b];
+    f->shift[b] = 0;
+    if (size == 0) { continue; }
+    unsigned int k;
+    for (k = 0; k < TRIES; ++k) {
+      int j;
+      for (j = 0; j < size; ++j) {
+        spots[j] = slot(f, members[j].hash, k);
+        if (taken[spots[j]]) { break; }
+        taken[spots[j]] = 1;
+      }
+      if (j == size) { break; }
+      while (j-- > 0) { taken[spots[j]] = 0; }
+    }
+    if (k == TRIES) { ok = 0; break; }
+    f->shift[b] = k;
+    for (int j = 0; j < size; ++j) {
+      f->freqs[spots[j]] = members[j].freq;
+      f->prints[spots[j]] = (unsigned short)mix(members[j].hash, f->seed);
+    }
+  }
+  free(keys);
+  free(start);
+  free(order);
+  free(taken);
+  free(spots);
+  free(sizes);
+  return ok;
+}
+
+// splitmix64 finalizer over the hash and seed
+static unsigned long long mix(unsigned long hash, unsigned long seed) {
+  unsigned long long z = hash + seed * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// the slot displacement k sends the key with this hash to
+static int slot(FROZEN *f, unsigned long hash, unsigned int k) {
+  unsigned long long h = mix(hash, f->seed + SEEDS);
+  unsigned long long p = (unsigned long long)f->slots;
+  unsigned long long f1 = (h >> 32) % p;
+  unsigned long long f2 = (h & 0xffffffffULL) % (p - 1) + 1;
+  return (int)((f1 + (k % p) * f2 + k / p) % p);
+}
+
+// fills order with the buckets, largest first, by a counting sort
+static void largestFirst(int *sizes, int buckets, int *order) {
+  int most = 0;
+  for (int b = 0; b < buckets; ++b) {
+    if (sizes[b] > most) { most = sizes[b]; }
+  }
+  int *next = calloc(most + 2, sizeof(int));
+  assert(next != NULL);
+  for (int b = 0; b < buckets; ++b) { ++next[most - sizes[b] + 1]; }
+  for (int s = 1; s <= most + 1; ++s) { next[s] += next[s - 1]; }
+  for (int b = 0; b < buckets; ++b) { order[next[most - sizes[b]]++] = b; }
+  free(next);
+}
+
+static int prime(int n) {
+  if (n < 2) { return 0; }
+  for (int d = 2; (long)d * d <= n; ++d) {
+    if (n % d == 0) { return 0; }
+  }
+  return 1;
+}
@@ -0,0 +1,12 @@
+#ifndef __FROZEN_INCLUDED__
+#define __FROZEN_INCLUDED__
+
+typedef struct frozen FROZEN;
+
+extern FROZEN *newFROZEN(unsigned long *hashes,int *freqs,int n);
+extern int     freqFROZEN(FROZEN *f,unsigned long hash);
+extern int     sizeFROZEN(FROZEN *f);
+extern long    bytesFROZEN(FROZEN *f);
+extern void    freeFROZEN(FROZEN *f);
+
+#endif
@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gst.h"
+#include "rbt.h"
+#include "pool.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+#define SHARDS 8
+#define KEYS 20000
+
+static int count[KEYS];
+
+static int
+mismatches(void *t,int (*freq)(void *,void *))
+    {
+    int i, bad = 0;
+    for (i = 0; i < KEYS; ++i)
+        {
+        INTEGER *a = newINTEGER(i);
+        if (freq(t,a) != count[i]) ++bad;
+        freeINTEGER(a);
+        }
+    return bad;
+    }
+
+static void
+report(int size,int dups,TNODE *root,int bad)
+    {
+    int i, keys = 0, total = 0, log = 0;
+    for (i = 0; i < KEYS; ++i)
+        if (count[i]) { ++keys; total += count[i]; }
+    while ((1 << log) <= size) ++log;
+    printf("mismatches: %d, size %s, duplicates %s, height within 2 log n? %s\n",
+        bad,size == keys ? "ok" : "WRONG",dups == total - keys ? "ok" : "WRONG",
+        getTNODEmaxDepth(root) < 2 * log ? "yes" : "no");
+    }
+
+int
+main(void)
+    {
+    srandom(33);
+    printf("INTEGER test of GST and RBT, merging on a work-stealing pool\n");
+    int i, j;
+    POOL *pool = newPOOL(4);
+    GST *g[SHARDS];
+    for (i = 0; i < SHARDS; ++i)
+        {
+        g[i] = newGST(compareINTEGER);
+        setGSTfree(g[i],freeINTEGER);
+        for (j = 0; j < 5000 * (i + 1); ++j)
+            {
+            /* the first shard is built from sorted keys, a worst case */
+            int k = i == 0 ? j % KEYS : random() % KEYS;
+            ++count[k];
+            insertGST(g[i],newINTEGER(k));
+            }
+        }
+    setGSTpool(g[0],pool);
+    GST *all = mergeGST(g,SHARDS);
+    printf("mergeGST of %d shards: ",SHARDS);
+    report(sizeGST(all),duplicatesGST(all),getGSTroot(all),
+        mismatches(all,(void *)freqGST));
+    freeGST(all);
+
+    for (i = 0; i < KEYS; ++i) count[i] = 0;
+    RBT *r[SHARDS];
+    for (i = 0; i < SHARDS; ++i)
+        {
+        r[i] = newRBT(compareINTEGER);
+        setRBTfree(r[i],freeINTEGER);
+        for (j = 0; j < 4000; ++j)
+            {
+            int k = random() % KEYS;
+            ++count[k];
+            insertRBT(r[i],newINTEGER(k));
+            }
+        }
+    setRBTpool(r[0],pool);
+    RBT *merged = mergeRBT(r,SHARDS);
+    printf("mergeRBT of %d shards: ",SHARDS);
+    report(sizeRBT(merged),duplicatesRBT(merged),getRBTroot(merged),
+        mismatches(merged,(void *)freqRBT));
+
+    /* difference on the pool takes every other shard's worth back out */
+    RBT *b = newRBT(compareINTEGER);
+    setRBTfree(b,freeINTEGER);
+    for (i = 0; i < 30000; ++i)
+        {
+        int k = random() % KEYS;
+        if (count[k] > 0) --count[k];
+        insertRBT(b,newINTEGER(k));
+        }
+    merged = differenceRBT(merged,b);
+    printf("differenceRBT on the pool: ");
+    report(sizeRBT(merged),duplicatesRBT(merged),getRBTroot(merged),
+        mismatches(merged,(void *)freqRBT));
+    freeRBT(merged);
+    freePOOL(pool);
+
+    /* without a pool the unions run one after another */
+    for (i = 0; i < KEYS; ++i) count[i] = 0;
+    for (i = 0; i < 2; ++i)
+        {
+        g[i] = newGST(compareINTEGER);
+        setGSTfree(g[i],freeINTEGER);
+        for (j = 0; j < 3000; ++j)
+            {
+            int k = random() % KEYS;
+            ++count[k];
+            insertGST(g[i],newINTEGER(k));
+            }
+        }
+    all = mergeGST(g,2);
+    printf("mergeGST of 2 shards, no pool: ");
+    report(sizeGST(all),duplicatesGST(all),getGSTroot(all),
+        mismatches(all,(void *)freqGST));
+    freeGST(all);
+    for (i = 0; i < KEYS; ++i) count[i] = 0;
+    for (i = 0; i < 3; ++i)
+        {
+        r[i] = newRBT(compareINTEGER);
+        setRBTfree(r[i],freeINTEGER);
+        for (j = 0; j < 2000; ++j)
+            {
+            int k = random() % KEYS;
+            ++count[k];
+            insertRBT(r[i],newINTEGER(k));
+            }
+        }
+    merged = mergeRBT(r,3);
+    printf("mergeRBT of 3 shards, no pool: ");
+    report(sizeRBT(merged),duplicatesRBT(merged),getRBTroot(merged),
+        mismatches(merged,(void *)freqRBT));
+    freeRBT(merged);
+    return 0;
+    }
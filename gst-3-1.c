@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gst.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* a skewed stream of many distinct keys through a bounded GST, checked
+ * against exact counts */
+
+#define KEYS 50000
+#define STREAM 400000
+#define CAPACITY 200
+#define TOP 20
+
+static int exact[KEYS];
+static double weight[KEYS];
+
+// key k is drawn in proportion to 1 / (k + 1)
+static int
+draw(void)
+    {
+    double x = (double) random() / 2147483648.0 * weight[KEYS - 1];
+    int lo = 0, hi = KEYS - 1;
+    while (lo < hi)
+        {
+        int mid = (lo + hi) / 2;
+        if (weight[mid] < x) lo = mid + 1;
+        else hi = mid;
+        }
+    return lo;
+    }
+
+int
+main(void)
+    {
+    srandom(38);
+    printf("INTEGER test of GST, bounded frequency mode\n");
+    int i, k;
+    for (k = 0; k < KEYS; ++k)
+        weight[k] = (k ? weight[k - 1] : 0) + 1.0 / (k + 1);
+    GST *p = newGST(compareINTEGER);
+    setGSTdisplay(p,displayINTEGER);
+    setGSTfree(p,freeINTEGER);
+    setGSTbudget(p,CAPACITY,0.0005,0.01,hashINTEGER);
+    for (i = 0; i < STREAM; ++i)
+        {
+        k = draw();
+        ++exact[k];
+        insertGST(p,newINTEGER(k));
+        }
+    for (i = 0; i < 1000; ++i)
+        {
+        INTEGER *a = newINTEGER(i % 10);
+        if (deleteGST(p,a) >= 0) --exact[i % 10];
+        freeINTEGER(a);
+        }
+    printf("tracked keys: %d of at most %d\n",sizeGST(p),CAPACITY);
+    statisticsGST(p,stdout);
+
+    int under = 0, beyond = 0, worst = 0;
+    for (k = 0; k < KEYS; ++k)
+        {
+        INTEGER *a = newINTEGER(k);
+        int f = freqGST(p,a);
+        if (f < exact[k]) ++under;
+        if (f - exact[k] > errorGST(p,a)) ++beyond;
+        if (f - exact[k] > worst) worst = f - exact[k];
+        freeINTEGER(a);
+        }
+    printf("underestimates: %d, outside the stated bound: %d\n",under,beyond);
+    printf("worst overestimate within 2 epsilon N? %s\n",
+        worst <= STREAM / 1000 ? "yes" : "no");
+
+    TNODE *top[TOP];
+    int found = topKGST(p,TOP,top), hits = 0;
+    for (i = 0; i < found; ++i)
+        {
+        INTEGER *v = unwrapGST(top[i]);
+        if (getINTEGER(v) < TOP) ++hits;
+        INTEGER *a = newINTEGER(getINTEGER(v));
+        if (i < 5)
+            printf("top %d: key %d, count %d, error at most %d, true %d\n",
+                i + 1,getINTEGER(v),nodeFreqGST(top[i]),errorGST(p,a),
+                exact[getINTEGER(v)]);
+        freeINTEGER(a);
+        }
+    printf("of the true top %d, found in the top %d: %d\n",TOP,found,hits);
+    freeGST(p);
+    return 0;
+    }
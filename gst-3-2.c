@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gst.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* windowed GSTs, by insert count and by time stamp, checked against
+ * counts taken directly over the window */
+
+#define KEYS 500
+#define STREAM 200000
+#define WINDOW 5000
+
+static int stream[STREAM];
+static long when[STREAM];
+
+// counts the keys whose frequency differs from a recount of stream[lo..hi)
+static int
+mismatches(GST *p,int lo,int hi,int *distinct)
+    {
+    static int count[KEYS];
+    int i, bad = 0;
+    for (i = 0; i < KEYS; ++i) count[i] = 0;
+    for (i = lo; i < hi; ++i) ++count[stream[i]];
+    *distinct = 0;
+    for (i = 0; i < KEYS; ++i)
+        {
+        INTEGER *a = newINTEGER(i);
+        if (freqGST(p,a) != count[i]) ++bad;
+        if (count[i]) ++*distinct;
+        freeINTEGER(a);
+        }
+    return bad;
+    }
+
+// the sum of all frequencies in the tree
+static int
+held(GST *p)
+    {
+    int sum = 0;
+    TNODE *n;
+    for (n = firstGST(p); n != 0; n = nextGST(p,n)) sum += nodeFreqGST(n);
+    return sum;
+    }
+
+int
+main(void)
+    {
+    srandom(39);
+    printf("INTEGER test of GST, sliding windows\n");
+    int i, distinct, stale = 0;
+    for (i = 0; i < STREAM; ++i)
+        {
+        // a drifting hot range, so keys leave the window for good
+        int base = i / (STREAM / 10) * (KEYS / 10);
+        stream[i] = random() % 4 ? (base + random() % 20) % KEYS
+            : random() % KEYS;
+        when[i] = (i ? when[i - 1] : 0) + random() % 3;
+        }
+
+    GST *p = newGST(compareINTEGER);
+    setGSTdisplay(p,displayINTEGER);
+    setGSTfree(p,freeINTEGER);
+    setGSTwindow(p,WINDOW);
+    for (i = 0; i < STREAM; ++i)
+        {
+        insertGST(p,newINTEGER(stream[i]));
+        if (i % 7 == 0 && held(p) - (i + 1 < WINDOW ? i + 1 : WINDOW) >= 64)
+            ++stale;
+        }
+    printf("counts ever more than 63 increments stale: %d\n",stale);
+    advanceGST(p,0);
+    printf("count window: %d mismatches",
+        mismatches(p,STREAM - WINDOW,STREAM,&distinct));
+    printf(", %d nodes for %d distinct keys\n",sizeGST(p),distinct);
+    INTEGER *a = newINTEGER(stream[STREAM - 1]);
+    printf("delete from a window: %d\n",deleteGST(p,a));
+    freeINTEGER(a);
+    statisticsGST(p,stdout);
+    freeGST(p);
+
+    p = newGST(compareINTEGER);
+    setGSTdisplay(p,displayINTEGER);
+    setGSTfree(p,freeINTEGER);
+    setGSTwindow(p,WINDOW);
+    int lo = 0, bad = 0;
+    for (i = 0; i < STREAM; ++i)
+        {
+        insertGSTat(p,newINTEGER(stream[i]),when[i]);
+        if (i % 20000 == 19999)
+            {
+            advanceGST(p,when[i]);
+            while (when[lo] <= when[i] - WINDOW) ++lo;
+            bad += mismatches(p,lo,i + 1,&distinct);
+            }
+        }
+    printf("time window: %d mismatches over 10 checks\n",bad);
+    advanceGST(p,when[STREAM - 1] + WINDOW);
+    printf("after the window has passed: %d nodes\n",sizeGST(p));
+    freeGST(p);
+
+    // modes and bulk changes that would free wrappers the window holds
+    p = newGST(compareINTEGER);
+    setGSTfree(p,freeINTEGER);
+    GST *q = newGST(compareINTEGER);
+    setGSTfree(q,freeINTEGER);
+    setGSTmultiset(q,1);
+    printf("window on a multiset tree: %d\n",setGSTwindow(q,WINDOW));
+    setGSTwindow(p,100);
+    printf("budget on a windowed tree: %d\n",
+        setGSTbudget(p,50,0.01,0.01,hashINTEGER));
+    void *batch[300];
+    for (i = 0; i < 300; ++i) batch[i] = newINTEGER(i % 150);
+    insertManyGST(p,batch,300);
+    for (i = 0; i < 150; ++i) insertGST(q,newINTEGER(i));
+    printf("union with a windowed tree: %s",unionGST(q,p) ? "done" : "refused");
+    GST *both[2] = { q, p };
+    printf(", merge: %s\n",mergeGST(both,2) ? "done" : "refused");
+    GST *r = newGST(compareINTEGER);
+    setGSTfree(r,freeINTEGER);
+    a = newINTEGER(75);
+    splitGST(p,a,r);
+    freeINTEGER(a);
+    printf("split of a windowed tree: %d and %d nodes\n",sizeGST(p),sizeGST(r));
+    a = newINTEGER(140);
+    printf("pop from a windowed tree: %s",popGST(p,a) ? "popped" : "refused");
+    printf(", frequency still %d\n",freqGST(p,a));
+    freeINTEGER(a);
+    // the batch went in one value at a time, so the window takes it back
+    for (i = 0; i < 100; ++i) insertGST(p,newINTEGER(1000 + i % 10));
+    advanceGST(p,0);
+    printf("after the batch has left the window: %d nodes, %d held\n",
+        sizeGST(p),held(p));
+    freeGST(p);
+    freeGST(q);
+    freeGST(r);
+
+    // a pop would leave the window taking back increments no longer held
+    p = newGST(compareINTEGER);
+    setGSTfree(p,freeINTEGER);
+    setGSTwindow(p,50);
+    insertGSTat(p,newINTEGER(5),1);
+    for (i = 0; i < 99; ++i) insertGSTat(p,newINTEGER(10 + i % 7),1 + i);
+    insertGSTat(p,newINTEGER(5),100);
+    a = newINTEGER(5);
+    printf("pop from a time window: %s",popGST(p,a) ? "popped" : "refused");
+    for (i = 0; i < 1000; ++i) insertGSTat(p,newINTEGER(10 + i % 7),100 + i);
+    advanceGST(p,2000);
+    printf(", then %d nodes once the window has passed\n",sizeGST(p));
+    freeINTEGER(a);
+    freeGST(p);
+    return 0;
+    }
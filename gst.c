@@ -4,13 +4,64 @@
  */
  #include <stdio.h>
  #include <stdlib.h>
+ #include <string.h>
+ #include <limits.h>
  #include "gst.h"
  #include "bst.h"
  #include "tnode.h"
+ #include "pool.h"
+ #include "sketch.h"
+ #include "index.h"
+ #include "filter.h"
+ #include "cache.h"
+ #include "frozen.h"
+ #include "mapped.h"
 
 
 
  typedef struct gstval GSTVAL;
+ typedef struct stamp STAMP;
+
+ #if defined(__GNUC__)
+ #define PREFETCH(p) __builtin_prefetch(p)
+ #else
+ #define PREFETCH(p) ((void)(p))
+ #endif
+
+ // number of descents locateManyGST advances in lockstep
+ #define LANES 16
+
+ // how combine settles a key found in both trees
+ #define UNION 0
+ #define INTERSECTION 1
+ #define DIFFERENCE 2
+
+ // smallest combine, in nodes, worth handing to another worker
+ #define GRAIN 4096
+
+ // batches under 1/FOLD of the tree's size are applied value by value
+ #define FOLD 16
+
+ // least share of a node's weight either side may hold under weigh
+ #define ALPHA 0.29
+
+ // a window expires its old increments once this many are due
+ #define EXPIRE 64
+
+ // the false-positive rate a filter is built for
+ #define SCREEN 0.01
+
+ // the first bytes of a snapshot, the last being the format's version
+ #define SNAPSHOT "GST\001"
+
+ // the headers written through saveGSTwith, by GST and by RBT, so that a
+ // snapshot of another kind of tree is told apart from a text file
+ static const char *snapshots[] = { SNAPSHOT, "RBT\001" };
+
+ // shape bits, written before each node of a snapshot
+ #define HASLEFT 1
+ #define HASRIGHT 2
+ #define HASEXTRA 4
 
  struct gst {
    BST * tree;
@@ -19,11 +70,75 @@
    void (*display)(void * ptr, FILE *fp);
    void (*swap)(TNODE * one, TNODE * two);
    void (*freeMethod)(void * ptr);
+   TNODE *(*join)(GST *t, TNODE *l, TNODE *k, TNODE *r);
+   POOL * pool;
+   int fingering; // inserts start from the last node inserted or bumped
+   TNODE * finger;
+   int multiset; // duplicates keep their payloads
+   SKETCH * sketch; // set in bounded mode, which keeps capacity keys
+   int capacity;
+   int evicted;
+   int floor; // the largest count evicted, so no key outside counts more
+   unsigned long (*hash)(void * ptr);
+   long span; // set in window mode, which counts only recent increments
+   int timed; // stamps come from insertGSTat rather than counting inserts
+   long clock;
+   STAMP * ring; // the increments in the window, oldest first
+   int head;
+   int pending;
+   int slots;
+   INDEX * index; // set in indexed mode: key to GSTVAL, beside the tree
+   int stale; // the index and filter need rebuilding after a bulk change
+   FILTER * filter; // set in filtered mode, to turn away absent keys
+   long rejected; // absent keys the filter turned away
+   long passed; // absent keys it let through, to be found missing
+   int refilters;
+   CACHE * cache; // set in cached mode: recently found keys to their values
+ };
+
+ // one call of combine, packaged to run on a pool
+ typedef struct job {
+   GST * t;
+   TNODE * a;
+   TNODE * b;
+   int op;
+   TNODE * result;
+ } JOB;
+
+ typedef struct merge {
+   GST ** trees;
+   int n;
+ } MERGE;
+
+ // one increment of a windowed tree, and when it happened
+ struct stamp {
+   GSTVAL * v;
+   long when;
  };
 
+ // the value codec of saveGST and loadGST, passed as an argument
+ typedef struct plain {
+   void (*put)(void * value, FILE *fp);
+   void *(*get)(FILE *fp);
+ } PLAIN;
+
+ // a topKGST candidate: a node's whole subtree, or the node alone
+ typedef struct ranked {
+   TNODE * node;
+   int whole;
+   int freq;
+ } RANKED;
+
  struct gstval {
    void * val;
    int freq;
+   int total; // sum of freq over the subtree below this value's node
+   int most; // largest freq in the same subtree
+   int least; // smallest freq in the same subtree
+   int over; // in bounded mode, how far freq may overstate the count
+   void ** extra; // in multiset mode, the payloads after val, oldest first
+   int held;
+   int capacity;
    int (*compare)(void * one, void * two);
    void (*display)(void * ptr, FILE *fp);
 
@@ -31,6 +146,7 @@
  };
 
  static TNODE * findGSTNode(GST *t, void *key);
+ static TNODE * findFrom(TNODE *temp, void *key);
 
  static int getGSTduplicates(GST *t);
  static int compareGVAL(void * x, void * y);
@@ -40,6 +156,56 @@
  static void setGSTduplicates(GST *t, int i);
  static void setGSTFreq(GSTVAL * v, int f);
  static void swapVals(TNODE *x, TNODE *y);
+ static void aggregate(TNODE *n);
+ static int count(GST *t, void *key);
+ static int untracked(GST *t, void *key);
+ static TNODE *evict(GST *t, GSTVAL *v);
+ static TNODE *leastNode(TNODE *n);
+ static int slide(GST *t, int all);
+ static void record(GST *t, GSTVAL *v);
+ static int byAddress(const void *a, const void *b);
+ static GSTVAL *lookup(GST *t, void *key);
+ static GSTVAL *entry(GST *t, void *key);
+ static void refit(GST *t);
+ static int screen(GST *t, void *key);
+ static void missed(GST *t);
+ static void refilter(GST *t, int keys);
+ static void enroll(GST *t, GSTVAL *v);
+ static void unindex(GST *t, GSTVAL *v);
+ static int outranks(GST *t, RANKED *a, RANKED *b);
+ static void offer(GST *t, RANKED **heap, int *size, int *capacity,
+     RANKED r);
+ static void sift(GST *t, RANKED *heap, int size);
+ static TNODE *above(TNODE *n);
+ static TNODE *hang(GST *t, TNODE *l, TNODE *k, TNODE *r);
+ static TNODE *splitNodes(GST *t, TNODE *root, void *key,
+     TNODE **lo, TNODE **hi);
+ static TNODE *joinTwo(GST *t, TNODE *l, TNODE *r);
+ static TNODE *combine(GST *t, TNODE *a, TNODE *b, int op);
+ static TNODE *detach(TNODE *n);
+ static TNODE *rootOf(GST *t);
+ static void adopt(GST *t, TNODE *root);
+ static void dropNode(TNODE *n);
+ static void dropSubtree(TNODE *n);
+ static GST *setOperation(GST *a, GST *b, int op);
+ static void combineJob(void *arg);
+ static void mergeJob(void *arg);
+ static void rebalanceJob(void *arg);
+ static TNODE *weigh(GST *t, TNODE *l, TNODE *k, TNODE *r);
+ static int weight(TNODE *n);
+ static int inBalance(int x, int y);
+ static TNODE *side(TNODE *n, int right);
+ static TNODE *build(GST *t, GSTVAL **vals, int lo, int hi);
+ static GST *batchFor(GST *t, void (*f)(void *));
+ static void fill(GST *t, void **sorted, int n);
+ static void sortValues(int (*c)(void *, void *), void **v, int n);
+ static void keep(void *v);
+ static void hold(GSTVAL *v, void *payload);
+ static void trim(GSTVAL *v);
+ static void putPlain(void *value, FILE *fp, void *arg);
+ static void *getPlain(FILE *fp, void *arg);
+ static void putCount(FILE *fp, unsigned long n);
+ static int getCount(FILE *fp, unsigned long *n);
 
  extern GST * newGST(int (*c)(void * one, void * two)) {
    GST * gTree = malloc(sizeof(GST));
@@ -49,6 +215,31 @@
    gTree->compare = c;
    gTree->freeMethod = 0;
    gTree->swap = (void *)swapVals;
+   gTree->join = hang;
+   gTree->pool = 0;
+   gTree->fingering = 0;
+   gTree->finger = 0;
+   gTree->multiset = 0;
+   gTree->sketch = 0;
+   gTree->capacity = 0;
+   gTree->evicted = 0;
+   gTree->floor = 0;
+   gTree->span = 0;
+   gTree->timed = 0;
+   gTree->clock = 0;
+   gTree->ring = 0;
+   gTree->head = 0;
+   gTree->pending = 0;
+   gTree->slots = 0;
+   gTree->index = 0;
+   gTree->stale = 0;
+   gTree->filter = 0;
+   gTree->rejected = 0;
+   gTree->passed = 0;
+   gTree->refilters = 0;
+   gTree->cache = 0;
+   gTree->hash = 0;
+   setBSTaugment(gTree->tree, aggregate);
 
    return gTree;
  }
@@ -57,6 +248,13 @@
    GSTVAL * value = malloc(sizeof(GSTVAL));
    value->val = v;
    value->freq = 1;
+   value->total = 1;
+   value->most = 1;
+   value->least = 1;
+   value->over = 0;
+   value->extra = 0;
+   value->held = 0;
+   value->capacity = 0;
    value->display = t->display;
    value->compare = t->compare;
    value->freeMethod = t->freeMethod;
@@ -98,30 +296,89 @@
    setBSTsize(tree, s);
  }
 
+ extern void setGSTrelink(GST *t, int on) {
+   BST * tree = t->tree;
+   setBSTrelink(tree, on);
+ }
+
+ /* in finger mode each insert starts its search from the node the last
+ * insert created or bumped, instead of from the root; see fingerBST
+ * deletes drop the finger, since they may move or free values
+ */
+ extern void setGSTfinger(GST *t, int on) {
+   t->fingering = on;
+   t->finger = 0;
+ }
+
+ /* in multiset mode a duplicate's payload is kept in a small vector in the
+ * node it bumps, rather than freed; instanceGST reads them back, popGST
+ * hands back the newest, and deleteGST drops the newest, freeing it if the
+ * tree frees values; set operations move or drop whole payloads likewise
+ */
+ extern void setGSTmultiset(GST *t, int on) {
+   t->multiset = on;
+ }
+
  extern TNODE *insertGST(GST *t, void *value) {
+   return insertGSThint(t, t->finger, value);
+ }
+
+ /* inserts value, starting the search from hint, a node of t, or from the
+ * root if hint is null; a hint next to value's place makes the search O(1)
+ */
+ extern TNODE *insertGSThint(GST *t, TNODE *hint, void *value) {
+   if (t->span) {
+     if (t->timed == 0) {
+       ++t->clock;
+     }
+     if (slide(t, 0)) {
+       hint = 0;
+     }
+   }
    GSTVAL * newVal = newGSTVAL(t, value);
-   TNODE * temp = findGSTNode(t, newVal);
+   BST * tree = t->tree;
+   TNODE * top = hint ? fingerBST(tree, hint, newVal) : getBSTroot(tree);
+   TNODE * temp = sizeBST(tree) ? findFrom(top, newVal) : 0;
+   if (t->sketch) {
+     addSKETCH(t->sketch, t->hash(value), 1);
+   }
    if (temp) {
-     freeGVAL(newVal);
      GSTVAL * ptr = (GSTVAL *)getTNODEvalue(temp);
+     if (t->multiset) {
+       hold(ptr, value);
+       free(newVal);
+     }
+     else {
+       freeGVAL(newVal);
+     }
      setGSTFreq(ptr, ptr->freq + 1);
      setGSTduplicates(t, getGSTduplicates(t) + 1);
+     refreshGST(t, temp);
+     if (t->span) {
+       record(t, ptr);
+     }
+     if (t->fingering) {
+       t->finger = temp;
+     }
      return 0;
    }
-   BST * tree = t->tree;
-   return insertBST(tree, newVal);
+   if (t->sketch && sizeBST(tree) >= t->capacity) {
+     top = evict(t, newVal);
+   }
+   temp = insertBSTunder(tree, top, newVal);
+   enroll(t, newVal);
+   if (t->span) {
+     record(t, newVal);
+   }
+   if (t->fingering) {
+     t->finger = temp;
+   }
+   return temp;
  }
 
  extern void * findGST(GST *t, void *key) {
-   GSTVAL * v = newGSTVAL(t, key);
-   TNODE * temp = findGSTNode(t, v);
-   if (temp == 0) {
-     free(v);
-     return 0;
-   }
-   void * val = unwrapGST(temp);
-   free(v);
-   return val;
+   GSTVAL * v = entry(t, key);
+   return v ? v->val : 0;
  }
 
  extern TNODE *locateGST(GST *t, void *key) {
@@ -133,38 +390,51 @@
  }
 
  extern int deleteGST(GST *t, void *key) {
-   int freq = freqGST(t, key);
+   int freq = count(t, key);
    BST * tree = t->tree;
-   if (freq == 0) {
+   if (freq == 0 || t->span) {
      return -1;
    }
-   else if (freq > 1) {
+   t->finger = 0;
+   if (t->sketch) {
+     addSKETCH(t->sketch, t->hash(key), -1);
+   }
+   if (freq > 1) {
      GSTVAL * newVal = newGSTVAL(t, key);
      TNODE * node = findGSTNode(t, newVal);
      GSTVAL * ptr = (GSTVAL *)getTNODEvalue(node);
      --freq;
      setGSTFreq(ptr, freq);
+     trim(ptr);
      setGSTduplicates(t, getGSTduplicates(t) - 1);
+     refreshGST(t, node);
      //freeGVAL(newVal); //EGT
      free(newVal);
      return freq;
    }
    GSTVAL * v = getTNODEvalue(locateGST(t, key));
+   unindex(t, v);
    int result = deleteBST(tree, v);
    //freeGVAL(v); //EGT
+   free(v->extra);
    free(v);
    return result;
  }
 
  extern TNODE *swapToLeafGST(GST *t, TNODE *node) {
    BST * tree = t->tree;
+   t->finger = 0;
    return swapToLeafBST(tree, node);
  }
 
  extern void pruneLeafGST(GST *t, TNODE *leaf) {
    BST * tree = t->tree;
+   t->finger = 0;
    pruneLeafBST(tree, leaf);
-   free(getTNODEvalue(leaf));
+   GSTVAL * v = getTNODEvalue(leaf);
+   unindex(t, v);
+   free(v->extra);
+   free(v);
  }
 
  extern int sizeGST(GST *t) {
@@ -175,6 +445,30 @@
  extern void statisticsGST(GST *t, FILE *fp) {
    BST * tree = t->tree;
    fprintf(fp, "Duplicates: %d\n", duplicatesGST(t));
+   if (t->sketch) {
+     fprintf(fp, "Capacity: %d, evicted: %d\n", t->capacity, t->evicted);
+     statisticsSKETCH(t->sketch, fp);
+   }
+   if (t->index) {
+     long bytes = indexBytesGST(t);
+     fprintf(fp, "Index: %d keys, %ld bytes\n", sizeINDEX(t->index), bytes);
+   }
+   if (t->filter) {
+     if (t->stale) {
+       refit(t);
+     }
+     fprintf(fp, "Filter: %d keys, %ld bytes, built %d times\n",
+         sizeFILTER(t->filter), bytesFILTER(t->filter), t->refilters);
+     fprintf(fp, "Absent keys passed by the filter: %ld of %ld\n",
+         t->passed, t->passed + t->rejected);
+   }
+   if (t->cache) {
+     statisticsCACHE(t->cache, fp);
+   }
+   if (t->span) {
+     fprintf(fp, "Window: %ld, clock: %ld, increments held: %d\n",
+         t->span, t->clock, t->pending);
+   }
    statisticsBST(tree, fp);
  }
 
@@ -190,83 +484,1723 @@
  extern void freeGST(GST *t) {
    BST * tree = t->tree;
    freeBST(tree);
+   free(t->ring);
+   if (t->index) {
+     freeINDEX(t->index);
+   }
+   if (t->filter) {
+     freeFILTER(t->filter);
+   }
+   if (t->cache) {
+     freeCACHE(t->cache);
+   }
+   if (t->sketch) {
+     freeSKETCH(t->sketch);
+   }
    free(t);
  }
 
+ extern void depthsGST(GST *t, FILE *fp) {
+   BST * tree = t->tree;
+   depthsBST(tree, fp);
+ }
+
+ extern void refreshGST(GST *t, TNODE *n) {
+   BST * tree = t->tree;
+   refreshBST(tree, n);
+ }
+
+ extern void updateGST(GST *t, TNODE *n) {
+   BST * tree = t->tree;
+   updateBST(tree, n);
+ }
+
+ /* sets how the set operations below put two subtrees and a pivot node
+ * back together; j gets detached subtrees l < k < r, either possibly null,
+ * and returns the root of the joined subtree with its cached data refreshed
+ * a balanced tree installs one that restores its balance, the default just
+ * hangs l and r under k
+ */
+ extern void setGSTjoiner(GST *t,
+     TNODE *(*j)(GST *t, TNODE *l, TNODE *k, TNODE *r)) {
+   t->join = j;
+ }
+
+ /* with a pool set, the set operations and mergeGST hand independent
+ * halves of the work to its workers; the pool is not freed with the tree
+ */
+ extern void setGSTpool(GST *t, POOL *p) {
+   t->pool = p;
+ }
+
+ /* the set operations are destructive: the result is left in a, b is freed
+ * and its values are either moved into a or freed; a key in both trees
+ * keeps a's value, with the frequencies added (union), the smaller one kept
+ * (intersection) or b's taken from a's (difference, dropping the key at 0)
+ * each is a split of a around the root of b followed by a join of the
+ * recursive results, so with a balancing joiner m keys merged into a tree
+ * of n take O(m log(n/m + 1)) time; if either tree is windowed, both
+ * are left as they were and null is returned
+ */
+ extern GST *unionGST(GST *a, GST *b) {
+   return setOperation(a, b, UNION);
+ }
+
+ extern GST *intersectionGST(GST *a, GST *b) {
+   return setOperation(a, b, INTERSECTION);
+ }
+
+ extern GST *differenceGST(GST *a, GST *b) {
+   return setOperation(a, b, DIFFERENCE);
+ }
+
+ /* puts pivot between the values of left, which must all be smaller, and
+ * those of right, which must all be larger; the result is left in left and
+ * right is freed; if either is windowed, both are left as they were and
+ * null is returned
+ */
+ extern GST *joinGST(GST *left, void *pivot, GST *right) {
+   if (left->span || right->span) {
+     return 0;
+   }
+   TNODE * k = newBSTnode(left->tree, newGSTVAL(left, pivot));
+   adopt(left, left->join(left, rootOf(left), k, rootOf(right)));
+   adopt(right, 0);
+   freeGST(right);
+   return left;
+ }
+
+ /* moves the values larger than key from t into right, which must be empty
+ * and set up like t; t keeps the rest, and all of it if either is windowed
+ */
+ extern void splitGST(GST *t, void *key, GST *right) {
+   if (t->span || right->span) {
+     return;
+   }
+   GSTVAL probe;
+   probe.val = key;
+   TNODE *lo, *hi;
+   TNODE * mid = splitNodes(t, rootOf(t), &probe, &lo, &hi);
+   if (mid) {
+     lo = t->join(t, lo, mid, 0);
+   }
+   adopt(t, lo);
+   adopt(right, hi);
+ }
+
+ /* bulk updates sort a copy of the batch and, unless it is small next to
+ * the tree, build it into a tree of its own in O(n) and fold that in with
+ * one set operation; the split-and-join descent visits each region of the
+ * tree once for the whole batch, where separate updates would each walk
+ * down from the root; a small batch is applied one value at a time, in
+ * sorted order, so that consecutive walks share a warm path
+ * insertManyGST takes the values as insertGST would, freeing batch
+ * duplicates if t frees values; deleteManyGST takes one occurrence per key,
+ * ignores keys not in t, never frees the keys and, if t frees values, frees
+ * the values whose frequency drops to 0; bounded and windowed trees always
+ * take the one-at-a-time path
+ */
+ extern void insertManyGST(GST *t, void **values, int n) {
+   void ** sorted = malloc(sizeof(void *) * (n + 1));
+   for (int i = 0; i < n; ++i) {
+     sorted[i] = values[i];
+   }
+   sortGST(t, sorted, n);
+   if (t->sketch || t->span || n < sizeGST(t) / FOLD) {
+     for (int i = 0; i < n; ++i) {
+       insertGST(t, sorted[i]);
+     }
+   }
+   else {
+     GST * batch = batchFor(t, t->freeMethod);
+     batch->multiset = t->multiset;
+     fill(batch, sorted, n);
+     unionGST(t, batch);
+   }
+   free(sorted);
+ }
+
+ extern void deleteManyGST(GST *t, void **keys, int n) {
+   void ** sorted = malloc(sizeof(void *) * (n + 1));
+   for (int i = 0; i < n; ++i) {
+     sorted[i] = keys[i];
+   }
+   sortGST(t, sorted, n);
+   if (t->sketch || t->span || n < sizeGST(t) / FOLD) {
+     for (int i = 0; i < n; ++i) {
+       void * stored = findGST(t, sorted[i]);
+       if (deleteGST(t, sorted[i]) == 0 && t->freeMethod) {
+         t->freeMethod(stored);
+       }
+     }
+   }
+   else {
+     GST * batch = batchFor(t, keep);
+     fill(batch, sorted, n);
+     differenceGST(t, batch);
+   }
+   free(sorted);
+ }
+
+ // sorts the n values by t's comparator; the sort is stable
+ extern void sortGST(GST *t, void **values, int n) {
+   sortValues(t->compare, values, n);
+ }
+
+ /* merges trees[1] to trees[n-1] into trees[0], as a run of unions, and
+ * frees them; the unions pair the trees off in rounds, so with a pool the
+ * pairs of a round merge at once while each union also forks internally
+ * plain GSTs are first rebuilt with DSW and then joined by weight, so the
+ * result is balanced; a tree with its own joiner, like an RBT's, keeps it;
+ * if any tree is windowed, all are left as they were and null is returned
+ */
+ extern GST *mergeGST(GST **trees, int n) {
+   for (int i = 0; i < n; ++i) {
+     if (trees[i]->span) {
+       return 0;
+     }
+   }
+   MERGE m;
+   m.trees = trees;
+   m.n = n;
+   if (trees[0]->pool) {
+     runPOOL(trees[0]->pool, mergeJob, &m);
+   }
+   else {
+     mergeJob(&m);
+   }
+   return trees[0];
+ }
+
+ /* rotates n above its parent, refreshing both, and returns n; the parent
+ * may be the top of a detached subtree, whose root is its own parent
+ */
+ extern TNODE *rotateUpGST(GST *t, TNODE *n) {
+   TNODE * p = getTNODEparent(n);
+   TNODE * g = above(p);
+   if (getTNODEleft(p) == n) {
+     setTNODEleft(p, getTNODEright(n));
+     if (getTNODEright(n)) {
+       setTNODEparent(getTNODEright(n), p);
+     }
+     setTNODEright(n, p);
+   }
+   else {
+     setTNODEright(p, getTNODEleft(n));
+     if (getTNODEleft(n)) {
+       setTNODEparent(getTNODEleft(n), p);
+     }
+     setTNODEleft(n, p);
+   }
+   setTNODEparent(p, n);
+   if (g == 0) {
+     setTNODEparent(n, n);
+   }
+   else {
+     setTNODEparent(n, g);
+     if (getTNODEleft(g) == p) {
+       setTNODEleft(g, n);
+     }
+     else {
+       setTNODEright(g, n);
+     }
+   }
+   updateGST(t, p);
+   updateGST(t, n);
+   return n;
+ }
+
+ /* removes one instance of key and returns its payload, which is the
+ * caller's once it has left the tree; in multiset mode that is the newest
+ * instance, otherwise the node's one payload, which stays in the tree
+ * until the last instance goes; returns null if key is not in t or, as a
+ * windowed tree changes only through inserts, if t is windowed
+ */
+ extern void *popGST(GST *t, void *key) {
+   if (t->span) {
+     return 0;
+   }
+   GSTVAL probe;
+   probe.val = key;
+   TNODE * n = findGSTNode(t, &probe);
+   if (n == 0) {
+     return 0;
+   }
+   GSTVAL * v = (GSTVAL *)getTNODEvalue(n);
+   void * payload = v->val;
+   if (v->freq > 1 && v->held > 0) {
+     payload = v->extra[--v->held];
+   }
+   if (v->freq > 1) {
+     t->finger = 0;
+     setGSTFreq(v, v->freq - 1);
+     setGSTduplicates(t, getGSTduplicates(t) - 1);
+     refreshGST(t, n);
+   }
+   else {
+     deleteGST(t, key);
+   }
+   return payload;
+ }
+
+ /* returns instance i of the value held by n, 0 <= i < nodeFreqGST(n),
+ * in insertion order; instance 0 is the one unwrapGST returns, and so is
+ * every instance whose payload was not kept
+ */
+ extern void *instanceGST(TNODE *n, int i) {
+   GSTVAL * v = (GSTVAL *)getTNODEvalue(n);
+   if (i > 0 && i <= v->held) {
+     return v->extra[i - 1];
+   }
+   return v->val;
+ }
+
  extern void * unwrapGST(TNODE *n) {
    GSTVAL * v = (GSTVAL *)getTNODEvalue(n);
    return v->val;
  }
 
- extern int freqGST(GST *g, void *key) {
-   GSTVAL * v = newGSTVAL(g, key);
-   TNODE * n = findGSTNode(g, v);
-   if (n) {
-     GSTVAL * ptr = (GSTVAL *)getTNODEvalue(n);
-     free(v);
-     return ptr->freq;
+ /* window mode counts only the increments of the last span inserts or, if
+ * the tree is fed by insertGSTat, those stamped within span of the latest
+ * stamp; older increments are taken back EXPIRE at a time, each key's
+ * share in one step, and a key whose count reaches 0 leaves the tree,
+ * freeing its value if the tree frees values; until advanceGST, counts
+ * may include up to EXPIRE - 1 increments that are due; set before the
+ * first insert; a windowed tree changes only through inserts, so
+ * deleteGST returns -1 for it; the window's increments point at the
+ * tree's value wrappers, so returns -1, leaving t as it was, for a bounded
+ * or multiset tree, whose evictions and payloads the window cannot follow,
+ * and otherwise 0; set operations, joins, splits and merges refuse
+ * windowed trees, and batches take the one-at-a-time path
+ */
+ extern int setGSTwindow(GST *t, long span) {
+   if (t->sketch || t->multiset) {
+     return -1;
    }
-   free(v);
+   t->span = span > 0 ? span : 1;
    return 0;
  }
 
- extern int duplicatesGST(GST *g) {
-   return getGSTduplicates(g);
+ // inserts value as an increment at time stamp; stamps may not decrease
+ extern TNODE *insertGSTat(GST *t, void *value, long stamp) {
+   t->timed = 1;
+   if (stamp > t->clock) {
+     t->clock = stamp;
+   }
+   return insertGSThint(t, t->finger, value);
  }
 
- static void swapVals(TNODE *x, TNODE *y) {
-   void *one = getTNODEvalue(x);
-   void *two = getTNODEvalue(y);
-   setTNODEvalue(x, two);
-   setTNODEvalue(y, one);
+ /* moves a timed window's clock up to now and takes back every increment
+ * that is due, so counts cover exactly the window
+ */
+ extern void advanceGST(GST *t, long now) {
+   if (t->span == 0) {
+     return;
+   }
+   if (t->timed && now > t->clock) {
+     t->clock = now;
+   }
+   slide(t, 1);
  }
 
- static TNODE * findGSTNode(GST *t, void *key) {
-   BST * tree = t->tree;
-   TNODE *temp = getBSTroot(tree);
-   if (temp == 0 || sizeBST(tree) == 0) {
+ /* indexed mode keeps a hash index, keyed by h, from each key to its value
+ * wrapper, beside the tree; wrappers move between nodes but are never
+ * copied, so the index survives rotations and swaps, and freqGST,
+ * findGST and the absent-key check in deleteGST answer from it in O(1);
+ * single inserts and deletes keep it in step, while bulk changes such as
+ * set operations, splits and batches mark it stale and the next lookup
+ * rebuilds it with one walk; ordered queries still use the tree
+ */
+ extern void setGSTindex(GST *t, unsigned long (*h)(void * ptr)) {
+   if (t->index == 0) {
+     t->index = newINDEX(compareGVAL);
+   }
+   t->hash = h;
+   t->stale = 1;
+ }
+
+ // the bytes the index takes, or 0 if t has none
+ extern long indexBytesGST(GST *t) {
+   if (t->index == 0) {
      return 0;
    }
-   while (temp && compareGVAL((GSTVAL *)getTNODEvalue(temp), key) != 0) {
-     if (compareGVAL((GSTVAL *)getTNODEvalue(temp), key) > 0) {
-       temp = getTNODEleft(temp);
+   lookup(t, 0);
+   return bytesINDEX(t->index);
+ }
+
+ /* filtered mode keeps a counting Bloom filter of the keys, hashed with h,
+ * which freqGST, findGST and deleteGST consult before descending, so most
+ * absent keys are turned away after touching one cache line; it is kept in
+ * step like the index, grows when the tree outgrows it, and is rebuilt
+ * larger when more absent keys get through than it was built to pass
+ */
+ extern void setGSTfilter(GST *t, unsigned long (*h)(void * ptr)) {
+   t->hash = h;
+   if (t->filter == 0) {
+     t->filter = newFILTER(1, SCREEN);
+   }
+   t->stale = 1;
+ }
+
+ /* cached mode keeps the values of about entries recently found keys, by
+ * hash under h, in a two-way set-associative cache; a value's frequency
+ * lives in the value, so only removing a key must reach the cache, and a
+ * repeated freqGST or findGST costs one cache line and one comparison
+ */
+ extern void setGSTcache(GST *t, int entries,
+     unsigned long (*h)(void * ptr)) {
+   t->hash = h;
+   if (t->cache) {
+     freeCACHE(t->cache);
+   }
+   t->cache = newCACHE(entries, compareGVAL);
+   t->stale = 1;
+ }
+
+ /* builds a read-only frequency table over t's keys, from one in-order
+ * walk, for jobs that only ask frequencies once loading is done; answer
+ * with freqFROZEN(f, h(key)), and free it, as it goes stale, when t next
+ * changes; returns 0 if two keys share a hash under h
+ */
+ extern FROZEN *freezeGST(GST *t, unsigned long (*h)(void * ptr)) {
+   int n = sizeGST(t), i = 0;
+   unsigned long * hashes = malloc(sizeof(unsigned long) * (n + 1));
+   int * freqs = malloc(sizeof(int) * (n + 1));
+   for (TNODE * at = firstBST(t->tree); at; at = nextBST(t->tree, at)) {
+     GSTVAL * v = (GSTVAL *)getTNODEvalue(at);
+     hashes[i] = h(v->val);
+     freqs[i++] = v->freq;
+   }
+   FROZEN * f = newFROZEN(hashes, freqs, n);
+   free(hashes);
+   free(freqs);
+   return f;
+ }
+
+ /* publishes t's keys, as text, and their frequencies to a mapped tree at
+ * path for readers that share one copy through openMAPPED; the keys must
+ * run in strcmp order, as strings under compareSTRING do; returns 0, or -1
+ * if they do not or the file cannot be written
+ */
+ extern int publishGST(GST *t, char *path, char *(*text)(void * value)) {
+   int n = sizeGST(t), i = 0;
+   char ** keys = malloc(sizeof(char *) * (n + 1));
+   int * freqs = malloc(sizeof(int) * (n + 1));
+   for (TNODE * at = firstBST(t->tree); at; at = nextBST(t->tree, at)) {
+     GSTVAL * v = (GSTVAL *)getTNODEvalue(at);
+     keys[i] = text(v->val);
+     freqs[i++] = v->freq;
+   }
+   int result = writeMAPPED(path, keys, freqs, n);
+   free(keys);
+   free(freqs);
+   return result;
+ }
+
+ /* writes t to a snapshot at path, with put writing each value, and returns
+ * 0, or -1 if the file cannot be written; not for bounded or windowed trees
+ */
+ extern int saveGST(GST *t, char *path, void (*put)(void * value, FILE *fp)) {
+   PLAIN codec = { put, 0 };
+   return saveGSTwith(t, path, SNAPSHOT, putPlain, &codec);
+ }
+
+ /* fills the empty tree t from a snapshot at path, with get reading each
+ * value, and returns 0, -1 if the file is missing or not a snapshot, or -2
+ * if it is a snapshot that is damaged or of another kind of tree, leaving
+ * t empty; see loadGSTwith
+ */
+ extern int loadGST(GST *t, char *path, void *(*get)(FILE *fp)) {
+   PLAIN codec = { 0, get };
+   return loadGSTwith(t, path, SNAPSHOT, getPlain, &codec);
+ }
+
+ /* a snapshot is a header and the node count, then the nodes in preorder,
+ * each as a byte of shape bits, its frequency, its value and, in multiset
+ * mode, its other payloads; counts are written seven bits a byte; put
+ * gets arg, for trees built on GST that write fields of their own, and
+ * the header is magic, three capitals and a version byte naming the tree
+ */
+ extern int saveGSTwith(GST *t, char *path, char *magic,
+     void (*put)(void * value, FILE *fp, void * arg), void *arg) {
+   if (t->sketch || t->span) {
+     return -1;
+   }
+   FILE * fp = fopen(path, "wb");
+   if (fp == 0) {
+     return -1;
+   }
+   int n = sizeGST(t), top = 0;
+   TNODE ** stack = malloc(sizeof(TNODE *) * (n + 1));
+   fwrite(magic, 1, 4, fp);
+   putCount(fp, (unsigned long)n);
+   if (n) {
+     stack[top++] = getBSTroot(t->tree);
+   }
+   while (top) {
+     TNODE * at = stack[--top];
+     TNODE * l = getTNODEleft(at);
+     TNODE * r = getTNODEright(at);
+     GSTVAL * v = (GSTVAL *)getTNODEvalue(at);
+     fputc((l ? HASLEFT : 0) | (r ? HASRIGHT : 0) | (v->held ? HASEXTRA : 0),
+         fp);
+     putCount(fp, (unsigned long)v->freq);
+     put(v->val, fp, arg);
+     if (v->held) {
+       putCount(fp, (unsigned long)v->held);
+       for (int i = 0; i < v->held; ++i) {
+         put(v->extra[i], fp, arg);
+       }
      }
-     else {
-       temp = getTNODEright(temp);
+     if (r) {
+       stack[top++] = r;
+     }
+     if (l) {
+       stack[top++] = l;
      }
    }
-   return temp;
+   free(stack);
+   int failed = ferror(fp);
+   return fclose(fp) == 0 && failed == 0 ? 0 : -1;
  }
 
- static void displayGVAL(GSTVAL *v, FILE *fp) {
-   void *val = v->val;
-   v->display(val, fp);
-   if (v->freq > 1) {
-     fprintf(fp, "<%d>", v->freq);
+ /* rebuilds the snapshot's tree, shape and all, in one pass with no
+ * comparisons, then fills in each node's cached sizes and frequency sums
+ * from the bottom up; get returns a value, or null if the file ends; a
+ * file with another of the snapshot headers is another tree's
+ */
+ extern int loadGSTwith(GST *t, char *path, char *magic,
+     void *(*get)(FILE *fp, void * arg), void *arg) {
+   unsigned char header[4];
+   unsigned long n = 0, freq, held;
+   FILE * fp = sizeGST(t) ? 0 : fopen(path, "rb");
+   if (fp == 0) {
+     return -1;
+   }
+   int got = (int)fread(header, 1, 4, fp);
+   if (got != 4 || memcmp(header, magic, 4) != 0
+       || getCount(fp, &n) != 0 || n > (unsigned long)INT_MAX) {
+     fclose(fp);
+     int known = 0, kinds = (int)(sizeof(snapshots) / sizeof(snapshots[0]));
+     for (int i = 0; got == 4 && i < kinds; ++i) {
+       known = known || memcmp(header, snapshots[i], 4) == 0;
+     }
+     return known ? -2 : -1;
+   }
+   TNODE ** nodes = malloc(sizeof(TNODE *) * (n + 1));
+   TNODE ** stack = malloc(sizeof(TNODE *) * (n + 1));
+   char * wants = malloc(n + 1);
+   unsigned long built = 0;
+   int top = 0, ok = 1;
+   while (ok && built < n) {
+     int shape = fgetc(fp);
+     void * val = 0;
+     ok = shape != EOF && (built == 0) == (top == 0)
+         && getCount(fp, &freq) == 0 && freq > 0
+         && freq <= (unsigned long)INT_MAX && (val = get(fp, arg)) != 0;
+     if (ok == 0) {
+       break;
+     }
+     GSTVAL * v = newGSTVAL(t, val);
+     v->freq = (int)freq;
+     TNODE * at = newBSTnode(t->tree, v);
+     nodes[built++] = at;
+     if (shape & HASEXTRA) {
+       ok = getCount(fp, &held) == 0 && held < freq;
+       for (unsigned long i = 0; ok && i < held; ++i) {
+         void * payload = get(fp, arg);
+         if (payload) {
+           hold(v, payload);
+         }
+         ok = payload != 0;
+       }
+     }
+     if (top) {
+       TNODE * up = stack[top - 1];
+       if (wants[top - 1] & HASLEFT) {
+         setTNODEleft(up, at);
+         wants[top - 1] &= ~HASLEFT;
+       }
+       else {
+         setTNODEright(up, at);
+         wants[top - 1] = 0;
+       }
+       setTNODEparent(at, up);
+       if (wants[top - 1] == 0) {
+         --top;
+       }
+     }
+     if (shape & (HASLEFT | HASRIGHT)) {
+       stack[top] = at;
+       wants[top++] = shape & (HASLEFT | HASRIGHT);
+     }
+   }
+   ok = ok && top == 0;
+   fclose(fp);
+   // a node's descendants follow it in preorder
+   for (long i = (long)built - 1; i >= 0; --i) {
+     if (ok) {
+       updateGST(t, nodes[i]);
+     }
+     else {
+       dropNode(nodes[i]);
+     }
+   }
+   if (ok && n) {
+     setBSTroot(t->tree, nodes[0]);
+     setBSTsize(t->tree, (int)n);
+     GSTVAL * v = (GSTVAL *)getTNODEvalue(nodes[0]);
+     setGSTduplicates(t, v->total - (int)n);
    }
+   t->finger = 0;
+   t->stale = 1;
+   free(nodes);
+   free(stack);
+   free(wants);
+   return ok ? 0 : -2;
  }
 
- static int compareGVAL(void *x, void *y) {
-   GSTVAL *a = (GSTVAL *)x;
-   GSTVAL *b = (GSTVAL *)y;
-   return a->compare(a->val, b->val);
+ // in bounded mode the frequency is an estimate; see errorGST
+ extern int freqGST(GST *g, void *key) {
+   int freq = count(g, key);
+   return freq ? freq : untracked(g, key);
  }
 
- static void freeGVAL(GSTVAL *v) {
-   if (v->freeMethod) {
-     v->freeMethod(v->val);
+ /* bounded mode caps the tree at capacity keys, for streams with more
+ * distinct keys than memory; it counts every key in a Count-Min sketch of
+ * the given error parameters, hashed with h, and when a new key finds the
+ * tree full, the least frequent key is evicted, as in SpaceSaving; the new
+ * key starts at the smaller of the sketch's estimate and one more than the
+ * largest count evicted so far, neither of which can be below its true
+ * count, so frequent keys are tracked with small error and the rest are
+ * estimated from the sketch; set before the first insert, and not for
+ * trees in set operations; returns 0, or -1, leaving t as it was, if t is
+ * windowed, since an eviction would free a wrapper the window still holds
+ */
+ extern int setGSTbudget(GST *t, int capacity, double epsilon, double delta,
+     unsigned long (*h)(void * ptr)) {
+   if (t->span) {
+     return -1;
    }
-   free(v);
+   t->sketch = newSKETCH(epsilon, delta);
+   t->capacity = capacity > 0 ? capacity : 1;
+   t->hash = h;
+   return 0;
  }
 
- static int getGSTduplicates(GST * t) {
-   return t->duplicates;
+ /* returns how far freqGST(t, key) may exceed the true count: nothing
+ * outside bounded mode or for a key never evicted, the SpaceSaving error
+ * for a tracked key, and otherwise epsilon times the stream length, which
+ * the sketch exceeds with probability at most delta
+ */
+ extern int errorGST(GST *t, void *key) {
+   if (t->sketch == 0) {
+     return 0;
+   }
+   GSTVAL probe;
+   probe.val = key;
+   TNODE * n = findGSTNode(t, &probe);
+   if (n) {
+     return ((GSTVAL *)getTNODEvalue(n))->over;
+   }
+   return t->evicted ? (int)boundSKETCH(t->sketch) : 0;
  }
 
- static void setGSTduplicates(GST * t, int i) {
-   t->duplicates = i;
+ extern int duplicatesGST(GST *g) {
+   return getGSTduplicates(g);
  }
 
- static void setGSTFreq(GSTVAL *v, int f) {
-   v->freq = f;
+ // returns how many times the value held by n has been inserted
+ extern int nodeFreqGST(TNODE *n) {
+   GSTVAL * v = (GSTVAL *)getTNODEvalue(n);
+   return v->freq;
+ }
+
+ /* finds the node for each key, or null, walking LANES descents at a time
+ * each lane moves one step per round: prefetch the node, then its GSTVAL,
+ * then the wrapped value, then compare and step to a child; by the time a
+ * lane comes round again its next cache line has had a full round to arrive
+ */
+ extern void locateManyGST(GST *t, void **keys, int n, TNODE **results) {
+   BST * tree = t->tree;
+   TNODE * root = sizeBST(tree) ? getBSTroot(tree) : 0;
+   for (int base = 0; base < n; base += LANES) {
+     int lanes = n - base < LANES ? n - base : LANES;
+     GSTVAL probe[LANES];
+     TNODE * at[LANES];
+     int stage[LANES];
+     int active = 0;
+     for (int i = 0; i < lanes; ++i) {
+       probe[i].val = keys[base + i];
+       results[base + i] = 0;
+       at[i] = root;
+       stage[i] = 0;
+       if (root) {
+         ++active;
+       }
+     }
+     while (active) {
+       for (int i = 0; i < lanes; ++i) {
+         TNODE * node = at[i];
+         if (node == 0) {
+           continue;
+         }
+         if (stage[i] == 0) {
+           PREFETCH(getTNODEvalue(node));
+           stage[i] = 1;
+         }
+         else if (stage[i] == 1) {
+           PREFETCH(((GSTVAL *)getTNODEvalue(node))->val);
+           stage[i] = 2;
+         }
+         else {
+           int c = compareGVAL(getTNODEvalue(node), &probe[i]);
+           if (c == 0) {
+             results[base + i] = node;
+             at[i] = 0;
+           }
+           else {
+             at[i] = c > 0 ? getTNODEleft(node) : getTNODEright(node);
+           }
+           if (at[i]) {
+             PREFETCH(at[i]);
+           }
+           else {
+             --active;
+           }
+           stage[i] = 0;
+         }
+       }
+     }
+   }
+ }
+
+ extern void findManyGST(GST *t, void **keys, int n, void **results) {
+   locateManyGST(t, keys, n, (TNODE **)results);
+   for (int i = 0; i < n; ++i) {
+     if (results[i]) {
+       results[i] = unwrapGST(results[i]);
+     }
+   }
+ }
+
+ extern void freqManyGST(GST *t, void **keys, int n, int *results) {
+   if (t->index || t->filter || t->cache) {
+     for (int i = 0; i < n; ++i) {
+       results[i] = freqGST(t, keys[i]);
+     }
+     return;
+   }
+   TNODE * found[LANES];
+   for (int base = 0; base < n; base += LANES) {
+     int count = n - base < LANES ? n - base : LANES;
+     locateManyGST(t, keys + base, count, found);
+     for (int i = 0; i < count; ++i) {
+       results[base + i] = found[i] ? nodeFreqGST(found[i])
+           : untracked(t, keys[base + i]);
+     }
+   }
+ }
+
+ /* fills results with the (at most) k nodes of highest frequency, most
+ * frequent first and equal frequencies in key order, and returns how many
+ * it found; a best-first search over the subtree maxima kept by aggregate,
+ * so only the paths down to the answers are visited
+ */
+ extern int topKGST(GST *t, int k, TNODE **results) {
+   int found = 0, size = 0, capacity = 16;
+   RANKED * heap = malloc(sizeof(RANKED) * capacity);
+   TNODE * root = getGSTroot(t);
+   if (root && k > 0) {
+     RANKED whole = { root, 1, ((GSTVAL *)getTNODEvalue(root))->most };
+     offer(t, &heap, &size, &capacity, whole);
+   }
+   while (found < k && size > 0) {
+     RANKED best = heap[0];
+     heap[0] = heap[--size];
+     sift(t, heap, size);
+     if (best.whole == 0) {
+       results[found++] = best.node;
+       continue;
+     }
+     GSTVAL * v = (GSTVAL *)getTNODEvalue(best.node);
+     RANKED self = { best.node, 0, v->freq };
+     offer(t, &heap, &size, &capacity, self);
+     TNODE * l = getTNODEleft(best.node);
+     TNODE * r = getTNODEright(best.node);
+     if (l) {
+       RANKED left = { l, 1, ((GSTVAL *)getTNODEvalue(l))->most };
+       offer(t, &heap, &size, &capacity, left);
+     }
+     if (r) {
+       RANKED right = { r, 1, ((GSTVAL *)getTNODEvalue(r))->most };
+       offer(t, &heap, &size, &capacity, right);
+     }
+   }
+   free(heap);
+   return found;
+ }
+
+ /* cursors and point queries delegate to the underlying BST
+ * keys are wrapped in a GSTVAL on the stack so no step allocates
+ */
+ extern TNODE *firstGST(GST *t) {
+   return firstBST(t->tree);
+ }
+
+ extern TNODE *lastGST(GST *t) {
+   return lastBST(t->tree);
+ }
+
+ extern TNODE *nextGST(GST *t, TNODE *n) {
+   return nextBST(t->tree, n);
+ }
+
+ extern TNODE *prevGST(GST *t, TNODE *n) {
+   return prevBST(t->tree, n);
+ }
+
+ extern TNODE *seekGST(GST *t, void *key) {
+   GSTVAL probe;
+   probe.val = key;
+   return seekBST(t->tree, &probe);
+ }
+
+ extern TNODE *floorGST(GST *t, void *key) {
+   GSTVAL probe;
+   probe.val = key;
+   return floorBST(t->tree, &probe);
+ }
+
+ extern TNODE *ceilingGST(GST *t, void *key) {
+   GSTVAL probe;
+   probe.val = key;
+   return ceilingBST(t->tree, &probe);
+ }
+
+ extern TNODE *predecessorGST(GST *t, void *key) {
+   GSTVAL probe;
+   probe.val = key;
+   return predecessorBST(t->tree, &probe);
+ }
+
+ extern TNODE *successorGST(GST *t, void *key) {
+   GSTVAL probe;
+   probe.val = key;
+   return successorBST(t->tree, &probe);
+ }
+
+ extern int rangeGST(GST *t, void *lo, void *hi,
+     void (*f)(TNODE *n, void *arg), void *arg) {
+   GSTVAL low, high;
+   low.val = lo;
+   high.val = hi;
+   return rangeBST(t->tree, &low, &high, f, arg);
+ }
+
+ static GST *setOperation(GST *a, GST *b, int op) {
+   if (a->span || b->span) {
+     return 0;
+   }
+   JOB j;
+   j.t = a;
+   j.a = rootOf(a);
+   j.b = rootOf(b);
+   j.op = op;
+   if (a->pool) {
+     runPOOL(a->pool, combineJob, &j);
+   }
+   else {
+     combineJob(&j);
+   }
+   adopt(a, j.result);
+   adopt(b, 0);
+   freeGST(b);
+   return a;
+ }
+
+ // recomputes the frequency total cached in n's value
+ static void aggregate(TNODE *n) {
+   GSTVAL * v = (GSTVAL *)getTNODEvalue(n);
+   TNODE * l = getTNODEleft(n);
+   TNODE * r = getTNODEright(n);
+   v->total = v->freq;
+   v->most = v->freq;
+   v->least = v->freq;
+   if (l) {
+     GSTVAL * lv = (GSTVAL *)getTNODEvalue(l);
+     v->total += lv->total;
+     v->most = lv->most > v->most ? lv->most : v->most;
+     v->least = lv->least < v->least ? lv->least : v->least;
+   }
+   if (r) {
+     GSTVAL * rv = (GSTVAL *)getTNODEvalue(r);
+     v->total += rv->total;
+     v->most = rv->most > v->most ? rv->most : v->most;
+     v->least = rv->least < v->least ? rv->least : v->least;
+   }
+ }
+
+ // returns the parent of n, or null at the top of a (sub)tree
+ static TNODE *above(TNODE *n) {
+   TNODE * p = getTNODEparent(n);
+   return p == n ? 0 : p;
+ }
+
+ // cuts n's children off into (sub)trees of their own and returns n
+ static TNODE *detach(TNODE *n) {
+   TNODE * l = getTNODEleft(n);
+   TNODE * r = getTNODEright(n);
+   if (l) {
+     setTNODEparent(l, l);
+   }
+   if (r) {
+     setTNODEparent(r, r);
+   }
+   setTNODEleft(n, 0);
+   setTNODEright(n, 0);
+   setTNODEparent(n, n);
+   return n;
+ }
+
+ // the default joiner: no rebalancing
+ static TNODE *hang(GST *t, TNODE *l, TNODE *k, TNODE *r) {
+   setTNODEleft(k, l);
+   setTNODEright(k, r);
+   if (l) {
+     setTNODEparent(l, k);
+   }
+   if (r) {
+     setTNODEparent(r, k);
+   }
+   setTNODEparent(k, k);
+   updateGST(t, k);
+   return k;
+ }
+
+ /* splits the subtree under root into the nodes below key, *lo, and those
+ * above it, *hi, and returns the node equal to key, detached, or null
+ * the descent stops at key's position; climbing back up, each ancestor is
+ * joined with its untouched side onto whichever half it belongs to
+ */
+ static TNODE *splitNodes(GST *t, TNODE *root, void *key,
+     TNODE **lo, TNODE **hi) {
+   TNODE *at = root, *last = 0, *mid = 0;
+   while (at) {
+     int c = compareGVAL(getTNODEvalue(at), key);
+     if (c == 0) {
+       mid = at;
+       break;
+     }
+     last = at;
+     at = c > 0 ? getTNODEleft(at) : getTNODEright(at);
+   }
+   TNODE *l = 0, *r = 0;
+   if (mid) {
+     last = above(mid);
+     l = getTNODEleft(mid);
+     r = getTNODEright(mid);
+     detach(mid);
+     updateGST(t, mid);
+   }
+   while (last) {
+     TNODE * next = above(last);
+     int below = compareGVAL(getTNODEvalue(last), key) > 0;
+     TNODE * side = below ? getTNODEright(last) : getTNODEleft(last);
+     if (side) {
+       setTNODEparent(side, side);
+     }
+     if (below) {
+       r = t->join(t, r, last, side);
+     }
+     else {
+       l = t->join(t, side, last, l);
+     }
+     last = next;
+   }
+   *lo = l;
+   *hi = r;
+   return mid;
+ }
+
+ // joins two subtrees, every value of l smaller than every value of r
+ static TNODE *joinTwo(GST *t, TNODE *l, TNODE *r) {
+   if (l == 0) {
+     return r;
+   }
+   if (r == 0) {
+     return l;
+   }
+   TNODE * last = l;
+   while (getTNODEright(last)) {
+     last = getTNODEright(last);
+   }
+   TNODE *lo, *hi;
+   last = splitNodes(t, l, getTNODEvalue(last), &lo, &hi);
+   return t->join(t, lo, last, r);
+ }
+
+ // merges the subtrees a and b node by node as op says, see unionGST
+ static TNODE *combine(GST *t, TNODE *a, TNODE *b, int op) {
+   if (a == 0 || b == 0) {
+     if (op == UNION) {
+       return a ? a : b;
+     }
+     if (op == DIFFERENCE) {
+       dropSubtree(b);
+       return a;
+     }
+     dropSubtree(a ? a : b);
+     return 0;
+   }
+   TNODE * bl = getTNODEleft(b);
+   TNODE * br = getTNODEright(b);
+   detach(b);
+   TNODE *al, *ah;
+   int size = getTNODEsize(a) + getTNODEsize(b);
+   TNODE * m = splitNodes(t, a, getTNODEvalue(b), &al, &ah);
+   TNODE *l, *r;
+   if (t->pool && size > GRAIN) {
+     JOB left;
+     left.t = t;
+     left.a = al;
+     left.b = bl;
+     left.op = op;
+     TASK * task = spawnPOOL(t->pool, combineJob, &left);
+     r = combine(t, ah, br, op);
+     syncPOOL(t->pool, task);
+     l = left.result;
+   }
+   else {
+     l = combine(t, al, bl, op);
+     r = combine(t, ah, br, op);
+   }
+   GSTVAL * bv = (GSTVAL *)getTNODEvalue(b);
+   if (m == 0) {
+     if (op == UNION) {
+       return t->join(t, l, b, r);
+     }
+     dropNode(b);
+     return joinTwo(t, l, r);
+   }
+   GSTVAL * mv = (GSTVAL *)getTNODEvalue(m);
+   if (op == UNION) {
+     mv->freq += bv->freq;
+     if (t->multiset) {
+       hold(mv, bv->val);
+       for (int i = 0; i < bv->held; ++i) {
+         hold(mv, bv->extra[i]);
+       }
+       bv->held = 0;
+       bv->freeMethod = 0;
+     }
+   }
+   else if (op == INTERSECTION) {
+     mv->freq = mv->freq < bv->freq ? mv->freq : bv->freq;
+   }
+   else {
+     mv->freq -= bv->freq;
+   }
+   trim(mv);
+   dropNode(b);
+   if (mv->freq <= 0) {
+     dropNode(m);
+     return joinTwo(t, l, r);
+   }
+   return t->join(t, l, m, r);
+ }
+
+ static void combineJob(void *arg) {
+   JOB * j = arg;
+   j->result = combine(j->t, j->a, j->b, j->op);
+ }
+
+ static void rebalanceJob(void *arg) {
+   GST * t = arg;
+   rebalanceBST(t->tree);
+ }
+
+ static void mergeJob(void *arg) {
+   MERGE * m = arg;
+   GST * t = m->trees[0];
+   TNODE *(*join)(GST *, TNODE *, TNODE *, TNODE *) = t->join;
+   JOB * jobs = malloc(sizeof(JOB) * m->n);
+   TASK ** tasks = malloc(sizeof(TASK *) * m->n);
+   if (join == hang) {
+     for (int i = 0; i < m->n; ++i) {
+       if (t->pool) {
+         tasks[i] = spawnPOOL(t->pool, rebalanceJob, m->trees[i]);
+       }
+       else {
+         rebalanceJob(m->trees[i]);
+       }
+     }
+     for (int i = m->n - 1; i >= 0 && t->pool; --i) {
+       syncPOOL(t->pool, tasks[i]);
+     }
+     t->join = weigh;
+   }
+   for (int i = 0; i < m->n; ++i) {
+     jobs[i].t = t;
+     jobs[i].result = rootOf(m->trees[i]);
+     jobs[i].op = UNION;
+   }
+   for (int step = 1; step < m->n; step *= 2) {
+     int count = 0;
+     for (int i = 0; i + step < m->n; i += 2 * step) {
+       jobs[i].a = jobs[i].result;
+       jobs[i].b = jobs[i + step].result;
+       if (t->pool) {
+         tasks[count++] = spawnPOOL(t->pool, combineJob, &jobs[i]);
+       }
+       else {
+         combineJob(&jobs[i]);
+       }
+     }
+     while (count > 0) {
+       syncPOOL(t->pool, tasks[--count]);
+     }
+   }
+   t->join = join;
+   adopt(t, jobs[0].result);
+   for (int i = 1; i < m->n; ++i) {
+     adopt(m->trees[i], 0);
+     freeGST(m->trees[i]);
+   }
+   free(jobs);
+   free(tasks);
+ }
+
+ /* a weight-balanced joiner, with weights of subtree size plus one: k is
+ * hung in place of the first node down the facing spine of the heavier
+ * side that balances the lighter side, and each node back up the spine is
+ * restored with a single or double rotation
+ */
+ static TNODE *weigh(GST *t, TNODE *l, TNODE *k, TNODE *r) {
+   int wl = weight(l);
+   int wr = weight(r);
+   if (inBalance(wl, wr)) {
+     return hang(t, l, k, r);
+   }
+   int right = wl > wr;
+   TNODE * small = right ? r : l;
+   int ws = right ? wr : wl;
+   TNODE * at = right ? l : r;
+   TNODE * top = 0;
+   while (at && !inBalance(weight(at), ws)) {
+     top = at;
+     at = side(at, right);
+   }
+   TNODE * n = right ? hang(t, at, k, small) : hang(t, small, k, at);
+   setTNODEparent(n, top);
+   if (right) {
+     setTNODEright(top, n);
+   }
+   else {
+     setTNODEleft(top, n);
+   }
+   n = top;
+   while (n) {
+     TNODE * up = above(n);
+     TNODE * heavy = side(n, right);
+     int wo = weight(side(n, !right));
+     if (!inBalance(wo, weight(heavy))) {
+       TNODE * inner = side(heavy, !right);
+       if (inner == 0 || (inBalance(wo, weight(inner))
+           && inBalance(wo + weight(inner), weight(side(heavy, right))))) {
+         n = rotateUpGST(t, heavy);
+       }
+       else {
+         rotateUpGST(t, inner);
+         n = rotateUpGST(t, inner);
+       }
+     }
+     else {
+       updateGST(t, n);
+     }
+     top = n;
+     n = up;
+   }
+   return top;
+ }
+
+ static int weight(TNODE *n) {
+   return n ? getTNODEsize(n) + 1 : 1;
+ }
+
+ static int inBalance(int x, int y) {
+   return x >= ALPHA * (x + y) && y >= ALPHA * (x + y);
+ }
+
+ static TNODE *side(TNODE *n, int right) {
+   return right ? getTNODEright(n) : getTNODEleft(n);
+ }
+
+ // returns an empty tree set up like t but freeing its values with f
+ static GST *batchFor(GST *t, void (*f)(void *)) {
+   GST * batch = newGST(t->compare);
+   if (t->display) {
+     setGSTdisplay(batch, t->display);
+   }
+   if (f) {
+     setGSTfree(batch, f);
+   }
+   batch->join = t->join;
+   batch->pool = t->pool;
+   return batch;
+ }
+
+ /* builds the empty t from the n sorted values, one node per run of equal
+ * values with the run's length as its frequency; the surplus values of a
+ * run are kept as instances in multiset mode, or else freed if t frees
+ * values
+ */
+ static void fill(GST *t, void **sorted, int n) {
+   GSTVAL ** vals = malloc(sizeof(GSTVAL *) * (n + 1));
+   int count = 0;
+   for (int i = 0; i < n; ++i) {
+     if (count > 0 && t->compare(vals[count - 1]->val, sorted[i]) == 0) {
+       ++vals[count - 1]->freq;
+       if (t->multiset) {
+         hold(vals[count - 1], sorted[i]);
+       }
+       else if (t->freeMethod) {
+         t->freeMethod(sorted[i]);
+       }
+     }
+     else {
+       vals[count++] = newGSTVAL(t, sorted[i]);
+     }
+   }
+   adopt(t, build(t, vals, 0, count));
+   free(vals);
+ }
+
+ // joins the middle value between trees built from either half of the rest
+ static TNODE *build(GST *t, GSTVAL **vals, int lo, int hi) {
+   if (lo >= hi) {
+     return 0;
+   }
+   int mid = lo + (hi - lo) / 2;
+   TNODE * l = build(t, vals, lo, mid);
+   TNODE * r = build(t, vals, mid + 1, hi);
+   return t->join(t, l, newBSTnode(t->tree, vals[mid]), r);
+ }
+
+ // a stable bottom-up merge sort, since qsort cannot pass c to its callback
+ static void sortValues(int (*c)(void *, void *), void **v, int n) {
+   void ** from = v;
+   void ** to = malloc(sizeof(void *) * (n + 1));
+   void ** buffer = to;
+   for (int width = 1; width < n; width *= 2) {
+     for (int lo = 0; lo < n; lo += 2 * width) {
+       int mid = lo + width < n ? lo + width : n;
+       int hi = lo + 2 * width < n ? lo + 2 * width : n;
+       int i = lo, j = mid, k = lo;
+       while (i < mid && j < hi) {
+         to[k++] = c(from[j], from[i]) < 0 ? from[j++] : from[i++];
+       }
+       while (i < mid) {
+         to[k++] = from[i++];
+       }
+       while (j < hi) {
+         to[k++] = from[j++];
+       }
+     }
+     void ** swap = from;
+     from = to;
+     to = swap;
+   }
+   if (from != v) {
+     for (int i = 0; i < n; ++i) {
+       v[i] = from[i];
+     }
+   }
+   free(buffer);
+ }
+
+ // the free method of a batch of keys the caller still owns
+ static void keep(void *v) {
+   (void)v;
+ }
+
+ // returns the root of t, or null if it is empty
+ static TNODE *rootOf(GST *t) {
+   return sizeGST(t) ? getGSTroot(t) : 0;
+ }
+
+ /* makes the subtree under root the whole of t, taking the size and the
+ * duplicate count from the subtree's cached data
+ */
+ static void adopt(GST *t, TNODE *root) {
+   BST * tree = t->tree;
+   t->finger = 0;
+   t->stale = 1;
+   setBSTroot(tree, root);
+   if (root) {
+     setBSTsize(tree, getTNODEsize(root));
+     setGSTduplicates(t,
+         ((GSTVAL *)getTNODEvalue(root))->total - getTNODEsize(root));
+   }
+   else {
+     setBSTsize(tree, 0);
+     setGSTduplicates(t, 0);
+   }
+   refreshBST(tree, 0);
+ }
+
+ // frees a detached node, its value wrapper and, if t frees values, its value
+ static void dropNode(TNODE *n) {
+   freeGVAL((GSTVAL *)getTNODEvalue(n));
+   setTNODEfree(n, 0);
+   freeTNODE(n);
+ }
+
+ // frees every node of a subtree without recursion
+ static void dropSubtree(TNODE *n) {
+   while (n) {
+     if (getTNODEleft(n)) {
+       n = getTNODEleft(n);
+     }
+     else if (getTNODEright(n)) {
+       n = getTNODEright(n);
+     }
+     else {
+       TNODE * p = above(n);
+       if (p) {
+         if (getTNODEleft(p) == n) {
+           setTNODEleft(p, 0);
+         }
+         else {
+           setTNODEright(p, 0);
+         }
+       }
+       dropNode(n);
+       n = p;
+     }
+   }
+ }
+
+ static void swapVals(TNODE *x, TNODE *y) {
+   void *one = getTNODEvalue(x);
+   void *two = getTNODEvalue(y);
+   setTNODEvalue(x, two);
+   setTNODEvalue(y, one);
+ }
+
+ static TNODE * findGSTNode(GST *t, void *key) {
+   BST * tree = t->tree;
+   TNODE *temp = getBSTroot(tree);
+   if (temp == 0 || sizeBST(tree) == 0) {
+     return 0;
+   }
+   return findFrom(temp, key);
+ }
+
+ // searches the subtree under temp for the node holding key
+ static TNODE * findFrom(TNODE *temp, void *key) {
+   while (temp && compareGVAL((GSTVAL *)getTNODEvalue(temp), key) != 0) {
+     if (compareGVAL((GSTVAL *)getTNODEvalue(temp), key) > 0) {
+       temp = getTNODEleft(temp);
+     }
+     else {
+       temp = getTNODEright(temp);
+     }
+   }
+   return temp;
+ }
+
+ static void displayGVAL(GSTVAL *v, FILE *fp) {
+   void *val = v->val;
+   v->display(val, fp);
+   if (v->freq > 1) {
+     fprintf(fp, "<%d>", v->freq);
+   }
+ }
+
+ static int compareGVAL(void *x, void *y) {
+   GSTVAL *a = (GSTVAL *)x;
+   GSTVAL *b = (GSTVAL *)y;
+   return a->compare(a->val, b->val);
+ }
+
+ static void freeGVAL(GSTVAL *v) {
+   if (v->freeMethod) {
+     v->freeMethod(v->val);
+   }
+   v->freq = 1;
+   trim(v);
+   free(v->extra);
+   free(v);
+ }
+
+ static void hold(GSTVAL *v, void *payload) {
+   if (v->held == v->capacity) {
+     v->capacity = v->capacity ? v->capacity * 2 : 2;
+     v->extra = realloc(v->extra, sizeof(void *) * v->capacity);
+   }
+   v->extra[v->held++] = payload;
+ }
+
+ // drops the newest payloads until no more are held than freq calls for
+ static void trim(GSTVAL *v) {
+   while (v->held > 0 && v->held > v->freq - 1) {
+     --v->held;
+     if (v->freeMethod) {
+       v->freeMethod(v->extra[v->held]);
+     }
+   }
+ }
+
+ static int getGSTduplicates(GST * t) {
+   return t->duplicates;
+ }
+
+ static void setGSTduplicates(GST * t, int i) {
+   t->duplicates = i;
+ }
+
+ static void setGSTFreq(GSTVAL *v, int f) {
+   v->freq = f;
+ }
+
+ // higher frequency first, then the candidate further left
+ static int outranks(GST *t, RANKED *a, RANKED *b) {
+   if (a->freq != b->freq) {
+     return a->freq > b->freq;
+   }
+   GSTVAL * av = (GSTVAL *)getTNODEvalue(a->node);
+   GSTVAL * bv = (GSTVAL *)getTNODEvalue(b->node);
+   return t->compare(av->val, bv->val) < 0;
+ }
+
+ static void offer(GST *t, RANKED **heap, int *size, int *capacity,
+     RANKED r) {
+   if (*size == *capacity) {
+     *capacity *= 2;
+     *heap = realloc(*heap, sizeof(RANKED) * *capacity);
+   }
+   int i = (*size)++;
+   while (i > 0 && outranks(t, &r, &(*heap)[(i - 1) / 2])) {
+     (*heap)[i] = (*heap)[(i - 1) / 2];
+     i = (i - 1) / 2;
+   }
+   (*heap)[i] = r;
+ }
+
+ // restores the heap after its top has been replaced
+ static void sift(GST *t, RANKED *heap, int size) {
+   int i = 0;
+   RANKED r = heap[0];
+   while (2 * i + 1 < size) {
+     int c = 2 * i + 1;
+     if (c + 1 < size && outranks(t, &heap[c + 1], &heap[c])) {
+       ++c;
+     }
+     if (!outranks(t, &heap[c], &r)) {
+       break;
+     }
+     heap[i] = heap[c];
+     i = c;
+   }
+   heap[i] = r;
+ }
+
+ // the exact frequency of key in the tree, or 0 if it has none
+ static int count(GST *t, void *key) {
+   GSTVAL * v = entry(t, key);
+   return v ? v->freq : 0;
+ }
+
+ // the estimate for a key not in the tree; 0 until bounded mode evicts
+ static int untracked(GST *t, void *key) {
+   if (t->sketch == 0 || t->evicted == 0) {
+     return 0;
+   }
+   long estimate = estimateSKETCH(t->sketch, t->hash(key));
+   return estimate > 0 ? (int)estimate : 0;
+ }
+
+ /* makes room for v by removing the least frequent node, and gives v its
+ * starting frequency; returns the new root to insert under
+ */
+ static TNODE *evict(GST *t, GSTVAL *v) {
+   TNODE * n = leastNode(getBSTroot(t->tree));
+   GSTVAL * old = (GSTVAL *)getTNODEvalue(n);
+   long estimate = estimateSKETCH(t->sketch, t->hash(v->val));
+   if (old->freq > t->floor) {
+     t->floor = old->freq;
+   }
+   v->freq = t->floor + 1;
+   if (estimate > 0 && estimate < v->freq) {
+     v->freq = (int)estimate;
+   }
+   v->over = v->freq - 1;
+   setGSTduplicates(t, getGSTduplicates(t) - old->freq + v->freq);
+   unindex(t, old);
+   deleteBST(t->tree, old);
+   freeGVAL(old);
+   ++t->evicted;
+   t->finger = 0;
+   return getBSTroot(t->tree);
+ }
+
+ // the leftmost node whose frequency is the subtree's least
+ static TNODE *leastNode(TNODE *n) {
+   int least = ((GSTVAL *)getTNODEvalue(n))->least;
+   while (1) {
+     TNODE * l = getTNODEleft(n);
+     if (l && ((GSTVAL *)getTNODEvalue(l))->least == least) {
+       n = l;
+     }
+     else if (((GSTVAL *)getTNODEvalue(n))->freq == least) {
+       return n;
+     }
+     else {
+       n = getTNODEright(n);
+     }
+   }
+ }
+
+ /* takes back the increments that have left the window, if EXPIRE of them
+ * are due or all is set; sorting the batch by value gathers each key's
+ * increments, so each key is found and updated once; returns how many
+ * nodes left the tree
+ */
+ static int slide(GST *t, int all) {
+   long edge = t->clock - t->span;
+   int due = all ? 1 : EXPIRE;
+   if (t->pending < due
+       || t->ring[(t->head + due - 1) % t->slots].when > edge) {
+     return 0;
+   }
+   int n = 0, pruned = 0;
+   GSTVAL ** batch = malloc(sizeof(GSTVAL *) * t->pending);
+   while (n < t->pending && t->ring[t->head].when <= edge) {
+     batch[n++] = t->ring[t->head].v;
+     t->head = (t->head + 1) % t->slots;
+   }
+   t->pending -= n;
+   qsort(batch, n, sizeof(GSTVAL *), byAddress);
+   for (int i = 0, j; i < n; i = j) {
+     for (j = i + 1; j < n && batch[j] == batch[i]; ++j) {
+       continue;
+     }
+     GSTVAL * v = batch[i];
+     TNODE * node = findGSTNode(t, v);
+     if (v->freq > j - i) {
+       setGSTFreq(v, v->freq - (j - i));
+       setGSTduplicates(t, getGSTduplicates(t) - (j - i));
+       trim(v);
+       refreshGST(t, node);
+     }
+     else {
+       setGSTduplicates(t, getGSTduplicates(t) - (v->freq - 1));
+       unindex(t, v);
+       deleteBST(t->tree, v);
+       freeGVAL(v);
+       ++pruned;
+     }
+   }
+   free(batch);
+   if (pruned) {
+     t->finger = 0;
+   }
+   return pruned;
+ }
+
+ // appends an increment of v to the window, growing the ring if full
+ static void record(GST *t, GSTVAL *v) {
+   if (t->pending == t->slots) {
+     int slots = t->slots ? t->slots * 2 : EXPIRE;
+     STAMP * ring = malloc(sizeof(STAMP) * slots);
+     for (int i = 0; i < t->pending; ++i) {
+       ring[i] = t->ring[(t->head + i) % t->slots];
+     }
+     free(t->ring);
+     t->ring = ring;
+     t->slots = slots;
+     t->head = 0;
+   }
+   STAMP * s = &t->ring[(t->head + t->pending++) % t->slots];
+   s->v = v;
+   s->when = t->clock;
+ }
+
+ static int byAddress(const void *a, const void *b) {
+   GSTVAL * x = *(GSTVAL * const *)a;
+   GSTVAL * y = *(GSTVAL * const *)b;
+   return (x > y) - (x < y);
+ }
+
+ // adapts the value codec of saveGST and loadGST to saveGSTwith and
+ // loadGSTwith, which pass it as arg
+ static void putPlain(void *value, FILE *fp, void *arg) {
+   ((PLAIN *)arg)->put(value, fp);
+ }
+
+ static void *getPlain(FILE *fp, void *arg) {
+   return ((PLAIN *)arg)->get(fp);
+ }
+
+ // writes n seven bits a byte, low bits first, the top bit marking more
+ static void putCount(FILE *fp, unsigned long n) {
+   while (n >= 128) {
+     fputc((int)(n & 127) | 128, fp);
+     n >>= 7;
+   }
+   fputc((int)n, fp);
+ }
+
+ // reads a count written by putCount; returns -1 if the file ends first
+ static int getCount(FILE *fp, unsigned long *n) {
+   *n = 0;
+   for (int shift = 0; shift < 64; shift += 7) {
+     int c = fgetc(fp);
+     if (c == EOF) {
+       return -1;
+     }
+     *n |= (unsigned long)(c & 127) << shift;
+     if ((c & 128) == 0) {
+       return 0;
+     }
+   }
+   return -1;
+ }
+
+ // the wrapper for key, from the index, rebuilt first if it is stale
+ static GSTVAL *lookup(GST *t, void *key) {
+   if (t->stale) {
+     refit(t);
+   }
+   if (key == 0) {
+     return 0;
+   }
+   GSTVAL probe;
+   probe.val = key;
+   return findINDEX(t->index, t->hash(key), &probe);
+ }
+
+ // the wrapper for key, or null, by way of the cache, filter and index if set
+ static GSTVAL *entry(GST *t, void *key) {
+   GSTVAL probe;
+   probe.val = key;
+   GSTVAL * v;
+   if (t->cache) {
+     if (t->stale) {
+       refit(t);
+     }
+     v = findCACHE(t->cache, t->hash(key), &probe);
+     if (v) {
+       return v;
+     }
+   }
+   if (t->filter && screen(t, key) == 0) {
+     return 0;
+   }
+   if (t->index) {
+     v = lookup(t, key);
+   }
+   else {
+     TNODE * n = findGSTNode(t, &probe);
+     v = n ? getTNODEvalue(n) : 0;
+   }
+   if (v == 0 && t->filter) {
+     missed(t);
+   }
+   if (v && t->cache) {
+     addCACHE(t->cache, t->hash(key), v);
+   }
+   return v;
+ }
+
+ /* rebuilds the index and the filter from one walk after a bulk change,
+ * and empties the cache, whose values may have been freed
+ */
+ static void refit(GST *t) {
+   t->stale = 0;
+   if (t->cache) {
+     clearCACHE(t->cache);
+   }
+   if (t->index) {
+     clearINDEX(t->index);
+     for (TNODE * n = firstBST(t->tree); n; n = nextBST(t->tree, n)) {
+       GSTVAL * v = getTNODEvalue(n);
+       addINDEX(t->index, t->hash(v->val), v);
+     }
+   }
+   if (t->filter) {
+     refilter(t, 2 * sizeGST(t));
+   }
+ }
+
+ // returns 0 if the filter shows key is not in the tree
+ static int screen(GST *t, void *key) {
+   if (t->stale) {
+     refit(t);
+   }
+   if (holdsFILTER(t->filter, t->hash(key))) {
+     return 1;
+   }
+   ++t->rejected;
+   return 0;
+ }
+
+ /* notes an absent key the filter let through; once the share of these
+ * among recent absent keys is twice what the filter was built for, it is
+ * rebuilt at twice the size, up to room for 16 times the keys it holds
+ */
+ static void missed(GST *t) {
+   long absent = ++t->passed + t->rejected;
+   int keys = capacityFILTER(t->filter);
+   if (absent >= 1024 && t->passed > 2 * SCREEN * absent
+       && keys < 16 * sizeGST(t)) {
+     refilter(t, 2 * keys);
+   }
+   else if (absent >= 65536) {
+     t->passed /= 2;
+     t->rejected /= 2;
+   }
+ }
+
+ // replaces the filter with one sized for keys keys, filled from the tree
+ static void refilter(GST *t, int keys) {
+   freeFILTER(t->filter);
+   t->filter = newFILTER(keys > 1024 ? keys : 1024, SCREEN);
+   for (TNODE * n = firstBST(t->tree); n; n = nextBST(t->tree, n)) {
+     addFILTER(t->filter, t->hash(((GSTVAL *)getTNODEvalue(n))->val));
+   }
+   t->passed = 0;
+   t->rejected = 0;
+   ++t->refilters;
+ }
+
+ static void enroll(GST *t, GSTVAL *v) {
+   if (t->stale) {
+     return;
+   }
+   if (t->index) {
+     addINDEX(t->index, t->hash(v->val), v);
+   }
+   if (t->filter) {
+     addFILTER(t->filter, t->hash(v->val));
+     if (sizeFILTER(t->filter) > capacityFILTER(t->filter)) {
+       refilter(t, 2 * capacityFILTER(t->filter));
+     }
+   }
+ }
+
+ static void unindex(GST *t, GSTVAL *v) {
+   if (t->stale) {
+     return;
+   }
+   if (t->index) {
+     removeINDEX(t->index, t->hash(v->val), v);
+   }
+   if (t->filter) {
+     removeFILTER(t->filter, t->hash(v->val));
+   }
+   if (t->cache) {
+     removeCACHE(t->cache, t->hash(v->val), v);
+   }
  }
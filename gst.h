@@ -6,6 +6,8 @@
 #include <stdio.h>
 #include "tnode.h"
 #include "bst.h"
+#include "pool.h"
+#include "frozen.h"
 
 typedef struct gst GST;
 
@@ -16,7 +18,10 @@ extern void   setGSTfree(GST *t,void (*)(void *));
 extern TNODE *getGSTroot(GST *t);
 extern void   setGSTroot(GST *t,TNODE *replacement);
 extern void   setGSTsize(GST *t,int s);
+extern void   setGSTrelink(GST *t,int on);
 extern TNODE *insertGST(GST *t,void *value);
+extern TNODE *insertGSThint(GST *t,TNODE *hint,void *value);
+extern void   setGSTfinger(GST *t,int on);
 extern void  *findGST(GST *t,void *key);
 extern TNODE *locateGST(GST *t,void *key);
 extern int    deleteGST(GST *t,void *key);
@@ -27,10 +32,69 @@ extern void   statisticsGST(GST *t,FILE *fp);
 extern void   displayGST(GST *t,FILE *fp);
 extern int    debugGST(GST *t,int level);
 extern void   freeGST(GST *t);
+extern void   depthsGST(GST *t,FILE *fp);
+extern void   refreshGST(GST *t,TNODE *n);
+extern void   updateGST(GST *t,TNODE *n);
 
 /* extensions of BST */
 extern void   *unwrapGST(TNODE *n);
 extern int    freqGST(GST *g,void *key);
 extern int    duplicatesGST(GST *g);
+extern int    nodeFreqGST(TNODE *n);
+extern void   setGSTmultiset(GST *t,int on);
+extern void  *popGST(GST *t,void *key);
+extern void  *instanceGST(TNODE *n,int i);
+extern int    topKGST(GST *t,int k,TNODE **results);
+extern int    setGSTbudget(GST *t,int capacity,double epsilon,double delta,
+                unsigned long (*h)(void *));
+extern int    errorGST(GST *t,void *key);
+extern int    setGSTwindow(GST *t,long span);
+extern TNODE *insertGSTat(GST *t,void *value,long stamp);
+extern void   advanceGST(GST *t,long now);
+extern void   setGSTindex(GST *t,unsigned long (*h)(void *));
+extern long   indexBytesGST(GST *t);
+extern void   setGSTfilter(GST *t,unsigned long (*h)(void *));
+extern void   setGSTcache(GST *t,int entries,unsigned long (*h)(void *));
+extern FROZEN *freezeGST(GST *t,unsigned long (*h)(void *));
+extern int    publishGST(GST *t,char *path,char *(*text)(void *));
+extern int    saveGST(GST *t,char *path,void (*put)(void *,FILE *));
+extern int    loadGST(GST *t,char *path,void *(*get)(FILE *));
+extern int    saveGSTwith(GST *t,char *path,char *magic,
+                void (*put)(void *,FILE *,void *),void *arg);
+extern int    loadGSTwith(GST *t,char *path,char *magic,
+                void *(*get)(FILE *,void *),void *arg);
+
+/* join-based set operations; b is consumed and the result left in a */
+extern void   setGSTjoiner(GST *t,
+                TNODE *(*j)(GST *t,TNODE *l,TNODE *k,TNODE *r));
+extern GST   *joinGST(GST *left,void *pivot,GST *right);
+extern void   splitGST(GST *t,void *key,GST *right);
+extern GST   *unionGST(GST *a,GST *b);
+extern GST   *intersectionGST(GST *a,GST *b);
+extern GST   *differenceGST(GST *a,GST *b);
+extern void   setGSTpool(GST *t,POOL *p);
+extern void   insertManyGST(GST *t,void **values,int n);
+extern void   deleteManyGST(GST *t,void **keys,int n);
+extern void   sortGST(GST *t,void **values,int n);
+extern GST   *mergeGST(GST **trees,int n);
+extern TNODE *rotateUpGST(GST *t,TNODE *n);
+
+/* batched lookups; results[i] answers keys[i] */
+extern void   locateManyGST(GST *t,void **keys,int n,TNODE **results);
+extern void   findManyGST(GST *t,void **keys,int n,void **results);
+extern void   freqManyGST(GST *t,void **keys,int n,int *results);
+
+/* ordered cursors and point queries; unwrap results with unwrapGST */
+extern TNODE *firstGST(GST *t);
+extern TNODE *lastGST(GST *t);
+extern TNODE *nextGST(GST *t,TNODE *n);
+extern TNODE *prevGST(GST *t,TNODE *n);
+extern TNODE *seekGST(GST *t,void *key);
+extern TNODE *floorGST(GST *t,void *key);
+extern TNODE *ceilingGST(GST *t,void *key);
+extern TNODE *predecessorGST(GST *t,void *key);
+extern TNODE *successorGST(GST *t,void *key);
+extern int    rangeGST(GST *t,void *lo,void *hi,
+                void (*f)(TNODE *n,void *arg),void *arg);
 
 #endif /* gst.h */
@@ -0,0 +1,147 @@
+/*File: index.c
+ *Implements functions found in index.h: an open-addressing hash table of
+ *items, kept with Robin Hood probing, for exact-match lookups beside a tree
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "index.h"
+
+// the table doubles when more than 7 slots in 8 would be full
+#define LOAD(n) ((n) - (n) / 8)
+
+/* each slot keeps the item's full hash, so a probe compares items only
+* when the hashes agree, and the probe distance is computed from it; an
+* insert takes the slot of any item nearer its home than the newcomer,
+* which keeps every probe sequence short, and a delete shifts the rest of
+* its run back a slot rather than leaving a tombstone
+*/
+typedef struct slot {
+  unsigned long hash;
+  void *item;
+} SLOT;
+
+struct index {
+  SLOT *slots;
+  int capacity; // a power of two
+  int size;
+  int (*compare)(void *item, void *key);
+};
+
+static void place(INDEX *x, unsigned long hash, void *item);
+static int distance(INDEX *x, unsigned long hash, int at);
+static int seek(INDEX *x, unsigned long hash, void *key);
+static void grow(INDEX *x);
+
+// items match a key when c(item, key) is 0
+extern INDEX *newINDEX(int (*c)(void *, void *)) {
+  INDEX *x = malloc(sizeof(INDEX));
+  assert(x != NULL);
+  x->capacity = 16;
+  x->size = 0;
+  x->compare = c;
+  x->slots = calloc(x->capacity, sizeof(SLOT));
+  assert(x->slots != NULL);
+  return x;
+}
+
+// the item must not already be in x
+extern void addINDEX(INDEX *x, unsigned long hash, void *item) {
+  if (x->size + 1 > LOAD(x->capacity)) { grow(x); }
+  place(x, hash, item);
+  ++x->size;
+}
+
+extern void *findINDEX(INDEX *x, unsigned long hash, void *key) {
+  int at = seek(x, hash, key);
+  return at < 0 ? 0 : x->slots[at].item;
+}
+
+// returns the item removed, or null if none matched
+extern void *removeINDEX(INDEX *x, unsigned long hash, void *key) {
+  int at = seek(x, hash, key);
+  if (at < 0) { return 0; }
+  void *item = x->slots[at].item;
+  int mask = x->capacity - 1;
+  int next = (at + 1) & mask;
+  while (x->slots[next].item && distance(x, x->slots[next].hash, next) > 0) {
+    x->slots[at] = x->slots[next];
+    at = next;
+    next = (next + 1) & mask;
+  }
+  x->slots[at].item = 0;
+  --x->size;
+  return item;
+}
+
+extern void clearINDEX(INDEX *x) {
+  for (int i = 0; i < x->capacity; ++i) { x->slots[i].item = 0; }
+  x->size = 0;
+}
+
+extern int sizeINDEX(INDEX *x) {
+  return x->size;
+}
+
+extern long bytesINDEX(INDEX *x) {
+  return (long)sizeof(INDEX) + (long)sizeof(SLOT) * x->capacity;
+}
+
+extern void freeINDEX(INDEX *x) {
+  free(x->slots);
+  free(x);
+}
+
+static void place(INDEX *x, unsigned long hash, void *item) {
+  int mask = x->capacity - 1;
+  int at = (int)(hash & mask);
+  int d = 0;
+  while (x->slots[at].item) {
+    int theirs = distance(x, x->slots[at].hash, at);
+    if (theirs < d) {
+      SLOT displaced = x->slots[at];
+      x->slots[at].hash = hash;
+      x->slots[at].item = item;
+      hash = displaced.hash;
+      item = displaced.item;
+      d = theirs;
+    }
+    at = (at + 1) & mask;
+    ++d;
+  }
+  x->slots[at].hash = hash;
+  x->slots[at].item = item;
+}
+
+// how far the slot at is from the home slot of hash
+static int distance(INDEX *x, unsigned long hash, int at) {
+  return (at - (int)(hash & (x->capacity - 1))) & (x->capacity - 1);
+}
+
+/* returns the slot holding key, or -1; the search stops at an empty slot
+* or at an item nearer its home than key would be, as key would have
+* taken that slot
+*/
+static int seek(INDEX *x, unsigned long hash, void *key) {
+  int mask = x->capacity - 1;
+  int at = (int)(hash & mask);
+  for (int d = 0; x->slots[at].item; ++d) {
+    SLOT *s = &x->slots[at];
+    if (distance(x, s->hash, at) < d) { return -1; }
+    if (s->hash == hash && x->compare(s->item, key) == 0) { return at; }
+    at = (at + 1) & mask;
+  }
+  return -1;
+}
+
+static void grow(INDEX *x) {
+  SLOT *old = x->slots;
+  int capacity = x->capacity;
+  x->capacity *= 2;
+  x->slots = calloc(x->capacity, sizeof(SLOT));
+  assert(x->slots != NULL);
+  for (int i = 0; i < capacity; ++i) {
+    if (old[i].item) { place(x, old[i].hash, old[i].item); }
+  }
+  free(old);
+}
@@ -0,0 +1,15 @@
+#ifndef __INDEX_INCLUDED__
+#define __INDEX_INCLUDED__
+
+typedef struct index INDEX;
+
+extern INDEX *newINDEX(int (*c)(void *,void *));
+extern void   addINDEX(INDEX *x,unsigned long hash,void *item);
+extern void  *findINDEX(INDEX *x,unsigned long hash,void *key);
+extern void  *removeINDEX(INDEX *x,unsigned long hash,void *key);
+extern void   clearINDEX(INDEX *x);
+extern int    sizeINDEX(INDEX *x);
+extern long   bytesINDEX(INDEX *x);
+extern void   freeINDEX(INDEX *x);
+
+#endif
@@ -49,3 +49,29 @@ freeINTEGER(void *v)
     {
     free((INTEGER *) v);
     }
+
+unsigned long
+hashINTEGER(void *v)
+    {
+    unsigned long long x = (unsigned int) getINTEGER((INTEGER *) v);
+    x = (x ^ (x >> 16)) * 0x45d9f3bULL;
+    x = (x ^ (x >> 16)) * 0x45d9f3bULL;
+    return (unsigned long) (x ^ (x >> 16));
+    }
+
+// writes v for readINTEGER, as the int's bytes
+void
+writeINTEGER(void *v,FILE *fp)
+    {
+    int x = getINTEGER((INTEGER *) v);
+    fwrite(&x,sizeof(int),1,fp);
+    }
+
+// returns null if the file ends first
+void *
+readINTEGER(FILE *fp)
+    {
+    int x;
+    if (fread(&x,sizeof(int),1,fp) != 1) return 0;
+    return newINTEGER(x);
+    }
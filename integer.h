@@ -11,5 +11,8 @@ extern int setINTEGER(INTEGER *,int);
 extern int compareINTEGER(void *,void *);
 extern void displayINTEGER(void *,FILE *);
 extern void freeINTEGER(void *);
+extern unsigned long hashINTEGER(void *);
+extern void writeINTEGER(void *,FILE *);
+extern void *readINTEGER(FILE *);
 
 #endif
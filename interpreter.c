@@ -7,6 +7,11 @@
 #include "gst.h"
 #include "scanner.h"
 #include "string.h"
+#include "mapped.h"
+#include "wal.h"
+#include "server.h"
+#include "pipeline.h"
+#include "binary.h"
 
 RBT *readRBTCorpus(RBT *tree, char *filename);
 void readRBTCommands(RBT *tree, char *filename, FILE *outfp);
@@ -14,6 +19,69 @@ GST *readGSTCorpus(GST *tree, char * filename);
 void readGSTCommands(GST *tree, char *filename, FILE *outfp);
 char * cleanString(char * str, int s);
 static void skipWhiteSpace(FILE *fp);
+static void flushRBTLookups(RBT *tree, STRING **keys, int *count, FILE *outfp);
+static void flushGSTLookups(GST *tree, STRING **keys, int *count, FILE *outfp);
+static int readCount(FILE *fp);
+static void reportTop(TNODE **top, int found, void *(*unwrap)(TNODE *),
+    FILE *outfp);
+
+// consecutive 'f' commands are answered together, up to this many at a time
+#define LOOKUPS 64
+
+// under -q, the GST's frequencies frozen after the corpus loads
+static FROZEN *frozen = 0;
+static void thaw(void);
+static char *textSTRING(void *v);
+
+// under -rl and -gl, commits come every GROUP changes and checkpoints
+// every CHECKPOINT; the test build sets a small CHECKPOINT
+#define GROUP 1024
+#ifndef CHECKPOINT
+#define CHECKPOINT 1000000
+#endif
+
+// under -rl and -gl, the log of the changes the commands make
+static WAL *journal = 0;
+static void record(int op, char *str);
+static void checkpoint(int (*save)(char *, void *), void *tree);
+static int saveRBTTree(char *path, void *tree);
+static int saveGSTTree(char *path, void *tree);
+static void applyRBT(int op, char *key, int length, void *tree);
+static void applyGST(int op, char *key, int length, void *tree);
+
+// a command as read, for running at once or by another thread
+typedef struct command {
+  int op;
+  char *key; // cleaned, for 'f', 'd' and 'i'
+  int count; // for 'k'
+} COMMAND;
+
+static void runRBTCommands(RBT *tree, FILE *fp, FILE *outfp);
+static int readCommand(FILE *fp, COMMAND *command);
+static void runRBTCommand(RBT *tree, COMMAND *command, STRING **lookups,
+    int *lookupCount, FILE *outfp);
+static char *scanKey(FILE *fp, int *failed);
+static char *readKey(FILE *fp);
+static void serveRBT(FILE *in, FILE *out, void *tree);
+
+// under -p, commands parsed this far ahead of the tree at most
+#define AHEAD 4096
+
+// the executor's state under -p
+typedef struct stream {
+  FILE *fp; // read by the parsing stage alone
+  RBT *tree;
+  STRING *lookups[LOOKUPS];
+  int lookupCount;
+  int failed;
+} STREAM;
+
+static void *parseCommand(void *arg);
+static void executeCommand(void *item, FILE *out, void *arg);
+
+static void runBinaryRBT(RBT *tree, BINARY *b, FILE *outfp);
+static void flushKeptLookups(RBT *tree, STRING **keys, int *count,
+    FILE *outfp);
 
 
 void RBTInterpreter(RBT *tree, char **argv, FILE *outfp) {
@@ -26,10 +94,263 @@ void GSTInterpreter(GST *tree, char **argv, FILE *outfp) {
   readGSTCommands(tree, argv[3], outfp);
 }
 
+// as GSTInterpreter, but 'f' is answered from a frozen table until an 'i' or 'd'
+void FrozenInterpreter(GST *tree, char **argv, FILE *outfp) {
+  tree = readGSTCorpus(tree, argv[2]);
+  frozen = freezeGST(tree, hashSTRING);
+  readGSTCommands(tree, argv[3], outfp);
+  thaw();
+}
+
+// loads the corpus given and writes the tree to a snapshot, for later runs
+void RBTSnapshot(RBT *tree, char **argv, FILE *outfp) {
+  tree = readRBTCorpus(tree, argv[2]);
+  if (saveRBT(tree, argv[3], writeSTRING) != 0) {
+    fprintf(outfp, "Error: %s could not be written.\n", argv[3]);
+  }
+}
+
+void GSTSnapshot(GST *tree, char **argv, FILE *outfp) {
+  tree = readGSTCorpus(tree, argv[2]);
+  if (saveGST(tree, argv[3], writeSTRING) != 0) {
+    fprintf(outfp, "Error: %s could not be written.\n", argv[3]);
+  }
+}
+
+// loads the corpus given and publishes its counts as a mapped tree, for -m
+void RBTPublish(RBT *tree, char **argv, FILE *outfp) {
+  tree = readRBTCorpus(tree, argv[2]);
+  if (publishRBT(tree, argv[3], textSTRING) != 0) {
+    fprintf(outfp, "Error: %s could not be written.\n", argv[3]);
+  }
+}
+
+/* answers commands from a mapped tree published by -ms, with no corpus to
+ * load; other runs may share the file, and a newer version published over
+ * it is picked up every LOOKUPS commands; the tree is read-only, so 'i'
+ * and 'd' change nothing, and 's' and 'k' are not answered
+ */
+void MappedInterpreter(char **argv, FILE *outfp) {
+  MAPPED * m = openMAPPED(argv[2]);
+  if (m == 0) {
+    fprintf(outfp, "Error: %s is not a mapped tree.\n", argv[2]);
+    return;
+  }
+  FILE *fp = fopen(argv[3], "r");
+  if (fp == 0) {
+    printf("Error: %d (%s)\n", errno, strerror(errno));
+    closeMAPPED(m);
+    return;
+  }
+  char *str;
+  int commands = 0;
+  int c = fgetc(fp);
+  while (!feof(fp)) {
+    if (strchr("rfdi", c) && c && ++commands % LOOKUPS == 0) {
+      refreshMAPPED(m);
+    }
+    switch (c) {
+      case 'r':
+        fprintf(outfp, "Mapped: %d keys, %ld bytes\n", sizeMAPPED(m),
+            bytesMAPPED(m));
+        break;
+      case 'f':
+      case 'd':
+      case 'i':
+        str = readKey(fp);
+
+        str = cleanString(str, strlen(str));
+
+        if (c == 'f') {
+          fprintf(outfp, "Frequency of \"%s\": %d\n", str, freqMAPPED(m, str));
+        }
+        else if (str[0] != '\0' && !(str[0] == ' ' && str[1] == '\0')) {
+          fprintf(outfp, "Value \"%s\" not changed: the tree is read-only.\n",
+              str);
+        }
+        free(str);
+        break;
+    }
+    c = fgetc(fp);
+  }
+  fclose(fp);
+  closeMAPPED(m);
+}
+
+/* as RBTInterpreter, but each change is logged to argv[4]; once a log
+ * exists the corpus is passed over, and the tree is recovered from the
+ * log's last checkpoint and the changes logged after it
+ */
+void RBTJournal(RBT *tree, char **argv, FILE *outfp) {
+  journal = openWAL(argv[4], GROUP);
+  if (journal == 0) {
+    fprintf(outfp, "Error: %s is not a log.\n", argv[4]);
+    return;
+  }
+  char * snapshot = snapshotWAL(journal);
+  if (snapshot == 0) {
+    tree = readRBTCorpus(tree, argv[2]);
+  }
+  else if (loadRBT(tree, snapshot, readSTRING) != 0) {
+    fprintf(outfp, "Error: %s could not be read.\n", snapshot);
+    closeWAL(journal);
+    journal = 0;
+    return;
+  }
+  replayWAL(journal, applyRBT, tree);
+  if (snapshot == 0) {
+    checkpointWAL(journal, saveRBTTree, tree);
+  }
+  readRBTCommands(tree, argv[3], outfp);
+  closeWAL(journal);
+  journal = 0;
+}
+
+void GSTJournal(GST *tree, char **argv, FILE *outfp) {
+  journal = openWAL(argv[4], GROUP);
+  if (journal == 0) {
+    fprintf(outfp, "Error: %s is not a log.\n", argv[4]);
+    return;
+  }
+  char * snapshot = snapshotWAL(journal);
+  if (snapshot == 0) {
+    tree = readGSTCorpus(tree, argv[2]);
+  }
+  else if (loadGST(tree, snapshot, readSTRING) != 0) {
+    fprintf(outfp, "Error: %s could not be read.\n", snapshot);
+    closeWAL(journal);
+    journal = 0;
+    return;
+  }
+  replayWAL(journal, applyGST, tree);
+  if (snapshot == 0) {
+    checkpointWAL(journal, saveGSTTree, tree);
+  }
+  readGSTCommands(tree, argv[3], outfp);
+  closeWAL(journal);
+  journal = 0;
+}
+
+/* loads the corpus given and keeps the tree resident, answering commands
+ * sent to the Unix socket argv[3] until a SIGINT or SIGTERM; any number of
+ * clients may send at once, and their changes are made in the order they
+ * arrive
+ */
+void RBTServer(RBT *tree, char **argv, FILE *outfp) {
+  tree = readRBTCorpus(tree, argv[2]);
+  SERVER * s = newSERVER(argv[3]);
+  if (s == 0) {
+    fprintf(outfp, "Error: %s could not be listened on.\n", argv[3]);
+    return;
+  }
+  if (runSERVER(s, serveRBT, tree) != 0) {
+    fprintf(outfp, "Error: %d (%s)\n", errno, strerror(errno));
+  }
+  freeSERVER(s);
+}
+
+// sends the commands in argv[3] to the server at argv[2] and prints its answers
+void ClientInterpreter(char **argv, FILE *outfp) {
+  FILE *fp = fopen(argv[3], "r");
+  if (fp == 0) {
+    printf("Error: %d (%s)\n", errno, strerror(errno));
+    return;
+  }
+  if (talkSERVER(argv[2], fp, outfp) != 0) {
+    fprintf(outfp, "Error: no server answers at %s.\n", argv[2]);
+  }
+  fclose(fp);
+}
+
+/* as RBTInterpreter, but the commands are streamed from argv[3], which
+ * may be a FIFO, or "-" for the standard input; one thread parses them,
+ * another runs them against the tree and a third writes the answers, so
+ * a command is answered as soon as it is read
+ */
+void RBTStream(RBT *tree, char **argv, FILE *outfp) {
+  tree = readRBTCorpus(tree, argv[2]);
+  FILE *fp = strcmp(argv[3], "-") == 0 ? stdin : fopen(argv[3], "r");
+  if (fp == 0) {
+    printf("Error: %d (%s)\n", errno, strerror(errno));
+    return;
+  }
+  STREAM stream = { fp, tree, { 0 }, 0, 0 };
+  runPIPELINE(parseCommand, executeCommand, &stream, outfp, AHEAD);
+  if (fp != stdin) {
+    fclose(fp);
+  }
+  if (stream.failed) {
+    exit(6);
+  }
+}
+
+/* writes the commands in argv[2] to argv[3] in the binary form, each key
+ * cleaned as it would be when run; 'd' and 'i' commands whose keys clean
+ * away change nothing, and are left out
+ */
+void CompileCommands(char **argv, FILE *outfp) {
+  FILE *fp = fopen(argv[2], "r");
+  if (fp == 0) {
+    printf("Error: %d (%s)\n", errno, strerror(errno));
+    return;
+  }
+  BINARY * b = createBINARY(argv[3]);
+  if (b == 0) {
+    fprintf(outfp, "Error: %s could not be written.\n", argv[3]);
+    fclose(fp);
+    return;
+  }
+  COMMAND command;
+  int status;
+  while ((status = readCommand(fp, &command)) > 0) {
+    char * str = command.key;
+    if (command.op == 'k') {
+      putBINARY(b, 'k', 0, command.count);
+    }
+    else if (str == 0) {
+      putBINARY(b, command.op, 0, 0);
+    }
+    else if (command.op == 'f' || (str[0] != '\0'
+        && !(str[0] == ' ' && str[1] == '\0'))) {
+      putBINARY(b, command.op, str, strlen(str));
+    }
+    free(str);
+  }
+  fclose(fp);
+  if (closeBINARY(b) != 0) {
+    fprintf(outfp, "Error: %s could not be written.\n", argv[3]);
+  }
+  if (status < 0) {
+    exit(6);
+  }
+}
+
+// as RBTInterpreter, but the commands in argv[3] are in the binary form
+void RBTBinary(RBT *tree, char **argv, FILE *outfp) {
+  tree = readRBTCorpus(tree, argv[2]);
+  BINARY * b = openBINARY(argv[3]);
+  if (b == 0) {
+    fprintf(outfp, "Error: %s is not a command file.\n", argv[3]);
+    return;
+  }
+  runBinaryRBT(tree, b, outfp);
+  closeBINARY(b);
+}
+
+// a corpus may be a snapshot, which is loaded whole, shape and all
 RBT *readRBTCorpus(RBT *tree, char *filename) {
   STRING * finalStr;
   char *str;
-  int test;
+
+  // a snapshot is loaded; one that fails to load is not read as text
+  int loaded = loadRBT(tree, filename, readSTRING);
+  if (loaded == 0) {
+    return tree;
+  }
+  if (loaded == -2) {
+    printf("Error: %s is not a readable RBT snapshot.\n", filename);
+    exit(0);
+  }
 
   int lineTest = 1;
   //char c;
@@ -39,10 +360,7 @@ RBT *readRBTCorpus(RBT *tree, char *filename) {
     exit(0);
   }
 
-  skipWhiteSpace(fp);
-  test = fgetc(fp);
-  if(test == '"') { ungetc(test, fp); str = readString(fp); }
-  else { ungetc(test, fp); str = readToken(fp); }
+  str = readKey(fp);
 
     while (!feof(fp))
     {
@@ -61,10 +379,7 @@ RBT *readRBTCorpus(RBT *tree, char *filename) {
         }
         lineTest++;
       }
-      skipWhiteSpace(fp);
-      test = fgetc(fp);
-      if(test == '"') { ungetc(test, fp); str = readString(fp); }
-      else { ungetc(test, fp); str = readToken(fp); }
+      str = readKey(fp);
     }
   fclose(fp);
 
@@ -75,7 +390,16 @@ RBT *readRBTCorpus(RBT *tree, char *filename) {
 GST *readGSTCorpus(GST *tree, char * filename) {
   STRING * finalStr;
   char *str;
-  int test;
+
+  // a snapshot is loaded; one that fails to load is not read as text
+  int loaded = loadGST(tree, filename, readSTRING);
+  if (loaded == 0) {
+    return tree;
+  }
+  if (loaded == -2) {
+    printf("Error: %s is not a readable GST snapshot.\n", filename);
+    exit(0);
+  }
 
   int lineTest = 1;
   //char c;
@@ -85,10 +409,7 @@ GST *readGSTCorpus(GST *tree, char * filename) {
     exit(0);
   }
 
-  skipWhiteSpace(fp);
-  test = fgetc(fp);
-  if(test == '"') { ungetc(test, fp); str = readString(fp); }
-  else { ungetc(test, fp); str = readToken(fp); }
+  str = readKey(fp);
 
     while (!feof(fp))
     {
@@ -107,10 +428,7 @@ GST *readGSTCorpus(GST *tree, char * filename) {
         lineTest++;
 
       }
-      skipWhiteSpace(fp);
-      test = fgetc(fp);
-      if(test == '"') { ungetc(test, fp); str = readString(fp); }
-      else { ungetc(test, fp); str = readToken(fp); }
+      str = readKey(fp);
     }
   fclose(fp);
 
@@ -118,78 +436,152 @@ GST *readGSTCorpus(GST *tree, char * filename) {
 }
 
 void readRBTCommands(RBT *tree, char *filename, FILE *outfp) {
-  STRING * finalStr;
-  char *str;
-  int test;
-  int freq;
   FILE *fp = fopen(filename, "r");
   if (fp == 0) {
     fprintf(stderr, "Error: %s could not be opened for reading.\n", filename);
   }
-  int c = fgetc(fp); ////////
-  while (!feof(fp)) {
-    switch (c) {
-      case 's':
-        displayRBT(tree, outfp);
-        break;
-      case 'r':
-        statisticsRBT(tree, outfp);
-        break;
-      case 'f':
-        skipWhiteSpace(fp);
-        test = fgetc(fp);
-        if(test == '"') { ungetc(test, fp); str = readString(fp); }
-        else { ungetc(test, fp); str = readToken(fp); }
-
-        str = cleanString(str, strlen(str));
+  runRBTCommands(tree, fp, outfp);
+  fclose(fp);
+}
 
-        if(str[0] == '\0' || (str[0] == ' ' && str[1] == '\0')) {;}
-        else { finalStr = newSTRING(str); freq = freqRBT(tree, finalStr);}
-        fprintf(outfp, "Frequency of \"%s\": %d\n", str, freq);
-		freeSTRING(finalStr); //EGT
-        break;
-      case 'd':
-        skipWhiteSpace(fp);
-        test = fgetc(fp);
-        if(test == '"') { ungetc(test, fp); str = readString(fp); }
-        else { ungetc(test, fp); str = readToken(fp); }
+// answers the commands read from fp, which may be a file or a client's stream
+static void runRBTCommands(RBT *tree, FILE *fp, FILE *outfp) {
+  STRING * lookups[LOOKUPS];
+  int lookupCount = 0;
+  COMMAND command;
+  int status;
+  while ((status = readCommand(fp, &command)) > 0) {
+    runRBTCommand(tree, &command, lookups, &lookupCount, outfp);
+  }
+  if (status < 0) {
+    // as the scanner would, the lookups still waiting go unanswered
+    exit(6);
+  }
+  flushRBTLookups(tree, lookups, &lookupCount, outfp);
+}
 
-        str = cleanString(str, strlen(str));
+/* reads the next command from fp, with its key cleaned or its count;
+ * returns 1, 0 at the end of fp, or -1 if a quoted key is never closed
+ */
+static int readCommand(FILE *fp, COMMAND *command) {
+  char *str;
+  int failed;
+  int c = fgetc(fp);
+  while (c != EOF && (c == 0 || strchr("srfdik", c) == 0)) {
+    c = fgetc(fp);
+  }
+  if (c == EOF) {
+    return 0;
+  }
+  command->op = c;
+  command->key = 0;
+  command->count = 0;
+  switch (c) {
+    case 'f':
+    case 'd':
+    case 'i':
+      str = scanKey(fp, &failed);
+      if (failed) { return -1; }
+      if (str == 0) { str = calloc(1, 1); }
+
+      command->key = cleanString(str, strlen(str));
+      break;
+    case 'k':
+      command->count = readCount(fp);
+      break;
+  }
+  return 1;
+}
 
-        if(str[0] == '\0' || (str[0] == ' ' && str[1] == '\0')) {free(str);}
-        else
+// carries out a command read by readCommand; the tree or the run takes its key
+static void runRBTCommand(RBT *tree, COMMAND *command, STRING **lookups,
+    int *lookupCount, FILE *outfp) {
+  STRING * finalStr;
+  TNODE ** top;
+  int found;
+  char *str = command->key;
+  if (*lookupCount && command->op != 'f') {
+    flushRBTLookups(tree, lookups, lookupCount, outfp);
+  }
+  switch (command->op) {
+    case 's':
+      displayRBT(tree, outfp);
+      break;
+    case 'r':
+      statisticsRBT(tree, outfp);
+      break;
+    case 'f':
+      // answered in order once the run of lookups ends
+      lookups[(*lookupCount)++] = newSTRING(str);
+      if (*lookupCount == LOOKUPS) {
+        flushRBTLookups(tree, lookups, lookupCount, outfp);
+      }
+      break;
+    case 'd':
+      if(str[0] == '\0' || (str[0] == ' ' && str[1] == '\0')) {free(str);}
+      else
+      {
+        finalStr = newSTRING(str);
+        if (freqRBT(tree, finalStr) == 0)
         {
-          finalStr = newSTRING(str);
-          if (freqRBT(tree, finalStr) == 0)
-          {
-            fprintf(outfp, "Value "); displaySTRING(finalStr, outfp); fprintf(outfp, " not found.\n");
-			freeSTRING(finalStr); //EGT
-          }
-          else{ deleteRBT(tree, finalStr); }
+          fprintf(outfp, "Value "); displaySTRING(finalStr, outfp); fprintf(outfp, " not found.\n");
+          freeSTRING(finalStr); //EGT
         }
-        break;
-      case 'i':
-        skipWhiteSpace(fp);
-        test = fgetc(fp);
-        if(test == '"') { ungetc(test, fp); str = readString(fp); }
-        else { ungetc(test, fp); str = readToken(fp); }
+        else{
+          record('d', str);
+          deleteRBT(tree, finalStr);
+          checkpoint(saveRBTTree, tree);
+        }
+      }
+      break;
+    case 'i':
+      if(str[0] == '\0' || (str[0] == ' ' && str[1] == '\0')) {free(str);}
+      else {
+        record('i', str);
+        finalStr = newSTRING(str);
+        insertRBT(tree, finalStr);
+        checkpoint(saveRBTTree, tree);
+      }
+      break;
+    case 'k':
+      top = malloc(sizeof(TNODE *) * (command->count + 1));
+      found = topKRBT(tree, command->count, top);
+      reportTop(top, found, unwrapRBT, outfp);
+      free(top);
+      break;
+  }
+}
 
-        str = cleanString(str, strlen(str));
+/* reads a key, in double quotes or up to the next space, with the
+ * scanner; returns 0 at the end of fp, and sets *failed if a quoted key is
+ * never closed, which the scanner has reported
+ */
+static char *scanKey(FILE *fp, int *failed) {
+  skipWhiteSpace(fp);
+  int test = fgetc(fp);
+  ungetc(test, fp);
+  char *key = test == '"' ? readStringChecked(fp) : readToken(fp);
+  *failed = test == '"' && key == 0;
+  return key;
+}
 
-        if(str[0] == '\0' || (str[0] == ' ' && str[1] == '\0')) {;}
-        else { finalStr = newSTRING(str); insertRBT(tree, finalStr); }
-        break;
-    }
-    c = fgetc(fp);
+// as scanKey, but a key never closed ends the run, as readString would
+static char *readKey(FILE *fp) {
+  int failed;
+  char *key = scanKey(fp, &failed);
+  if (failed) {
+    exit(6);
   }
-  fclose(fp);
+  return key;
 }
 
 void readGSTCommands(GST *tree, char *filename, FILE *outfp) {
   STRING * finalStr;
+  STRING * lookups[LOOKUPS];
+  int lookupCount = 0;
+  TNODE ** top;
+  int count, found;
   char *str;
-  int test;
-  int freq;
   FILE *fp = fopen(filename, "r");
   if (fp == 0) {
     printf("Error: %d (%s)\n", errno, strerror(errno));
@@ -197,6 +589,10 @@ void readGSTCommands(GST *tree, char *filename, FILE *outfp) {
   }
   int switchChar = fgetc(fp);
   while (!feof(fp)) {
+    if (lookupCount && (switchChar == 's' || switchChar == 'r'
+        || switchChar == 'd' || switchChar == 'i' || switchChar == 'k')) {
+      flushGSTLookups(tree, lookups, &lookupCount, outfp);
+    }
     switch (switchChar) {
       case 's':
         displayGST(tree, outfp);
@@ -205,23 +601,18 @@ void readGSTCommands(GST *tree, char *filename, FILE *outfp) {
         statisticsGST(tree, outfp);
         break;
       case 'f':
-        skipWhiteSpace(fp);
-        test = fgetc(fp);
-        if(test == '"') { ungetc(test, fp); str = readString(fp); }
-        else { ungetc(test, fp); str = readToken(fp); }
+        str = readKey(fp);
 
         str = cleanString(str, strlen(str));
 
-        if(str[0] == '\0' || (str[0] == ' ' && str[1] == '\0')) {;}
-        else { finalStr = newSTRING(str); freq = freqGST(tree, finalStr); }
-        fprintf(outfp, "Frequency of \"%s\": %d\n", str, freq);
-        freeSTRING(finalStr);
+        // answered in order once the run of lookups ends
+        lookups[lookupCount++] = newSTRING(str);
+        if (lookupCount == LOOKUPS) {
+          flushGSTLookups(tree, lookups, &lookupCount, outfp);
+        }
         break;
       case 'd':
-        skipWhiteSpace(fp);
-        test = fgetc(fp);
-        if(test == '"') { ungetc(test, fp); str = readString(fp); }
-        else { ungetc(test, fp); str = readToken(fp); }
+        str = readKey(fp);
 
         str = cleanString(str, strlen(str));
 
@@ -234,27 +625,235 @@ void readGSTCommands(GST *tree, char *filename, FILE *outfp) {
             fprintf(outfp, "Value "); displaySTRING(finalStr, outfp); fprintf(outfp, " not found.\n");
             freeSTRING(finalStr);
           }
-          else{ deleteGST(tree, finalStr); freeSTRING(finalStr);}
+          else{
+            thaw();
+            record('d', str);
+            deleteGST(tree, finalStr);
+            freeSTRING(finalStr);
+            checkpoint(saveGSTTree, tree);
+          }
 
         }
         break;
       case 'i':
-        skipWhiteSpace(fp);
-        test = fgetc(fp);
-        if(test == '"') { ungetc(test, fp); str = readString(fp); }
-        else { ungetc(test, fp); str = readToken(fp); }
+        str = readKey(fp);
 
         str = cleanString(str, strlen(str));
 
         if(str[0] == '\0' || (str[0] == ' ' && str[1] == '\0')) {;}
-        else { finalStr = newSTRING(str); insertGST(tree, finalStr); }
+        else {
+          thaw();
+          record('i', str);
+          finalStr = newSTRING(str);
+          insertGST(tree, finalStr);
+          checkpoint(saveGSTTree, tree);
+        }
+        break;
+      case 'k':
+        count = readCount(fp);
+        top = malloc(sizeof(TNODE *) * (count + 1));
+        found = topKGST(tree, count, top);
+        reportTop(top, found, unwrapGST, outfp);
+        free(top);
         break;
       }
     switchChar = fgetc(fp);
   }
+  flushGSTLookups(tree, lookups, &lookupCount, outfp);
   fclose(fp);
 }
 
+// answers a run of 'f' commands with one batched descent
+static void flushRBTLookups(RBT *tree, STRING **keys, int *count, FILE *outfp) {
+  int freqs[LOOKUPS];
+  freqManyRBT(tree, (void **)keys, *count, freqs);
+  for (int i = 0; i < *count; ++i) {
+    fprintf(outfp, "Frequency of \"%s\": %d\n", getSTRING(keys[i]), freqs[i]);
+    freeSTRING(keys[i]);
+  }
+  *count = 0;
+}
+
+static void flushGSTLookups(GST *tree, STRING **keys, int *count, FILE *outfp) {
+  int freqs[LOOKUPS];
+  if (frozen) {
+    for (int i = 0; i < *count; ++i) {
+      freqs[i] = freqFROZEN(frozen, hashSTRING(keys[i]));
+    }
+  }
+  else {
+    freqManyGST(tree, (void **)keys, *count, freqs);
+  }
+  for (int i = 0; i < *count; ++i) {
+    fprintf(outfp, "Frequency of \"%s\": %d\n", getSTRING(keys[i]), freqs[i]);
+    freeSTRING(keys[i]);
+  }
+  *count = 0;
+}
+
+// reads the count after a 'k' command; a missing or bad count means 1
+static int readCount(FILE *fp) {
+  skipWhiteSpace(fp);
+  char * str = readToken(fp);
+  int count = str ? atoi(str) : 1;
+  free(str);
+  return count > 0 ? count : 1;
+}
+
+// answers a 'k' command, most frequent first
+static void reportTop(TNODE **top, int found, void *(*unwrap)(TNODE *),
+    FILE *outfp) {
+  for (int i = 0; i < found; ++i) {
+    fprintf(outfp, "Top %d: \"%s\" %d\n", i + 1,
+        getSTRING(unwrap(top[i])), nodeFreqGST(top[i]));
+  }
+}
+
+// logs a change about to be made
+static void record(int op, char *str) {
+  if (journal) {
+    logWAL(journal, op, str, strlen(str));
+  }
+}
+
+// checkpoints tree once the log is long; called after a logged change is
+// made, so the snapshot holds every change the new log leaves out
+static void checkpoint(int (*save)(char *, void *), void *tree) {
+  if (journal && recordsWAL(journal) >= CHECKPOINT) {
+    checkpointWAL(journal, save, tree);
+  }
+}
+
+static int saveRBTTree(char *path, void *tree) {
+  return saveRBT(tree, path, writeSTRING);
+}
+
+static int saveGSTTree(char *path, void *tree) {
+  return saveGST(tree, path, writeSTRING);
+}
+
+// redoes a logged change, as the 'i' and 'd' commands made it
+static void applyRBT(int op, char *key, int length, void *tree) {
+  STRING * s = newSTRING(strcpy(malloc(length + 1), key));
+  if (op == 'i') {
+    insertRBT(tree, s);
+    return;
+  }
+  // the tree gives up, and does not free, the last instance of a key
+  STRING * held = findRBT(tree, s);
+  if (held && deleteRBT(tree, s) == 0) {
+    freeSTRING(held);
+  }
+  freeSTRING(s);
+}
+
+static void applyGST(int op, char *key, int length, void *tree) {
+  STRING * s = newSTRING(strcpy(malloc(length + 1), key));
+  if (op == 'i') {
+    insertGST(tree, s);
+    return;
+  }
+  STRING * held = findGST(tree, s);
+  if (held && deleteGST(tree, s) == 0) {
+    freeSTRING(held);
+  }
+  freeSTRING(s);
+}
+
+// answers one client's commands, for RBTServer
+static void serveRBT(FILE *in, FILE *out, void *tree) {
+  runRBTCommands(tree, in, out);
+}
+
+// the parsing stage under -p; a null op marks a key never closed
+static void *parseCommand(void *arg) {
+  STREAM * stream = arg;
+  COMMAND * command = malloc(sizeof(COMMAND));
+  int status = readCommand(stream->fp, command);
+  if (status == 0) {
+    free(command);
+    return 0;
+  }
+  if (status < 0) {
+    command->op = 0;
+  }
+  return command;
+}
+
+/* the executing stage under -p; lookups wait for a batch only while more
+ * commands are ready, and a stream that fails to parse is answered up to
+ * the failure
+ */
+static void executeCommand(void *item, FILE *out, void *arg) {
+  STREAM * stream = arg;
+  COMMAND * command = item;
+  if (command == 0) {
+    flushRBTLookups(stream->tree, stream->lookups, &stream->lookupCount, out);
+    return;
+  }
+  if (command->op == 0) {
+    stream->failed = 1;
+  }
+  else if (!stream->failed) {
+    runRBTCommand(stream->tree, command, stream->lookups,
+        &stream->lookupCount, out);
+  }
+  free(command);
+}
+
+/* answers the commands in a binary command file; a lookup's key is used
+ * where it lies in the file, and other commands are given a copy to keep
+ */
+static void runBinaryRBT(RBT *tree, BINARY *b, FILE *outfp) {
+  STRING * lookups[LOOKUPS];
+  int lookupCount = 0;
+  COMMAND command;
+  char *key;
+  int status;
+  while ((status = nextBINARY(b, &command.op, &key, &command.count)) > 0) {
+    if (command.op == 'f') {
+      lookups[lookupCount++] = newSTRING(key);
+      if (lookupCount == LOOKUPS) {
+        flushKeptLookups(tree, lookups, &lookupCount, outfp);
+      }
+      continue;
+    }
+    flushKeptLookups(tree, lookups, &lookupCount, outfp);
+    command.key = key ? strcpy(malloc(command.count + 1), key) : 0;
+    runRBTCommand(tree, &command, lookups, &lookupCount, outfp);
+  }
+  flushKeptLookups(tree, lookups, &lookupCount, outfp);
+  if (status < 0) {
+    fprintf(outfp, "Error: the command file is cut short.\n");
+  }
+}
+
+// as flushRBTLookups, for keys that stay in a mapped file
+static void flushKeptLookups(RBT *tree, STRING **keys, int *count,
+    FILE *outfp) {
+  int freqs[LOOKUPS];
+  freqManyRBT(tree, (void **)keys, *count, freqs);
+  for (int i = 0; i < *count; ++i) {
+    fprintf(outfp, "Frequency of \"%s\": %d\n", getSTRING(keys[i]), freqs[i]);
+    setSTRING(keys[i], 0);
+    freeSTRING(keys[i]);
+  }
+  *count = 0;
+}
+
+// the text of a STRING, for publishing
+static char *textSTRING(void *v) {
+  return getSTRING(v);
+}
+
+// drops the frozen table once the tree changes under it
+static void thaw(void) {
+  if (frozen) {
+    freeFROZEN(frozen);
+    frozen = 0;
+  }
+}
+
 char * cleanString(char *str, int s)
 {
   char* newStr = malloc(sizeof(char) * (s+1));
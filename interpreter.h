@@ -7,6 +7,18 @@
 
 extern void RBTInterpreter(RBT *tree, char **argv, FILE *outfp);
 extern void GSTInterpreter(GST *tree, char **argv, FILE *outfp);
+extern void FrozenInterpreter(GST *tree, char **argv, FILE *outfp);
+extern void RBTSnapshot(RBT *tree, char **argv, FILE *outfp);
+extern void GSTSnapshot(GST *tree, char **argv, FILE *outfp);
+extern void RBTPublish(RBT *tree, char **argv, FILE *outfp);
+extern void MappedInterpreter(char **argv, FILE *outfp);
+extern void RBTJournal(RBT *tree, char **argv, FILE *outfp);
+extern void GSTJournal(GST *tree, char **argv, FILE *outfp);
+extern void RBTServer(RBT *tree, char **argv, FILE *outfp);
+extern void ClientInterpreter(char **argv, FILE *outfp);
+extern void RBTStream(RBT *tree, char **argv, FILE *outfp);
+extern void CompileCommands(char **argv, FILE *outfp);
+extern void RBTBinary(RBT *tree, char **argv, FILE *outfp);
 extern RBT *readRBTCorpus(RBT *tree, char *filename);
 extern void readRBTCommands(RBT *tree, char *filename, FILE *outfp);
 extern GST *readGSTCorpus(GST *tree, char * filename);
@@ -0,0 +1,206 @@
+/*File: mapped.c
+ *Implements functions found in mapped.h: a read-only search tree of string
+ *keys and their frequencies that lives in a file and is used in place
+ *through a shared memory map
+*/
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mapped.h"
+
+// the first bytes of a mapped tree, the last being the format's version
+#define MAGIC "MAPPED\001"
+
+/* the file is a header, the nodes and then the keys, each ended by a zero
+* byte; a node holds offsets from the start of the file, never pointers,
+* so any process can map the file anywhere and walk it as is; the tree is
+* perfectly balanced and laid out in preorder, so a node's left child sits
+* right after it; files are written whole to a temporary name and renamed
+* over the old version, so readers see one version or the next, never a
+* mix, and keep the version they mapped until they refresh
+*/
+typedef struct head {
+  char magic[8];
+  uint32_t count;
+  uint32_t root; // the offset of the root node, or 0 if there are no keys
+  uint64_t bytes; // the length of the whole file
+} HEAD;
+
+typedef struct node {
+  uint32_t key; // the offset of the key's first byte
+  int32_t freq;
+  uint32_t left; // the offset of the left child, or 0 if there is none
+  uint32_t right;
+} NODE;
+
+struct mapped {
+  char *path;
+  const char *base;
+  size_t bytes;
+  dev_t device; // the file mapped, to see when a new version replaces it
+  ino_t inode;
+};
+
+static uint32_t layout(NODE *nodes, uint32_t *next, uint32_t *keys,
+    int *freqs, int lo, int hi);
+static int map(MAPPED *m);
+
+/* writes the n keys, which must be distinct and in strcmp order, with
+* their frequencies, to a new version of the file at path; returns 0, or
+* -1 if the keys are out of order or the file cannot be written
+*/
+extern int writeMAPPED(char *path, char **keys, int *freqs, int n) {
+  uint64_t bytes = sizeof(HEAD) + (uint64_t)sizeof(NODE) * n;
+  for (int i = 0; i < n; ++i) {
+    if (i > 0 && strcmp(keys[i - 1], keys[i]) >= 0) { return -1; }
+    bytes += strlen(keys[i]) + 1;
+  }
+  if (bytes > UINT32_MAX) { return -1; }
+  HEAD head;
+  memset(&head, 0, sizeof(HEAD));
+  memcpy(head.magic, MAGIC, 8);
+  head.count = (uint32_t)n;
+  head.bytes = bytes;
+  NODE *nodes = malloc(sizeof(NODE) * (n + 1));
+  uint32_t *offsets = malloc(sizeof(uint32_t) * (n + 1));
+  assert(nodes != NULL && offsets != NULL);
+  uint32_t at = sizeof(HEAD) + (uint32_t)sizeof(NODE) * n;
+  for (int i = 0; i < n; ++i) {
+    offsets[i] = at;
+    at += (uint32_t)strlen(keys[i]) + 1;
+  }
+  uint32_t next = 0;
+  head.root = layout(nodes, &next, offsets, freqs, 0, n);
+
+  char *temporary = malloc(strlen(path) + 8);
+  assert(temporary != NULL);
+  sprintf(temporary, "%s.XXXXXX", path);
+  int fd = mkstemp(temporary);
+  if (fd >= 0) { fchmod(fd, 0644); } // readers may run as other users
+  FILE *fp = fd < 0 ? 0 : fdopen(fd, "wb");
+  int ok = fp != 0;
+  if (ok) {
+    fwrite(&head, sizeof(HEAD), 1, fp);
+    fwrite(nodes, sizeof(NODE), n, fp);
+    for (int i = 0; i < n; ++i) { fwrite(keys[i], 1, strlen(keys[i]) + 1, fp); }
+    ok = fflush(fp) == 0 && ferror(fp) == 0 && fsync(fd) == 0;
+    ok = fclose(fp) == 0 && ok;
+  }
+  if (ok) { ok = rename(temporary, path) == 0; }
+  if (!ok && fd >= 0) { remove(temporary); }
+  free(temporary);
+  free(nodes);
+  free(offsets);
+  return ok ? 0 : -1;
+}
+
+// maps the file at path; returns 0 if it is missing or not a mapped tree
+extern MAPPED *openMAPPED(char *path) {
+  MAPPED *m = malloc(sizeof(MAPPED));
+  assert(m != NULL);
+  m->path = malloc(strlen(path) + 1);
+  assert(m->path != NULL);
+  strcpy(m->path, path);
+  m->base = 0;
+  if (map(m) != 0) {
+    free(m->path);
+    free(m);
+    return 0;
+  }
+  return m;
+}
+
+extern int freqMAPPED(MAPPED *m, char *key) {
+  const char *base = m->base;
+  uint32_t at = ((const HEAD *)base)->root;
+  while (at) {
+    const NODE *n = (const NODE *)(base + at);
+    int c = strcmp(key, base + n->key);
+    if (c == 0) { return n->freq; }
+    at = c < 0 ? n->left : n->right;
+  }
+  return 0;
+}
+
+extern int sizeMAPPED(MAPPED *m) {
+  return (int)((const HEAD *)m->base)->count;
+}
+
+extern long bytesMAPPED(MAPPED *m) {
+  return (long)m->bytes;
+}
+
+/* maps the newest version of the file, if one has been published since
+* the last map; returns 1 if it did, else 0
+*/
+extern int refreshMAPPED(MAPPED *m) {
+  struct stat s;
+  if (stat(m->path, &s) != 0
+      || (s.st_dev == m->device && s.st_ino == m->inode)) {
+    return 0;
+  }
+  const char *old = m->base;
+  size_t bytes = m->bytes;
+  dev_t device = m->device;
+  ino_t inode = m->inode;
+  if (map(m) != 0) {
+    m->base = old;
+    m->bytes = bytes;
+    m->device = device;
+    m->inode = inode;
+    return 0;
+  }
+  munmap((void *)old, bytes);
+  return 1;
+}
+
+extern void closeMAPPED(MAPPED *m) {
+  munmap((void *)m->base, m->bytes);
+  free(m->path);
+  free(m);
+}
+
+// lays out keys lo to hi - 1 in preorder, returning the subtree's offset
+static uint32_t layout(NODE *nodes, uint32_t *next, uint32_t *keys,
+    int *freqs, int lo, int hi) {
+  if (lo >= hi) { return 0; }
+  int mid = lo + (hi - lo) / 2;
+  uint32_t slot = (*next)++;
+  nodes[slot].key = keys[mid];
+  nodes[slot].freq = freqs[mid];
+  nodes[slot].left = layout(nodes, next, keys, freqs, lo, mid);
+  nodes[slot].right = layout(nodes, next, keys, freqs, mid + 1, hi);
+  return sizeof(HEAD) + slot * (uint32_t)sizeof(NODE);
+}
+
+// maps m->path afresh; returns -1, leaving m alone, if it cannot
+static int map(MAPPED *m) {
+  int fd = open(m->path, O_RDONLY);
+  struct stat s;
+  if (fd < 0) { return -1; }
+  if (fstat(fd, &s) != 0 || (size_t)s.st_size < sizeof(HEAD)) {
+    close(fd);
+    return -1;
+  }
+  void *base = mmap(0, (size_t)s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) { return -1; }
+  const HEAD *head = base;
+  if (memcmp(head->magic, MAGIC, 8) != 0
+      || head->bytes != (uint64_t)s.st_size) {
+    munmap(base, (size_t)s.st_size);
+    return -1;
+  }
+  m->base = base;
+  m->bytes = (size_t)s.st_size;
+  m->device = s.st_dev;
+  m->inode = s.st_ino;
+  return 0;
+}
@@ -0,0 +1,14 @@
+#ifndef __MAPPED_INCLUDED__
+#define __MAPPED_INCLUDED__
+
+typedef struct mapped MAPPED;
+
+extern int     writeMAPPED(char *path,char **keys,int *freqs,int n);
+extern MAPPED *openMAPPED(char *path);
+extern int     freqMAPPED(MAPPED *m,char *key);
+extern int     sizeMAPPED(MAPPED *m);
+extern long    bytesMAPPED(MAPPED *m);
+extern int     refreshMAPPED(MAPPED *m);
+extern void    closeMAPPED(MAPPED *m);
+
+#endif
@@ -0,0 +1,124 @@
+/*File: pipeline.c
+ *Implements functions found in pipeline.h: a stream of commands run in
+ *three stages, parsing, executing and writing, each on its own thread,
+ *so the stream moves at the pace of the slowest stage rather than the
+ *sum of all three
+*/
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "ring.h"
+#include "pipeline.h"
+
+// output is handed to the writer once this many bytes have gathered
+#define CHUNK 65536
+
+/* the parser hands each item to the executor through one ring, and the
+* executor hands its output, a chunk at a time, to the writer through
+* another; a chunk also goes whenever the executor runs out of input, so
+* a slow stream is answered as it comes; the end of the stream is marked
+* in each ring by the address of end
+*/
+typedef struct output {
+  char *text;
+  size_t size;
+} OUTPUT;
+
+typedef struct stages {
+  void *(*parse)(void *);
+  void *arg;
+  FILE *outfp;
+  RING *items;
+  RING *outputs;
+} STAGES;
+
+static char end;
+
+static void *parser(void *arg);
+static void *writer(void *arg);
+static FILE *start(OUTPUT *o);
+static void hand(STAGES *s, OUTPUT *o, FILE **out);
+
+/* calls parse for items until it returns 0, and execute for each item in
+* order on the calling thread, with out gathering what it prints for
+* outfp; execute is also called with a null item whenever no item is
+* waiting, and once more at the end, to finish any work it has held back;
+* depth is the most items parsed ahead of execution
+*/
+extern void runPIPELINE(void *(*parse)(void *arg),
+    void (*execute)(void *item, FILE *out, void *arg), void *arg,
+    FILE *outfp, int depth) {
+  STAGES s = { parse, arg, outfp, newRING(depth), newRING(depth) };
+  pthread_t parsing, writing;
+  OUTPUT o;
+  FILE *out = start(&o);
+  pthread_create(&parsing, 0, parser, &s);
+  pthread_create(&writing, 0, writer, &s);
+  for (;;) {
+    if (readyRING(s.items) == 0) {
+      execute(0, out, arg);
+      hand(&s, &o, &out);
+    }
+    void *item = getRING(s.items);
+    if (item == &end) {
+      break;
+    }
+    execute(item, out, arg);
+    if (ftell(out) >= CHUNK) {
+      hand(&s, &o, &out);
+    }
+  }
+  execute(0, out, arg);
+  hand(&s, &o, &out);
+  fclose(out);
+  free(o.text);
+  putRING(s.outputs, &end);
+  pthread_join(parsing, 0);
+  pthread_join(writing, 0);
+  freeRING(s.items);
+  freeRING(s.outputs);
+}
+
+static void *parser(void *arg) {
+  STAGES *s = arg;
+  void *item;
+  while ((item = s->parse(s->arg)) != 0) {
+    putRING(s->items, item);
+  }
+  putRING(s->items, &end);
+  return 0;
+}
+
+static void *writer(void *arg) {
+  STAGES *s = arg;
+  OUTPUT *o;
+  while ((o = getRING(s->outputs)) != (OUTPUT *) &end) {
+    fwrite(o->text, 1, o->size, s->outfp);
+    fflush(s->outfp);
+    free(o->text);
+    free(o);
+  }
+  return 0;
+}
+
+static FILE *start(OUTPUT *o) {
+  o->text = 0;
+  o->size = 0;
+  FILE *out = open_memstream(&o->text, &o->size);
+  assert(out != NULL);
+  return out;
+}
+
+// passes what out has gathered, if anything, to the writer
+static void hand(STAGES *s, OUTPUT *o, FILE **out) {
+  if (ftell(*out) == 0) {
+    return;
+  }
+  fclose(*out);
+  OUTPUT *full = malloc(sizeof(OUTPUT));
+  *full = *o;
+  putRING(s->outputs, full);
+  *out = start(o);
+}
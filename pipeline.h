@@ -0,0 +1,10 @@
+#ifndef __PIPELINE_INCLUDED__
+#define __PIPELINE_INCLUDED__
+
+#include <stdio.h>
+
+extern void runPIPELINE(void *(*parse)(void *arg),
+              void (*execute)(void *item,FILE *out,void *arg),void *arg,
+              FILE *outfp,int depth);
+
+#endif
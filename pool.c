@@ -0,0 +1,249 @@
+/*File: pool.c
+ *Implements functions found in pool.h: a fork-join thread pool in which
+ *every worker owns a deque of tasks and idle workers steal from the others
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include "pool.h"
+
+/* a worker pushes and pops the tasks it spawns at the bottom of its own
+* deque, newest first, and thieves take from the top, oldest first; in
+* divide-and-conquer code the oldest task is the biggest piece of work, so a
+* steal moves as much work as possible for one lock
+*/
+typedef struct deque {
+  TASK **items;
+  int capacity;
+  int top;
+  int bottom;
+  pthread_mutex_t lock;
+} DEQUE;
+
+struct task {
+  void (*f)(void *arg);
+  void *arg;
+  int done;
+};
+
+struct pool {
+  int threads;
+  DEQUE *deques;
+  pthread_t *workers;
+  pthread_key_t self; // index of the calling worker, plus one
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  int running; // 1 while a runPOOL call is in progress
+  int quit;
+};
+
+typedef struct start {
+  POOL *pool;
+  int index;
+} START;
+
+static void *work(void *arg);
+static int whoAmI(POOL *p);
+static void push(DEQUE *d, TASK *t);
+static TASK *popBottom(DEQUE *d);
+static TASK *stealTop(DEQUE *d);
+static TASK *findTask(POOL *p, int me);
+static void execute(TASK *t);
+
+// returns a pool of threads workers, counting the thread that calls runPOOL
+extern POOL *newPOOL(int threads) {
+  POOL *p = malloc(sizeof(POOL));
+  assert(p != NULL);
+  if (threads < 1) { threads = 1; }
+  p->threads = threads;
+  p->deques = malloc(sizeof(DEQUE) * threads);
+  assert(p->deques != NULL);
+  for (int i = 0; i < threads; ++i) {
+    p->deques[i].capacity = 64;
+    p->deques[i].items = malloc(sizeof(TASK *) * 64);
+    assert(p->deques[i].items != NULL);
+    p->deques[i].top = 0;
+    p->deques[i].bottom = 0;
+    pthread_mutex_init(&p->deques[i].lock, 0);
+  }
+  pthread_key_create(&p->self, 0);
+  pthread_mutex_init(&p->lock, 0);
+  pthread_cond_init(&p->wake, 0);
+  p->running = 0;
+  p->quit = 0;
+  p->workers = malloc(sizeof(pthread_t) * threads);
+  assert(p->workers != NULL);
+  for (int i = 1; i < threads; ++i) {
+    START *s = malloc(sizeof(START));
+    assert(s != NULL);
+    s->pool = p;
+    s->index = i;
+    pthread_create(&p->workers[i], 0, work, s);
+  }
+  return p;
+}
+// returns the number of workers
+extern int threadsPOOL(POOL *p) {
+  return p->threads;
+}
+/* runs f(arg) on the calling thread as worker 0, with the other workers
+* stealing whatever it spawns, and returns once f does; f must sync every
+* task it spawns, and only one runPOOL may be in progress at a time
+*/
+extern void runPOOL(POOL *p, void (*f)(void *), void *arg) {
+  void *saved = pthread_getspecific(p->self);
+  pthread_setspecific(p->self, (void *)1);
+  pthread_mutex_lock(&p->lock);
+  p->running = 1;
+  pthread_cond_broadcast(&p->wake);
+  pthread_mutex_unlock(&p->lock);
+  f(arg);
+  pthread_mutex_lock(&p->lock);
+  p->running = 0;
+  pthread_mutex_unlock(&p->lock);
+  pthread_setspecific(p->self, saved);
+}
+/* queues f(arg) on the calling worker's deque and returns a handle for
+* syncPOOL; called outside runPOOL, it runs f at once
+*/
+extern TASK *spawnPOOL(POOL *p, void (*f)(void *), void *arg) {
+  TASK *t = malloc(sizeof(TASK));
+  assert(t != NULL);
+  t->f = f;
+  t->arg = arg;
+  t->done = 0;
+  int me = whoAmI(p);
+  if (me < 0) {
+    execute(t);
+  }
+  else {
+    push(&p->deques[me], t);
+  }
+  return t;
+}
+/* waits for a spawned task to finish and frees its handle; rather than
+* block, the waiting worker runs its own queued tasks or steals others
+*/
+extern void syncPOOL(POOL *p, TASK *t) {
+  int me = whoAmI(p);
+  while (!__atomic_load_n(&t->done, __ATOMIC_ACQUIRE)) {
+    TASK *other = me < 0 ? 0 : findTask(p, me);
+    if (other) {
+      execute(other);
+    }
+    else {
+      sched_yield();
+    }
+  }
+  free(t);
+}
+// stops and joins the workers, then frees the pool
+extern void freePOOL(POOL *p) {
+  pthread_mutex_lock(&p->lock);
+  p->quit = 1;
+  pthread_cond_broadcast(&p->wake);
+  pthread_mutex_unlock(&p->lock);
+  for (int i = 1; i < p->threads; ++i) {
+    pthread_join(p->workers[i], 0);
+  }
+  for (int i = 0; i < p->threads; ++i) {
+    free(p->deques[i].items);
+    pthread_mutex_destroy(&p->deques[i].lock);
+  }
+  pthread_key_delete(p->self);
+  pthread_mutex_destroy(&p->lock);
+  pthread_cond_destroy(&p->wake);
+  free(p->workers);
+  free(p->deques);
+  free(p);
+}
+
+// a worker sleeps between runs and hunts for tasks during one
+static void *work(void *arg) {
+  START *s = arg;
+  POOL *p = s->pool;
+  int me = s->index;
+  free(s);
+  pthread_setspecific(p->self, (void *)(long)(me + 1));
+  pthread_mutex_lock(&p->lock);
+  while (!p->quit) {
+    if (!p->running) {
+      pthread_cond_wait(&p->wake, &p->lock);
+      continue;
+    }
+    pthread_mutex_unlock(&p->lock);
+    TASK *t = findTask(p, me);
+    if (t) {
+      execute(t);
+    }
+    else {
+      sched_yield();
+    }
+    pthread_mutex_lock(&p->lock);
+  }
+  pthread_mutex_unlock(&p->lock);
+  return 0;
+}
+
+// returns the calling thread's worker index, or -1 outside the pool
+static int whoAmI(POOL *p) {
+  return (int)(long)pthread_getspecific(p->self) - 1;
+}
+
+static void push(DEQUE *d, TASK *t) {
+  pthread_mutex_lock(&d->lock);
+  if (d->bottom == d->capacity) {
+    int live = d->bottom - d->top;
+    if (live * 2 > d->capacity) {
+      d->capacity *= 2;
+      d->items = realloc(d->items, sizeof(TASK *) * d->capacity);
+      assert(d->items != NULL);
+    }
+    for (int i = 0; i < live; ++i) {
+      d->items[i] = d->items[d->top + i];
+    }
+    d->top = 0;
+    d->bottom = live;
+  }
+  d->items[d->bottom++] = t;
+  pthread_mutex_unlock(&d->lock);
+}
+
+static TASK *popBottom(DEQUE *d) {
+  TASK *t = 0;
+  pthread_mutex_lock(&d->lock);
+  if (d->bottom > d->top) {
+    t = d->items[--d->bottom];
+  }
+  if (d->bottom == d->top) {
+    d->top = d->bottom = 0;
+  }
+  pthread_mutex_unlock(&d->lock);
+  return t;
+}
+
+static TASK *stealTop(DEQUE *d) {
+  TASK *t = 0;
+  pthread_mutex_lock(&d->lock);
+  if (d->bottom > d->top) {
+    t = d->items[d->top++];
+  }
+  pthread_mutex_unlock(&d->lock);
+  return t;
+}
+
+// takes the newest task of worker me, or else the oldest of another worker
+static TASK *findTask(POOL *p, int me) {
+  TASK *t = popBottom(&p->deques[me]);
+  for (int i = 1; t == 0 && i < p->threads; ++i) {
+    t = stealTop(&p->deques[(me + i) % p->threads]);
+  }
+  return t;
+}
+
+static void execute(TASK *t) {
+  t->f(t->arg);
+  __atomic_store_n(&t->done, 1, __ATOMIC_RELEASE);
+}
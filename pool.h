@@ -0,0 +1,14 @@
+#ifndef __POOL_INCLUDED__
+#define __POOL_INCLUDED__
+
+typedef struct pool POOL;
+typedef struct task TASK;
+
+extern POOL *newPOOL(int threads);
+extern int   threadsPOOL(POOL *p);
+extern void  runPOOL(POOL *p,void (*f)(void *),void *arg);
+extern TASK *spawnPOOL(POOL *p,void (*f)(void *),void *arg);
+extern void  syncPOOL(POOL *p,TASK *t);
+extern void  freePOOL(POOL *p);
+
+#endif
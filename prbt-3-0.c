@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "prbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* versions of a persistent RBT, made by a random mix of inserts and
+ * deletes, are kept and checked against counts taken as they were made,
+ * while a reader thread scans an old version as the writer goes on */
+
+#define KEYS 1000
+#define CHANGES 20000
+#define EVERY 2000
+
+static int live;
+
+static INTEGER *
+newKey(int i)
+    {
+    ++live;
+    return newINTEGER(i);
+    }
+
+static void
+freeKey(void *v)
+    {
+    --live;
+    freeINTEGER(v);
+    }
+
+// counts visited values that are out of order or wrongly counted
+typedef struct check
+    {
+    int *counts;
+    int last;
+    int bad;
+    long sum;
+    } CHECK;
+
+static void
+visit(void *v,int freq,void *arg)
+    {
+    CHECK *c = arg;
+    int k = getINTEGER(v);
+    if (k <= c->last || (c->counts && c->counts[k] != freq)) ++c->bad;
+    c->last = k;
+    c->sum += (long)k * freq;
+    }
+
+static int
+mismatches(PRBT *t,int *counts)
+    {
+    CHECK c = { counts, -1, 0, 0 };
+    walkPRBT(t,visit,&c);
+    int i, distinct = 0;
+    for (i = 0; i < KEYS; ++i) if (counts[i]) ++distinct;
+    if (distinct != sizePRBT(t)) ++c.bad;
+    return c.bad;
+    }
+
+static long
+total(PRBT *t)
+    {
+    CHECK c = { 0, -1, 0, 0 };
+    walkPRBT(t,visit,&c);
+    return c.sum;
+    }
+
+// reads one version over and over while the writer makes others
+static void *
+reader(void *arg)
+    {
+    PRBT *t = arg;
+    long first = total(t);
+    int i, changed = 0;
+    for (i = 0; i < 200; ++i)
+        if (total(t) != first) ++changed;
+    freePRBT(t);
+    return (void *)(long)changed;
+    }
+
+int
+main(void)
+    {
+    srandom(47);
+    printf("INTEGER test of PRBT, persistent versions\n");
+    int i, j, counts[KEYS] = { 0 };
+    int *kept[CHANGES / EVERY];
+    PRBT *versions[CHANGES / EVERY];
+    PRBT *t = newPRBT(compareINTEGER), *empty = t;
+    setPRBTdisplay(t,displayINTEGER);
+    setPRBTfree(t,freeKey);
+    for (i = 0; i < CHANGES; ++i)
+        {
+        PRBT *next;
+        int k = random() % KEYS;
+        if (random() % 3)
+            {
+            next = insertPRBT(t,newKey(k));
+            ++counts[k];
+            }
+        else
+            {
+            INTEGER *key = newINTEGER(k);
+            next = deletePRBT(t,key);
+            if (counts[k]) --counts[k];
+            freeINTEGER(key);
+            }
+        if (i % EVERY == EVERY - 1)
+            {
+            versions[i / EVERY] = next;
+            kept[i / EVERY] = malloc(sizeof(counts));
+            for (j = 0; j < KEYS; ++j) kept[i / EVERY][j] = counts[j];
+            }
+        if (i % EVERY != 0) freePRBT(t); // else t is the last version kept
+        t = next;
+        }
+    int bad = 0;
+    for (i = 0; i < CHANGES / EVERY; ++i)
+        {
+        bad += mismatches(versions[i],kept[i]);
+        free(kept[i]);
+        }
+    printf("kept versions: %d, mismatches %d\n",CHANGES / EVERY,bad);
+    statisticsPRBT(t,stdout);
+
+    t = keepPRBT(t); // the last version kept is also the writer's
+    pthread_t thread;
+    pthread_create(&thread,0,reader,keepPRBT(versions[0]));
+    for (i = 0; i < CHANGES; ++i)
+        {
+        INTEGER *key = newINTEGER(random() % KEYS);
+        PRBT *next = random() % 2 ? insertPRBT(t,newKey(getINTEGER(key)))
+            : deletePRBT(t,key);
+        freeINTEGER(key);
+        freePRBT(t);
+        t = next;
+        }
+    void *changed;
+    pthread_join(thread,&changed);
+    printf("scans of an old version that changed under writers: %ld\n",
+        (long)changed);
+
+    for (i = 0; i < CHANGES / EVERY; ++i) freePRBT(versions[i]);
+    freePRBT(empty);
+    printf("after freeing the old versions:\n");
+    statisticsPRBT(t,stdout);
+    freePRBT(t);
+    printf("values not freed: %d\n",live);
+
+    t = newPRBT(compareINTEGER);
+    setPRBTdisplay(t,displayINTEGER);
+    setPRBTfree(t,freeKey);
+    PRBT *small[8];
+    int order[8] = { 5, 3, 8, 1, 4, 3, 9, 7 };
+    for (i = 0; i < 8; ++i)
+        {
+        small[i] = insertPRBT(i ? small[i - 1] : t,newKey(order[i]));
+        }
+    freePRBT(t);
+    INTEGER *three = newINTEGER(3), *five = newINTEGER(5);
+    PRBT *a = deletePRBT(small[7],three), *b = deletePRBT(a,five);
+    freeINTEGER(three);
+    freeINTEGER(five);
+    printf("after 4 inserts:\n");
+    displayPRBT(small[3],stdout);
+    printf("after 8 inserts:\n");
+    displayPRBT(small[7],stdout);
+    printf("after 8 inserts, less a 3 and the 5:\n");
+    displayPRBT(b,stdout);
+    for (i = 0; i < 8; ++i) freePRBT(small[i]);
+    freePRBT(a);
+    freePRBT(b);
+    printf("values not freed: %d\n",live);
+    return 0;
+    }
@@ -0,0 +1,618 @@
+/*File: prbt.c
+ *Implements functions found in prbt.h: a persistent red black tree, in
+ *which a change makes a new version of the tree and leaves every older
+ *version as it was, readable for as long as it is kept
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "prbt.h"
+
+/* the tree is left-leaning, so each 3-node leans left and the fix-ups are
+* the few cases of a recursive insert and delete; nodes have no parent
+* links and, once a change is done, are never written again, so versions
+* share every subtree a change did not touch; a change copies the nodes on
+* its path, and the siblings whose colors it flips, O(log n) in all, and
+* works on the copies in place; a node counts the nodes and versions that
+* point at it and is reclaimed, with its value once no copy holds that,
+* when the last goes; versions made from one newPRBT share a lock, taken
+* only to count and reclaim, so a scan of one version never waits on
+* writers making others
+*/
+typedef struct held {
+  void *value;
+  int refs; // the nodes holding value
+} HELD;
+
+typedef struct pnode {
+  HELD *held;
+  int freq;
+  int red;
+  int refs; // the nodes and versions pointing here
+  unsigned long stamp; // the change that made the node, until it is done
+  struct pnode *left;
+  struct pnode *right;
+} PNODE;
+
+typedef struct family {
+  int (*compare)(void *one, void *two);
+  void (*display)(void *ptr, FILE *fp);
+  void (*freeMethod)(void *ptr);
+  pthread_mutex_t lock;
+  unsigned long stamps;
+  int versions;
+  long nodes; // the nodes of every version, each counted once
+} FAMILY;
+
+struct prbt {
+  FAMILY *family;
+  PNODE *root;
+  int size;
+  int duplicates;
+  int refs; // the holders of this version, see keepPRBT
+};
+
+// a change in progress and the nodes it has made so far
+typedef struct edit {
+  FAMILY *family;
+  unsigned long stamp;
+  PNODE **made;
+  int count;
+  int capacity;
+} EDIT;
+
+static PRBT *newVersion(PRBT *t, PNODE *root);
+static void begin(EDIT *e, FAMILY *f);
+static void finish(EDIT *e, PNODE *root);
+static PNODE *copy(EDIT *e, PNODE *n);
+static PNODE *insert(EDIT *e, PNODE *h, void *value, int *duplicate);
+static PNODE *decrement(EDIT *e, PNODE *h, void *key);
+static PNODE *delete(EDIT *e, PNODE *h, void *key);
+static PNODE *deleteMin(EDIT *e, PNODE *h);
+static PNODE *rotateLeft(EDIT *e, PNODE *h);
+static PNODE *rotateRight(EDIT *e, PNODE *h);
+static void flip(EDIT *e, PNODE *h);
+static PNODE *moveRedLeft(EDIT *e, PNODE *h);
+static PNODE *moveRedRight(EDIT *e, PNODE *h);
+static PNODE *balance(EDIT *e, PNODE *h);
+static PNODE *locate(PRBT *t, void *key);
+static void release(FAMILY *f, PNODE *n);
+static void walk(PNODE *n, void (*visit)(void *, int, void *), void *arg);
+static int minDepth(PNODE *n);
+static int maxDepth(PNODE *n);
+static void displayNode(FAMILY *f, PNODE *n, PNODE *parent, FILE *fp);
+static void displayValue(FAMILY *f, PNODE *n, FILE *fp);
+
+static int isRed(PNODE *n) { return n != 0 && n->red; }
+
+// the empty first version of a family of versions
+extern PRBT *newPRBT(int (*c)(void *, void *)) {
+  FAMILY * f = malloc(sizeof(FAMILY));
+  assert(f != NULL);
+  f->compare = c;
+  f->display = 0;
+  f->freeMethod = 0;
+  pthread_mutex_init(&f->lock, 0);
+  f->stamps = 0;
+  f->versions = 0;
+  f->nodes = 0;
+  PRBT * t = newVersion(0, 0);
+  t->family = f;
+  f->versions = 1;
+  return t;
+}
+
+// the display and free methods are shared by every version of the family
+extern void setPRBTdisplay(PRBT *t, void (*d)(void *, FILE *)) {
+  t->family->display = d;
+}
+
+extern void setPRBTfree(PRBT *t, void (*f)(void *)) {
+  t->family->freeMethod = f;
+}
+
+/* returns a new version holding value too, leaving t as it was; a value
+* equal to one already held is counted and, as in a GST, freed
+*/
+extern PRBT *insertPRBT(PRBT *t, void *value) {
+  EDIT e;
+  int duplicate = 0;
+  begin(&e, t->family);
+  PNODE * root = insert(&e, t->root, value, &duplicate);
+  root->red = 0;
+  finish(&e, root);
+  PRBT * v = newVersion(t, root);
+  if (duplicate) {
+    ++v->duplicates;
+    if (t->family->freeMethod) {
+      t->family->freeMethod(value);
+    }
+  }
+  else {
+    ++v->size;
+  }
+  return v;
+}
+
+/* returns a new version holding one instance of key fewer, leaving t as
+* it was, or a version sharing t's nodes if key is not there; a value is
+* freed with the last version holding it, never by this call
+*/
+extern PRBT *deletePRBT(PRBT *t, void *key) {
+  int freq = freqPRBT(t, key);
+  EDIT e;
+  if (freq == 0) {
+    PRBT * v = newVersion(t, t->root);
+    if (t->root) {
+      pthread_mutex_lock(&t->family->lock);
+      ++t->root->refs;
+      pthread_mutex_unlock(&t->family->lock);
+    }
+    return v;
+  }
+  begin(&e, t->family);
+  PNODE * root;
+  if (freq > 1) {
+    root = decrement(&e, t->root, key);
+  }
+  else {
+    root = copy(&e, t->root);
+    if (!isRed(root->left) && !isRed(root->right)) {
+      root->red = 1;
+    }
+    root = delete(&e, root, key);
+    if (root) {
+      root->red = 0;
+    }
+  }
+  finish(&e, root);
+  PRBT * v = newVersion(t, root);
+  if (freq > 1) {
+    --v->duplicates;
+  }
+  else {
+    --v->size;
+  }
+  return v;
+}
+
+/* takes another hold on t, in O(1), for a reader that must see t as it is
+* while the holder that made it goes on to newer versions; each hold is
+* let go by its own freePRBT
+*/
+extern PRBT *keepPRBT(PRBT *t) {
+  pthread_mutex_lock(&t->family->lock);
+  ++t->refs;
+  pthread_mutex_unlock(&t->family->lock);
+  return t;
+}
+
+extern void *findPRBT(PRBT *t, void *key) {
+  PNODE * n = locate(t, key);
+  return n ? n->held->value : 0;
+}
+
+extern int freqPRBT(PRBT *t, void *key) {
+  PNODE * n = locate(t, key);
+  return n ? n->freq : 0;
+}
+
+extern int sizePRBT(PRBT *t) {
+  return t->size;
+}
+
+extern int duplicatesPRBT(PRBT *t) {
+  return t->duplicates;
+}
+
+// calls visit on each value of t, in order, with its frequency and arg
+extern void walkPRBT(PRBT *t, void (*visit)(void *, int, void *), void *arg) {
+  walk(t->root, visit, arg);
+}
+
+extern void statisticsPRBT(PRBT *t, FILE *fp) {
+  pthread_mutex_lock(&t->family->lock);
+  int versions = t->family->versions;
+  long nodes = t->family->nodes;
+  pthread_mutex_unlock(&t->family->lock);
+  fprintf(fp, "Duplicates: %d\n", t->duplicates);
+  fprintf(fp, "Versions: %d, nodes in all: %ld\n", versions, nodes);
+  fprintf(fp, "Nodes: %d\n", t->size);
+  fprintf(fp, "Minimum depth: %d\n", t->root ? minDepth(t->root) : -1);
+  fprintf(fp, "Maximum depth: %d\n", t->root ? maxDepth(t->root) : -1);
+}
+
+// a level-order display, in the form displayRBT uses
+extern void displayPRBT(PRBT *t, FILE *fp) {
+  if (t->root == 0) {
+    fprintf(fp, "0:\n");
+    return;
+  }
+  PNODE ** level = malloc(sizeof(PNODE *) * 2 * (t->size + 1));
+  assert(level != NULL);
+  PNODE ** parent = level + t->size + 1;
+  int first = 0, last = 1, end = 1, depth = 0;
+  level[0] = t->root;
+  parent[0] = 0;
+  fprintf(fp, "0:");
+  while (first < last) {
+    PNODE * n = level[first];
+    fprintf(fp, " ");
+    displayNode(t->family, n, parent[first++], fp);
+    if (n->left) {
+      parent[last] = n;
+      level[last++] = n->left;
+    }
+    if (n->right) {
+      parent[last] = n;
+      level[last++] = n->right;
+    }
+    if (first == end && first < last) {
+      fprintf(fp, "\n%d:", ++depth);
+      end = last;
+    }
+  }
+  fprintf(fp, "\n");
+  free(level);
+}
+
+/* lets go of one hold on t; once none is left, the nodes no other version
+* shares are reclaimed, and values no node holds are freed
+*/
+extern void freePRBT(PRBT *t) {
+  FAMILY * f = t->family;
+  pthread_mutex_lock(&f->lock);
+  if (--t->refs > 0) {
+    pthread_mutex_unlock(&f->lock);
+    return;
+  }
+  if (t->root) {
+    release(f, t->root);
+  }
+  int last = --f->versions == 0;
+  pthread_mutex_unlock(&f->lock);
+  free(t);
+  if (last) {
+    pthread_mutex_destroy(&f->lock);
+    free(f);
+  }
+}
+
+// a version with root, counted as t's sibling
+static PRBT *newVersion(PRBT *t, PNODE *root) {
+  PRBT * v = malloc(sizeof(PRBT));
+  assert(v != NULL);
+  v->family = t ? t->family : 0;
+  v->root = root;
+  v->size = t ? t->size : 0;
+  v->duplicates = t ? t->duplicates : 0;
+  v->refs = 1;
+  if (t) {
+    pthread_mutex_lock(&t->family->lock);
+    ++t->family->versions;
+    pthread_mutex_unlock(&t->family->lock);
+  }
+  return v;
+}
+
+static void begin(EDIT *e, FAMILY *f) {
+  e->family = f;
+  pthread_mutex_lock(&f->lock);
+  e->stamp = ++f->stamps;
+  pthread_mutex_unlock(&f->lock);
+  e->count = 0;
+  e->capacity = 64;
+  e->made = malloc(sizeof(PNODE *) * e->capacity);
+  assert(e->made != NULL);
+}
+
+/* seals the nodes the change made that made it into the new version: each
+* is pointed at once and counts a hold on its value, and the older nodes
+* they point at gain a pointer; copies the change made and then dropped
+* took no holds and are simply freed
+*/
+static void finish(EDIT *e, PNODE *root) {
+  PNODE ** stack = malloc(sizeof(PNODE *) * (e->count + 1));
+  int top = 0, kept = 0;
+  assert(stack != NULL);
+  pthread_mutex_lock(&e->family->lock);
+  if (root) {
+    stack[top++] = root;
+  }
+  while (top) {
+    PNODE * n = stack[--top];
+    n->stamp = 0;
+    n->refs = 1;
+    ++n->held->refs;
+    ++kept;
+    PNODE * children[2] = { n->left, n->right };
+    for (int i = 0; i < 2; ++i) {
+      if (children[i] == 0) {
+        continue;
+      }
+      if (children[i]->stamp == e->stamp) {
+        stack[top++] = children[i];
+      }
+      else {
+        ++children[i]->refs;
+      }
+    }
+  }
+  e->family->nodes += kept;
+  pthread_mutex_unlock(&e->family->lock);
+  for (int i = 0; i < e->count; ++i) {
+    if (e->made[i]->stamp == e->stamp) {
+      free(e->made[i]);
+    }
+  }
+  free(stack);
+  free(e->made);
+}
+
+// n if the change made it, else a copy of n the change may write
+static PNODE *copy(EDIT *e, PNODE *n) {
+  if (n->stamp == e->stamp) {
+    return n;
+  }
+  PNODE * c = malloc(sizeof(PNODE));
+  assert(c != NULL);
+  *c = *n;
+  c->stamp = e->stamp;
+  c->refs = 0;
+  if (e->count == e->capacity) {
+    e->capacity *= 2;
+    e->made = realloc(e->made, sizeof(PNODE *) * e->capacity);
+    assert(e->made != NULL);
+  }
+  e->made[e->count++] = c;
+  return c;
+}
+
+static PNODE *insert(EDIT *e, PNODE *h, void *value, int *duplicate) {
+  if (h == 0) {
+    HELD * held = malloc(sizeof(HELD));
+    assert(held != NULL);
+    held->value = value;
+    held->refs = 0;
+    PNODE n = { held, 1, 1, 0, 0, 0, 0 };
+    return copy(e, &n);
+  }
+  int c = e->family->compare(value, h->held->value);
+  h = copy(e, h);
+  if (c == 0) {
+    ++h->freq;
+    *duplicate = 1;
+    return h;
+  }
+  if (c < 0) {
+    h->left = insert(e, h->left, value, duplicate);
+  }
+  else {
+    h->right = insert(e, h->right, value, duplicate);
+  }
+  return balance(e, h);
+}
+
+// copies the path to key, which is there more than once, to count one fewer
+static PNODE *decrement(EDIT *e, PNODE *h, void *key) {
+  int c = e->family->compare(key, h->held->value);
+  h = copy(e, h);
+  if (c == 0) {
+    --h->freq;
+  }
+  else if (c < 0) {
+    h->left = decrement(e, h->left, key);
+  }
+  else {
+    h->right = decrement(e, h->right, key);
+  }
+  return h;
+}
+
+// removes key, which is there once, from the subtree at h
+static PNODE *delete(EDIT *e, PNODE *h, void *key) {
+  h = copy(e, h);
+  if (e->family->compare(key, h->held->value) < 0) {
+    if (!isRed(h->left) && !isRed(h->left->left)) {
+      h = moveRedLeft(e, h);
+    }
+    h->left = delete(e, h->left, key);
+    return balance(e, h);
+  }
+  if (isRed(h->left)) {
+    h = rotateRight(e, h);
+  }
+  if (e->family->compare(key, h->held->value) == 0 && h->right == 0) {
+    return 0;
+  }
+  if (!isRed(h->right) && !isRed(h->right->left)) {
+    h = moveRedRight(e, h);
+  }
+  if (e->family->compare(key, h->held->value) == 0) {
+    PNODE * least = h->right;
+    while (least->left) {
+      least = least->left;
+    }
+    h->held = least->held;
+    h->freq = least->freq;
+    h->right = deleteMin(e, h->right);
+  }
+  else {
+    h->right = delete(e, h->right, key);
+  }
+  return balance(e, h);
+}
+
+static PNODE *deleteMin(EDIT *e, PNODE *h) {
+  if (h->left == 0) {
+    return 0;
+  }
+  h = copy(e, h);
+  if (!isRed(h->left) && !isRed(h->left->left)) {
+    h = moveRedLeft(e, h);
+  }
+  h->left = deleteMin(e, h->left);
+  return balance(e, h);
+}
+
+static PNODE *rotateLeft(EDIT *e, PNODE *h) {
+  h = copy(e, h);
+  PNODE * x = copy(e, h->right);
+  h->right = x->left;
+  x->left = h;
+  x->red = h->red;
+  h->red = 1;
+  return x;
+}
+
+static PNODE *rotateRight(EDIT *e, PNODE *h) {
+  h = copy(e, h);
+  PNODE * x = copy(e, h->left);
+  h->left = x->right;
+  x->right = h;
+  x->red = h->red;
+  h->red = 1;
+  return x;
+}
+
+// flips the colors of h, which the change made, and of its two children
+static void flip(EDIT *e, PNODE *h) {
+  h->red = !h->red;
+  h->left = copy(e, h->left);
+  h->left->red = !h->left->red;
+  h->right = copy(e, h->right);
+  h->right->red = !h->right->red;
+}
+
+static PNODE *moveRedLeft(EDIT *e, PNODE *h) {
+  flip(e, h);
+  if (isRed(h->right->left)) {
+    h->right = rotateRight(e, h->right);
+    h = rotateLeft(e, h);
+    flip(e, h);
+  }
+  return h;
+}
+
+static PNODE *moveRedRight(EDIT *e, PNODE *h) {
+  flip(e, h);
+  if (isRed(h->left->left)) {
+    h = rotateRight(e, h);
+    flip(e, h);
+  }
+  return h;
+}
+
+// restores the left-leaning invariants at h on the way back up
+static PNODE *balance(EDIT *e, PNODE *h) {
+  if (isRed(h->right) && !isRed(h->left)) {
+    h = rotateLeft(e, h);
+  }
+  if (isRed(h->left) && isRed(h->left->left)) {
+    h = rotateRight(e, h);
+  }
+  if (isRed(h->left) && isRed(h->right)) {
+    flip(e, h);
+  }
+  return h;
+}
+
+static PNODE *locate(PRBT *t, void *key) {
+  PNODE * n = t->root;
+  while (n) {
+    int c = t->family->compare(key, n->held->value);
+    if (c == 0) {
+      return n;
+    }
+    n = c < 0 ? n->left : n->right;
+  }
+  return 0;
+}
+
+// drops a pointer to n, reclaiming n and what only it held; lock held
+static void release(FAMILY *f, PNODE *n) {
+  PNODE ** stack = malloc(sizeof(PNODE *) * 64);
+  int top = 0, capacity = 64;
+  assert(stack != NULL);
+  stack[top++] = n;
+  while (top) {
+    n = stack[--top];
+    if (--n->refs > 0) {
+      continue;
+    }
+    if (--n->held->refs == 0) {
+      if (f->freeMethod) {
+        f->freeMethod(n->held->value);
+      }
+      free(n->held);
+    }
+    if (top + 2 > capacity) {
+      capacity *= 2;
+      stack = realloc(stack, sizeof(PNODE *) * capacity);
+      assert(stack != NULL);
+    }
+    if (n->left) {
+      stack[top++] = n->left;
+    }
+    if (n->right) {
+      stack[top++] = n->right;
+    }
+    free(n);
+    --f->nodes;
+  }
+  free(stack);
+}
+
+static void walk(PNODE *n, void (*visit)(void *, int, void *), void *arg) {
+  while (n) {
+    walk(n->left, visit, arg);
+    visit(n->held->value, n->freq, arg);
+    n = n->right;
+  }
+}
+
+// the depth of the shallowest node missing a child, as in a TNODE
+static int minDepth(PNODE *n) {
+  if (n->left == 0 || n->right == 0) {
+    return 0;
+  }
+  int l = minDepth(n->left), r = minDepth(n->right);
+  return (l < r ? l : r) + 1;
+}
+
+static int maxDepth(PNODE *n) {
+  int l = n->left ? maxDepth(n->left) + 1 : 0;
+  int r = n->right ? maxDepth(n->right) + 1 : 0;
+  return l > r ? l : r;
+}
+
+// as displayRBT shows a node: a leaf marked, then red and count, then parent
+static void displayNode(FAMILY *f, PNODE *n, PNODE *parent, FILE *fp) {
+  if (n->left == 0 && n->right == 0) {
+    fprintf(fp, "=");
+  }
+  displayValue(f, n, fp);
+  fprintf(fp, "(");
+  displayValue(f, parent ? parent : n, fp);
+  fprintf(fp, ")");
+  if (parent == 0) {
+    fprintf(fp, "X");
+  }
+  else if (parent->left == n) {
+    fprintf(fp, "L");
+  }
+  else {
+    fprintf(fp, "R");
+  }
+}
+
+static void displayValue(FAMILY *f, PNODE *n, FILE *fp) {
+  f->display(n->held->value, fp);
+  if (n->red) {
+    fprintf(fp, "*");
+  }
+  if (n->freq > 1) {
+    fprintf(fp, "<%d>", n->freq);
+  }
+}
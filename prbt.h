@@ -0,0 +1,25 @@
+/*** persistent red black tree class ***/
+
+#ifndef __PRBT_INCLUDED__
+#define __PRBT_INCLUDED__
+
+#include <stdio.h>
+
+typedef struct prbt PRBT;
+
+extern PRBT *newPRBT(int (*c)(void *,void *));
+extern void  setPRBTdisplay(PRBT *t,void (*d)(void *,FILE *));
+extern void  setPRBTfree(PRBT *t,void (*f)(void *));
+extern PRBT *insertPRBT(PRBT *t,void *value);
+extern PRBT *deletePRBT(PRBT *t,void *key);
+extern PRBT *keepPRBT(PRBT *t);
+extern void *findPRBT(PRBT *t,void *key);
+extern int   freqPRBT(PRBT *t,void *key);
+extern int   sizePRBT(PRBT *t);
+extern int   duplicatesPRBT(PRBT *t);
+extern void  walkPRBT(PRBT *t,void (*visit)(void *,int,void *),void *arg);
+extern void  statisticsPRBT(PRBT *t,FILE *fp);
+extern void  displayPRBT(PRBT *t,FILE *fp);
+extern void  freePRBT(PRBT *t);
+
+#endif
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gst.h"
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+static void
+show(TNODE *n,void *arg)
+    {
+    int *first = arg;
+    if (!*first) printf(" ");
+    displayINTEGER(unwrapRBT(n),stdout);
+    *first = 0;
+    }
+
+static void
+query(char *label,TNODE *n)
+    {
+    printf("%s: ",label);
+    if (n == 0)
+        printf("none");
+    else
+        displayINTEGER(unwrapRBT(n),stdout);
+    printf("\n");
+    }
+
+int
+main(void)
+    {
+    srandom(26);
+    printf("INTEGER test of RBT, cursors and point queries\n");
+    int i;
+    RBT *p = newRBT(compareINTEGER);
+    setRBTdisplay(p,displayINTEGER);
+    setRBTfree(p,freeINTEGER);
+    query("first of empty",firstRBT(p));
+    for (i = 0; i < 20; ++i)
+        {
+        int j = (random() % 50) * 2;
+        insertRBT(p,newINTEGER(j));
+        }
+    debugRBT(p,1);
+    printf("debug: ");
+    displayRBT(p,stdout);
+    printf("\n");
+    printf("forward:");
+    TNODE *n;
+    for (n = firstRBT(p); n != 0; n = nextRBT(p,n))
+        {
+        printf(" ");
+        displayINTEGER(unwrapRBT(n),stdout);
+        }
+    printf("\nbackward:");
+    for (n = lastRBT(p); n != 0; n = prevRBT(p,n))
+        {
+        printf(" ");
+        displayINTEGER(unwrapRBT(n),stdout);
+        }
+    printf("\n");
+    for (i = 0; i < 6; ++i)
+        {
+        INTEGER *k = newINTEGER(i * 14 - 1 + i % 2);
+        printf("key %d\n",getINTEGER(k));
+        query("  seek",seekRBT(p,k));
+        query("  floor",floorRBT(p,k));
+        query("  ceiling",ceilingRBT(p,k));
+        query("  predecessor",predecessorRBT(p,k));
+        query("  successor",successorRBT(p,k));
+        freeINTEGER(k);
+        }
+    INTEGER *lo = newINTEGER(20);
+    INTEGER *hi = newINTEGER(60);
+    int first = 1;
+    printf("range [20, 60]: ");
+    int count = rangeRBT(p,lo,hi,show,&first);
+    printf(" (%d nodes)\n",count);
+    freeINTEGER(lo);
+    freeINTEGER(hi);
+    freeRBT(p);
+    return 0;
+    }
@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gst.h"
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* recomputes every cached statistic the slow way and counts the nodes
+ * whose cached values disagree */
+static int
+check(TNODE *n,int *size,int *minDepth,int *maxDepth,long long *pathLength)
+    {
+    int ls = 0, lmin = -1, lmax = -1, rs = 0, rmin = -1, rmax = -1;
+    long long lp = 0, rp = 0;
+    int bad = 0;
+    if (getTNODEleft(n)) bad += check(getTNODEleft(n),&ls,&lmin,&lmax,&lp);
+    if (getTNODEright(n)) bad += check(getTNODEright(n),&rs,&rmin,&rmax,&rp);
+    *size = 1 + ls + rs;
+    *maxDepth = 1 + (lmax > rmax ? lmax : rmax);
+    *minDepth = (getTNODEleft(n) == 0 || getTNODEright(n) == 0) ? 0
+        : 1 + (lmin < rmin ? lmin : rmin);
+    *pathLength = lp + ls + rp + rs;
+    if (*size != getTNODEsize(n) || *maxDepth != getTNODEmaxDepth(n)
+    || *minDepth != getTNODEminDepth(n) || *pathLength != getTNODEpathLength(n))
+        ++bad;
+    return bad;
+    }
+
+static void
+verify(RBT *p)
+    {
+    int size, minDepth, maxDepth;
+    long long pathLength;
+    if (sizeRBT(p) == 0) return;
+    printf("stale nodes: %d\n",
+        check(getRBTroot(p),&size,&minDepth,&maxDepth,&pathLength));
+    }
+
+int
+main(void)
+    {
+    srandom(27);
+    printf("INTEGER test of RBT, cached depth statistics\n");
+    int i;
+    RBT *p = newRBT(compareINTEGER);
+    setRBTdisplay(p,displayINTEGER);
+    setRBTfree(p,freeINTEGER);
+    depthsRBT(p,stdout);
+    for (i = 0; i < 2000; ++i)
+        {
+        int j = random() % 1000;
+        insertRBT(p,newINTEGER(j));
+        }
+    verify(p);
+    statisticsRBT(p,stdout);
+    depthsRBT(p,stdout);
+    for (i = 0; i < 2000; ++i)
+        {
+        int j = random() % 1000;
+        INTEGER *a = newINTEGER(j);
+        if (freqRBT(p,a) > 0) deleteRBT(p,a);
+        freeINTEGER(a);
+        }
+    verify(p);
+    statisticsRBT(p,stdout);
+    depthsRBT(p,stdout);
+    freeRBT(p);
+    return 0;
+    }
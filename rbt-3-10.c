@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gst.h"
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* trees saved to snapshots and loaded back must display, count and
+ * behave as before; damaged snapshots must be turned away */
+
+#define SNAP "rbt-3-10.snapshot"
+
+static char before[1 << 20], after[1 << 20];
+
+// puts the tree's display and statistics in buffer
+static char *
+picture(RBT *p,GST *g,char *buffer)
+    {
+    FILE *fp = fopen("rbt-3-10.picture","w+");
+    if (p) { displayRBT(p,fp); statisticsRBT(p,fp); }
+    else { displayGST(g,fp); statisticsGST(g,fp); }
+    rewind(fp);
+    size_t n = fread(buffer,1,(1 << 20) - 1,fp);
+    buffer[n] = '\0';
+    fclose(fp);
+    remove("rbt-3-10.picture");
+    return buffer;
+    }
+
+static RBT *
+newTree(void)
+    {
+    RBT *p = newRBT(compareINTEGER);
+    setRBTdisplay(p,displayINTEGER);
+    setRBTfree(p,freeINTEGER);
+    return p;
+    }
+
+// cuts the snapshot down to its first size bytes
+static void
+shorten(long size)
+    {
+    FILE *fp = fopen(SNAP,"rb");
+    char *bytes = malloc(size);
+    size = fread(bytes,1,size,fp);
+    fclose(fp);
+    fp = fopen(SNAP,"wb");
+    fwrite(bytes,1,size,fp);
+    fclose(fp);
+    free(bytes);
+    }
+
+int
+main(void)
+    {
+    srandom(44);
+    printf("INTEGER test of RBT and GST, snapshots\n");
+    int i;
+    RBT *p = newTree(), *q = newTree();
+    for (i = 0; i < 5000; ++i) insertRBT(p,newINTEGER(random() % 3000));
+    for (i = 0; i < 500; ++i)
+        {
+        INTEGER *a = newINTEGER(random() % 3000), *x = findRBT(p,a);
+        if (deleteRBT(p,a) == 0) freeINTEGER(x);
+        freeINTEGER(a);
+        }
+    printf("save: %d\n",saveRBT(p,SNAP,writeINTEGER));
+    printf("load: %d\n",loadRBT(q,SNAP,readINTEGER));
+    picture(p,0,before);
+    printf("same display and statistics: %s\n",
+        strcmp(before,picture(q,0,after)) == 0 ? "yes" : "no");
+    printf("load into a full tree: %d\n",loadRBT(q,SNAP,readINTEGER));
+    int bad = 0;
+    for (i = 0; i < 3000; ++i)
+        {
+        INTEGER *a = newINTEGER(i);
+        if (freqRBT(p,a) != freqRBT(q,a)) ++bad;
+        if (i % 2)
+            {
+            INTEGER *x = findRBT(p,a), *y = findRBT(q,a);
+            if (deleteRBT(p,a) == 0) freeINTEGER(x);
+            if (deleteRBT(q,a) == 0) freeINTEGER(y);
+            }
+        else
+            {
+            insertRBT(p,newINTEGER(i));
+            insertRBT(q,newINTEGER(i));
+            }
+        freeINTEGER(a);
+        }
+    printf("after updates: %d differences, debug %s\n",bad,
+        debugRBT(q,0) == debugRBT(p,0) ? "agrees" : "differs");
+    picture(p,0,before);
+    printf("same display after updates: %s\n",
+        strcmp(before,picture(q,0,after)) == 0 ? "yes" : "no");
+
+    FILE *fp = fopen(SNAP,"rb");
+    fseek(fp,0,SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    shorten(size / 2);
+    RBT *r = newTree();
+    printf("load a damaged snapshot: %d, size %d\n",
+        loadRBT(r,SNAP,readINTEGER),sizeRBT(r));
+    printf("load a text file: %d\n",loadRBT(r,"t-0-5.corpus",readINTEGER));
+    freeRBT(r);
+    freeRBT(p);
+    freeRBT(q);
+
+    GST *g = newGST(compareINTEGER), *h = newGST(compareINTEGER);
+    setGSTdisplay(g,displayINTEGER);
+    setGSTdisplay(h,displayINTEGER);
+    setGSTfree(g,freeINTEGER);
+    setGSTfree(h,freeINTEGER);
+    setGSTmultiset(g,1);
+    setGSTmultiset(h,1);
+    for (i = 0; i < 2000; ++i) insertGST(g,newINTEGER(random() % 300));
+    printf("GST save: %d",saveGST(g,SNAP,writeINTEGER));
+    printf(", load: %d\n",loadGST(h,SNAP,readINTEGER));
+    picture(0,g,before);
+    printf("same display and statistics: %s\n",
+        strcmp(before,picture(0,h,after)) == 0 ? "yes" : "no");
+    TNODE *top[5];
+    int found = topKGST(h,5,top);
+    for (i = 0; i < found; ++i)
+        printf("top %d: %d x %d\n",i + 1,getINTEGER(unwrapGST(top[i])),
+            nodeFreqGST(top[i]));
+    r = newTree();
+    printf("load a GST's snapshot as an RBT: %d, size %d\n",
+        loadRBT(r,SNAP,readINTEGER),sizeRBT(r));
+    freeRBT(r);
+    freeGST(g);
+    freeGST(h);
+    remove(SNAP);
+    return 0;
+    }
@@ -0,0 +1,138 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "gst.h"
+#include "rbt.h"
+#include "mapped.h"
+#include "string.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* an RBT of words is published as a mapped tree, read by two maps and a
+ * child process, then republished while a reader keeps the old version */
+
+#define MAP "rbt-3-11.mapped"
+#define KEYS 2000
+#define TOKENS 10000
+
+static char *
+text(void *v)
+    {
+    return getSTRING(v);
+    }
+
+static char *
+copy(char *s)
+    {
+    return strcpy(malloc(strlen(s) + 1),s);
+    }
+
+static int
+backwards(void *a,void *b)
+    {
+    return compareSTRING(b,a);
+    }
+
+static RBT *
+newTree(void)
+    {
+    RBT *p = newRBT(compareSTRING);
+    setRBTfree(p,freeSTRING);
+    setRBTdisplay(p,displaySTRING);
+    return p;
+    }
+
+static void
+insertWords(RBT *p,int n)
+    {
+    int i;
+    char word[16];
+    for (i = 0; i < n; ++i)
+        {
+        sprintf(word,"w%ld",random() % KEYS);
+        insertRBT(p,newSTRING(copy(word)));
+        }
+    }
+
+// counts the words, present or not, whose frequencies differ
+static int
+mismatches(MAPPED *m,RBT *p)
+    {
+    int i, bad = 0;
+    char word[16];
+    for (i = 0; i < 2 * KEYS; ++i)
+        {
+        sprintf(word,"w%d",i);
+        STRING *s = newSTRING(word);
+        if (freqMAPPED(m,word) != freqRBT(p,s)) ++bad;
+        setSTRING(s,0);
+        freeSTRING(s);
+        }
+    if (freqMAPPED(m,"") != 0) ++bad;
+    return bad;
+    }
+
+int
+main(void)
+    {
+    srandom(45);
+    printf("STRING test of RBT, mapped trees\n");
+    RBT *p = newTree();
+    insertWords(p,TOKENS);
+    printf("published: %d\n",publishRBT(p,MAP,text));
+    MAPPED *a = openMAPPED(MAP), *b = openMAPPED(MAP);
+    printf("keys %d of %d, mismatches %d and %d\n",sizeMAPPED(a),sizeRBT(p),
+        mismatches(a,p),mismatches(b,p));
+
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0)
+        {
+        MAPPED *c = openMAPPED(MAP);
+        int bad = mismatches(c,p);
+        closeMAPPED(c);
+        _exit(bad > 100 ? 100 : bad);
+        }
+    int status;
+    waitpid(child,&status,0);
+    printf("child process mismatches: %d\n",
+        WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+
+    insertWords(p,TOKENS);
+    printf("nothing new to refresh: %d\n",refreshMAPPED(b));
+    printf("republished: %d\n",publishRBT(p,MAP,text));
+    printf("old version kept until refreshed: %s\n",
+        mismatches(b,p) > 0 ? "yes" : "no");
+    printf("refreshed: %d",refreshMAPPED(b));
+    printf(", then %d\n",refreshMAPPED(b));
+    printf("mismatches after refresh: %d\n",mismatches(b,p));
+    closeMAPPED(a);
+    closeMAPPED(b);
+
+    GST *g = newGST(backwards);
+    setGSTfree(g,freeSTRING);
+    insertGST(g,newSTRING(copy("a")));
+    insertGST(g,newSTRING(copy("b")));
+    printf("published out of strcmp order: %d\n",publishGST(g,MAP,text));
+    freeGST(g);
+    printf("after a failed publish: %s\n",
+        (a = openMAPPED(MAP)) && sizeMAPPED(a) == sizeRBT(p) ? "intact" : "lost");
+    closeMAPPED(a);
+
+    RBT *q = newTree();
+    publishRBT(q,MAP,text);
+    a = openMAPPED(MAP);
+    printf("empty tree: %d keys, frequency %d\n",sizeMAPPED(a),
+        freqMAPPED(a,"w1"));
+    closeMAPPED(a);
+    freeRBT(q);
+    remove(MAP);
+    printf("missing file opened: %s\n",openMAPPED(MAP) ? "yes" : "no");
+    printf("other file opened: %s\n",openMAPPED("rbt-3-11.c") ? "yes" : "no");
+    freeRBT(p);
+    return 0;
+    }
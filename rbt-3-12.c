@@ -0,0 +1,203 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "rbt.h"
+#include "wal.h"
+#include "string.h"
+
+/* changes to an RBT are logged, with checkpoints, and the tree recovered
+ * from the log after a clean close, a crash and a torn last record */
+
+#define LOG "rbt-3-12.log"
+#define KEYS 500
+#define CHANGES 5000
+#define GROUP 64
+
+static unsigned long seed;
+
+// the changes are drawn from a generator of our own, the same in a child
+static int
+draw(int n)
+    {
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    return (int)((seed >> 33) % n);
+    }
+
+static RBT *
+newTree(void)
+    {
+    RBT *p = newRBT(compareSTRING);
+    setRBTfree(p,freeSTRING);
+    setRBTdisplay(p,displaySTRING);
+    return p;
+    }
+
+static void
+apply(int op,char *key,int length,void *tree)
+    {
+    STRING *s = newSTRING(strcpy(malloc(length + 1),key));
+    if (op == 'i')
+        {
+        insertRBT(tree,s);
+        return;
+        }
+    // the tree gives up, and does not free, the last instance of a key
+    STRING *held = findRBT(tree,s);
+    if (held && deleteRBT(tree,s) == 0) freeSTRING(held);
+    freeSTRING(s);
+    }
+
+static int
+save(char *path,void *tree)
+    {
+    return saveRBT(tree,path,writeSTRING);
+    }
+
+// makes change i, logging it if w is not null, and checkpointing every so often
+static void
+change(RBT *p,WAL *w,int every)
+    {
+    char key[16];
+    int op = draw(3) ? 'i' : 'd';
+    sprintf(key,"k%d",draw(KEYS));
+    if (w) logWAL(w,op,key,strlen(key));
+    apply(op,key,strlen(key),p);
+    if (w && every && recordsWAL(w) >= every) checkpointWAL(w,save,p);
+    }
+
+// the tree after the first n changes from seed s
+static RBT *
+expected(unsigned long s,int n)
+    {
+    int i;
+    RBT *p = newTree();
+    seed = s;
+    for (i = 0; i < n; ++i) change(p,0,0);
+    return p;
+    }
+
+static int
+differences(RBT *p,RBT *q)
+    {
+    int i, bad = sizeRBT(p) != sizeRBT(q);
+    char key[16];
+    for (i = 0; i < KEYS; ++i)
+        {
+        sprintf(key,"k%d",i);
+        STRING *s = newSTRING(key);
+        if (freqRBT(p,s) != freqRBT(q,s)) ++bad;
+        setSTRING(s,0);
+        freeSTRING(s);
+        }
+    return bad;
+    }
+
+// reopens the log and rebuilds its tree, returning the changes replayed
+static RBT *
+recover(long *replayed,WAL **kept)
+    {
+    RBT *p = newTree();
+    WAL *w = openWAL(LOG,GROUP);
+    if (snapshotWAL(w) && loadRBT(p,snapshotWAL(w),readSTRING) != 0)
+        printf("snapshot %s not loaded\n",snapshotWAL(w));
+    *replayed = replayWAL(w,apply,p);
+    if (kept) *kept = w;
+    else closeWAL(w);
+    return p;
+    }
+
+static void
+clear(void)
+    {
+    char name[32];
+    int i;
+    remove(LOG);
+    for (i = 0; i < 100; ++i)
+        {
+        sprintf(name,"%s.%d",LOG,i);
+        remove(name);
+        }
+    }
+
+int
+main(void)
+    {
+    int i;
+    long replayed;
+    printf("STRING test of RBT, write-ahead log\n");
+    clear();
+    WAL *w = openWAL(LOG,GROUP);
+    printf("new log: snapshot %s, %ld records\n",
+        snapshotWAL(w) ? snapshotWAL(w) : "none",replayWAL(w,apply,0));
+    RBT *p = newTree();
+    seed = 46;
+    for (i = 0; i < CHANGES; ++i) change(p,w,0);
+    closeWAL(w);
+    RBT *q = recover(&replayed,0);
+    printf("closed log: %ld replayed, %d differences\n",replayed,
+        differences(p,q));
+    freeRBT(p);
+    freeRBT(q);
+
+    clear();
+    w = openWAL(LOG,GROUP);
+    p = newTree();
+    seed = 47;
+    for (i = 0; i < CHANGES; ++i) change(p,w,1200);
+    printf("checkpointed: snapshot %s, %ld records after it\n",
+        snapshotWAL(w),recordsWAL(w));
+    closeWAL(w);
+    printf("older snapshot removed: %s\n",
+        access(LOG ".3",F_OK) != 0 ? "yes" : "no");
+    q = recover(&replayed,0);
+    printf("checkpointed log: %ld replayed, %d differences\n",replayed,
+        differences(p,q));
+    freeRBT(p);
+    freeRBT(q);
+
+    clear();
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0)
+        {
+        w = openWAL(LOG,GROUP);
+        p = newTree();
+        seed = 48;
+        for (i = 0; i < CHANGES + 10; ++i) change(p,w,2000);
+        _exit(0); // no close, so the last group is never committed
+        }
+    waitpid(child,0,0);
+    q = recover(&replayed,0);
+    p = expected(48,4000 + (int)replayed);
+    printf("after a crash: committed changes kept: %s, %d differences\n",
+        replayed >= (CHANGES + 10 - 4000) / GROUP * GROUP ? "yes" : "no",
+        differences(p,q));
+    freeRBT(p);
+    freeRBT(q);
+
+    FILE *fp = fopen(LOG,"r+b");
+    fseek(fp,0,SEEK_END);
+    long length = ftell(fp);
+    fclose(fp);
+    if (truncate(LOG,length - 2) != 0) printf("truncate failed\n");
+    q = recover(&replayed,&w);
+    p = expected(48,4000 + (int)replayed);
+    printf("torn record dropped: %ld replayed, %d differences\n",replayed,
+        differences(p,q));
+    logWAL(w,'i',"fresh",5);
+    apply('i',"fresh",5,q);
+    closeWAL(w);
+    freeRBT(p);
+    p = recover(&replayed,0);
+    printf("appended after the tear: %ld replayed, %d differences\n",replayed,
+        differences(p,q));
+    freeRBT(p);
+    freeRBT(q);
+
+    printf("other file opened: %s\n",openWAL("rbt-3-12.c",GROUP) ? "yes" : "no");
+    clear();
+    return 0;
+    }
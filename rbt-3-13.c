@@ -0,0 +1,184 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "rbt.h"
+#include "server.h"
+#include "integer.h"
+
+/* a child serves an RBT over a Unix socket while many clients send keys
+ * at once, in pieces that split lines; each key is answered with the
+ * change's place in the order and the key's new frequency */
+
+#define SOCKET "rbt-3-13.sock"
+#define CLIENTS 20
+#define SENDS 500
+#define KEYS 50
+#define PIECE 37
+
+static RBT *tree;
+static int changes;
+
+// a line is a key, or "s" for the size of the tree
+static void
+serve(FILE *in,FILE *out,void *arg)
+    {
+    char line[32];
+    (void) arg;
+    while (fgets(line,sizeof(line),in))
+        {
+        if (line[0] == 's')
+            {
+            fprintf(out,"size %d, changes %d\n",sizeRBT(tree),changes);
+            continue;
+            }
+        // the tree frees an inserted duplicate, so a copy is looked up
+        INTEGER *k = newINTEGER(atoi(line));
+        insertRBT(tree,newINTEGER(getINTEGER(k)));
+        ++changes;
+        fprintf(out,"%d %d\n",changes,freqRBT(tree,k));
+        freeINTEGER(k);
+        }
+    }
+
+static int
+serveTree(void)
+    {
+    tree = newRBT(compareINTEGER);
+    setRBTfree(tree,freeINTEGER);
+    SERVER *s = newSERVER(SOCKET);
+    if (s == 0) return 1;
+    int result = runSERVER(s,serve,0);
+    printf("clients served: %d\n",clientsSERVER(s));
+    freeSERVER(s);
+    freeRBT(tree);
+    return result != 0;
+    }
+
+static int
+dial(void)
+    {
+    struct sockaddr_un a;
+    int tries;
+    memset(&a,0,sizeof(a));
+    a.sun_family = AF_UNIX;
+    strcpy(a.sun_path,SOCKET);
+    for (tries = 0; tries < 500; ++tries)
+        {
+        int fd = socket(AF_UNIX,SOCK_STREAM,0);
+        if (connect(fd,(struct sockaddr *)&a,sizeof(a)) == 0) return fd;
+        close(fd);
+        poll(0,0,10);
+        }
+    return -1;
+    }
+
+// reads everything until the server closes the connection
+static char *
+drain(int fd)
+    {
+    long size = 4096, used = 0, got;
+    char *text = malloc(size);
+    while ((got = read(fd,text + used,size - used - 1)) > 0)
+        {
+        used += got;
+        if (size - used < 2) text = realloc(text,size *= 2);
+        }
+    text[used] = '\0';
+    return text;
+    }
+
+int
+main(void)
+    {
+    printf("INTEGER test of RBT, served over a Unix socket\n");
+    int i, j, status;
+    fflush(stdout);
+
+    // a socket left by a server that has gone is replaced
+    struct sockaddr_un a;
+    memset(&a,0,sizeof(a));
+    a.sun_family = AF_UNIX;
+    strcpy(a.sun_path,SOCKET);
+    int stale = socket(AF_UNIX,SOCK_STREAM,0);
+    unlink(SOCKET);
+    bind(stale,(struct sockaddr *)&a,sizeof(a));
+    close(stale);
+
+    pid_t child = fork();
+    if (child == 0) exit(serveTree());
+
+    int fds[CLIENTS];
+    char *streams[CLIENTS];
+    long lengths[CLIENTS], sent[CLIENTS];
+    for (i = 0; i < CLIENTS; ++i)
+        {
+        fds[i] = dial();
+        streams[i] = malloc(SENDS * 8);
+        lengths[i] = sent[i] = 0;
+        for (j = 0; j < SENDS; ++j)
+            lengths[i] += sprintf(streams[i] + lengths[i],"%d\n",
+                i * 100 + j % KEYS);
+        }
+    printf("a second server on a live socket: %s\n",
+        newSERVER(SOCKET) ? "made" : "refused");
+
+    // the clients send in turn, a few bytes at a time
+    int busy = CLIENTS;
+    while (busy)
+        for (i = 0, busy = 0; i < CLIENTS; ++i)
+            {
+            long n = lengths[i] - sent[i] < PIECE ? lengths[i] - sent[i] : PIECE;
+            if (n == 0) continue;
+            sent[i] += write(fds[i],streams[i] + sent[i],n);
+            if (sent[i] < lengths[i]) ++busy;
+            else shutdown(fds[i],SHUT_WR);
+            }
+
+    int bad = 0, total = 0;
+    char *seen = calloc(CLIENTS * SENDS + 1,1);
+    for (i = 0; i < CLIENTS; ++i)
+        {
+        char *text = drain(fds[i]), *line = text;
+        int last = 0, order, freq;
+        for (j = 0; j < SENDS; ++j)
+            {
+            if (sscanf(line,"%d %d",&order,&freq) != 2) { ++bad; break; }
+            // this client alone sends its keys, each once every KEYS
+            if (order <= last || freq != j / KEYS + 1) ++bad;
+            if (order > 0 && order <= CLIENTS * SENDS) seen[order] = 1;
+            last = order;
+            ++total;
+            line = strchr(line,'\n') + 1;
+            }
+        if (*line != '\0') ++bad;
+        close(fds[i]);
+        free(text);
+        free(streams[i]);
+        }
+    for (i = 1; i <= CLIENTS * SENDS; ++i) if (!seen[i]) ++bad;
+    free(seen);
+    printf("answers: %d, out of order or wrong: %d\n",total,bad);
+
+    char *summary = 0;
+    size_t size = 0;
+    FILE *in = fmemopen("s\n",2,"r"), *out = open_memstream(&summary,&size);
+    talkSERVER(SOCKET,in,out);
+    fclose(in);
+    fclose(out);
+    printf("%s",summary);
+    free(summary);
+    fflush(stdout);
+
+    kill(child,SIGTERM);
+    waitpid(child,&status,0);
+    printf("server exit status: %d\n",WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+    printf("socket removed: %s\n",access(SOCKET,F_OK) != 0 ? "yes" : "no");
+    return 0;
+    }
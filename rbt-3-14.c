@@ -0,0 +1,114 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "ring.h"
+#include "pipeline.h"
+
+/* a small ring passes a long run of items between two threads, then a
+ * pipeline's three stages run a stream whose executor holds work back
+ * until it is told no item is waiting */
+
+#define ITEMS 1000000
+#define STREAM 200000
+
+static RING *ring;
+
+static void *
+produce(void *arg)
+    {
+    long i;
+    (void) arg;
+    for (i = 1; i <= ITEMS; ++i)
+        putRING(ring,(void *)i);
+    putRING(ring,0);
+    return 0;
+    }
+
+static long parsed;
+
+// items are the numbers 1 to STREAM
+static void *
+parse(void *arg)
+    {
+    (void) arg;
+    if (parsed == STREAM) return 0;
+    long *n = malloc(sizeof(long));
+    *n = ++parsed;
+    return n;
+    }
+
+typedef struct held
+    {
+    long sum;
+    long count;
+    long flushes;
+    long next;
+    long wrong;
+    } HELD;
+
+// a sum of every 100 items is printed, or of fewer when none is waiting
+static void
+execute(void *item,FILE *out,void *arg)
+    {
+    HELD *h = arg;
+    if (item == 0 || h->count == 100)
+        {
+        if (h->count) fprintf(out,"%ld %ld\n",h->count,h->sum);
+        h->sum = h->count = 0;
+        ++h->flushes;
+        }
+    if (item == 0) return;
+    long n = *(long *)item;
+    if (n != ++h->next) ++h->wrong;
+    h->sum += n;
+    ++h->count;
+    free(item);
+    }
+
+int
+main(void)
+    {
+    printf("test of RING and PIPELINE\n");
+    long item, expected = 1, wrong = 0;
+    pthread_t producer;
+    ring = newRING(6);
+    pthread_create(&producer,0,produce,0);
+    while ((item = (long) getRING(ring)) != 0)
+        if (item != expected++) ++wrong;
+    pthread_join(producer,0);
+    printf("ring: %ld items, %ld out of order, %d left\n",expected - 1,wrong,
+        readyRING(ring));
+    freeRING(ring);
+
+    char *text = 0;
+    size_t size = 0;
+    FILE *out = open_memstream(&text,&size);
+    HELD h = { 0, 0, 0, 0, 0 };
+    runPIPELINE(parse,execute,&h,out,16);
+    fclose(out);
+    long count, sum, items = 0, total = 0;
+    char *line = text;
+    while (sscanf(line,"%ld %ld",&count,&sum) == 2)
+        {
+        items += count;
+        total += sum;
+        line = strchr(line,'\n') + 1;
+        }
+    printf("pipeline: %ld items written, %ld out of order\n",items,h.wrong);
+    printf("sums match: %s\n",total == (long) STREAM * (STREAM + 1) / 2
+        ? "yes" : "no");
+    printf("told when idle at least once: %s\n",h.flushes > 0 ? "yes" : "no");
+    free(text);
+
+    // the stages wait on each other at every item
+    HELD one = { 0, 0, 0, 0, 0 };
+    parsed = 0;
+    out = fopen("/dev/null","w");
+    runPIPELINE(parse,execute,&one,out,1);
+    fclose(out);
+    printf("a ring of one slot: %ld items, %ld out of order\n",one.next,
+        one.wrong);
+    return 0;
+    }
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bst.h"
+#include "gst.h"
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+#define KEYS 400
+
+int
+main(void)
+    {
+    srandom(30);
+    printf("INTEGER test of RBT and BST, relinking deletes\n");
+    int i, moved = 0, same = 1;
+    RBT *p = newRBT(compareINTEGER);
+    RBT *q = newRBT(compareINTEGER);
+    setRBTdisplay(p,displayINTEGER);
+    setRBTdisplay(q,displayINTEGER);
+    setRBTfree(p,freeINTEGER);
+    setRBTfree(q,freeINTEGER);
+    setRBTrelink(p,1);
+    TNODE *handle[KEYS] = {0};
+    for (i = 0; i < KEYS; ++i)
+        {
+        handle[i] = insertRBT(p,newINTEGER(i));
+        insertRBT(q,newINTEGER(i));
+        }
+    for (i = 0; i < KEYS / 2; ++i)
+        {
+        int j = random() % KEYS;
+        INTEGER *a = newINTEGER(j);
+        INTEGER *x = findRBT(p,a);
+        if (x)
+            {
+            INTEGER *y = findRBT(q,a);
+            deleteRBT(p,a);
+            deleteRBT(q,a);
+            freeINTEGER(x);
+            freeINTEGER(y);
+            handle[j] = 0;
+            }
+        freeINTEGER(a);
+        }
+    for (i = 0; i < KEYS; ++i)
+        {
+        if (handle[i] == 0) continue;
+        if (getINTEGER(unwrapRBT(handle[i])) != i) ++moved;
+        INTEGER *a = newINTEGER(i);
+        if (locateRBT(p,a) != handle[i]) ++moved;
+        freeINTEGER(a);
+        }
+    printf("RBT handles that moved: %d\n",moved);
+    FILE *fp = tmpfile(), *fq = tmpfile();
+    displayRBT(p,fp);
+    displayRBT(q,fq);
+    rewind(fp);
+    rewind(fq);
+    int c, d;
+    do
+        {
+        c = fgetc(fp);
+        d = fgetc(fq);
+        if (c != d) same = 0;
+        }
+    while (c != EOF && d != EOF);
+    fclose(fp);
+    fclose(fq);
+    printf("RBT same as value-swapping tree? %s\n",same ? "yes" : "no");
+    statisticsRBT(p,stdout);
+    statisticsRBT(q,stdout);
+    freeRBT(p);
+    freeRBT(q);
+
+    BST *b = newBST(compareINTEGER);
+    setBSTdisplay(b,displayINTEGER);
+    setBSTfree(b,freeINTEGER);
+    setBSTrelink(b,1);
+    for (i = 0; i < KEYS; ++i)
+        {
+        int j = random() % KEYS;
+        INTEGER *a = newINTEGER(j);
+        if (findBST(b,a) == 0) handle[j] = insertBST(b,a);
+        else freeINTEGER(a);
+        }
+    moved = 0;
+    for (i = 0; i < KEYS; ++i)
+        {
+        INTEGER *a = newINTEGER(random() % KEYS);
+        INTEGER *x = findBST(b,a);
+        if (x)
+            {
+            deleteBST(b,a);
+            freeINTEGER(x);
+            }
+        freeINTEGER(a);
+        }
+    for (i = 0; i < KEYS; ++i)
+        {
+        INTEGER *a = newINTEGER(i);
+        TNODE *h = locateBST(b,a);
+        if (h && h != handle[i]) ++moved;
+        if (h && getINTEGER(getTNODEvalue(h)) != i) ++moved;
+        freeINTEGER(a);
+        }
+    printf("BST handles that moved: %d\n",moved);
+    statisticsBST(b,stdout);
+    freeBST(b);
+    return 0;
+    }
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gst.h"
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+#define KEYS 1500
+
+static int countA[KEYS], countB[KEYS];
+
+static RBT *
+buildRBT(int *count,int n,int lo,int span)
+    {
+    int i;
+    RBT *p = newRBT(compareINTEGER);
+    setRBTdisplay(p,displayINTEGER);
+    setRBTfree(p,freeINTEGER);
+    for (i = 0; i < KEYS; ++i) count[i] = 0;
+    for (i = 0; i < n; ++i)
+        {
+        int j = lo + random() % span;
+        ++count[j];
+        insertRBT(p,newINTEGER(j));
+        }
+    return p;
+    }
+
+static GST *
+buildGST(int *count,int n,int lo,int span)
+    {
+    int i;
+    GST *p = newGST(compareINTEGER);
+    setGSTdisplay(p,displayINTEGER);
+    setGSTfree(p,freeINTEGER);
+    for (i = 0; i < KEYS; ++i) count[i] = 0;
+    for (i = 0; i < n; ++i)
+        {
+        int j = lo + random() % span;
+        ++count[j];
+        insertGST(p,newINTEGER(j));
+        }
+    return p;
+    }
+
+static int
+expected(int op,int a,int b)
+    {
+    if (op == 0) return a + b;
+    if (op == 1) return a < b ? a : b;
+    return a > b ? a - b : 0;
+    }
+
+/* compares every frequency, the size and the duplicate count of p against
+ * the op applied to the two count tables */
+static void
+checkRBT(RBT *p,int op)
+    {
+    int i, bad = 0, size = 0, dups = 0, log = 0;
+    for (i = 0; i < KEYS; ++i)
+        {
+        int f = expected(op,countA[i],countB[i]);
+        INTEGER *a = newINTEGER(i);
+        if (freqRBT(p,a) != f) ++bad;
+        freeINTEGER(a);
+        if (f) { ++size; dups += f - 1; }
+        }
+    while ((1 << log) <= sizeRBT(p)) ++log;
+    printf("mismatches: %d, size %s, duplicates %s, ",bad,
+        size == sizeRBT(p) ? "ok" : "WRONG",
+        dups == duplicatesRBT(p) ? "ok" : "WRONG");
+    printf("height within 2 log n? %s\n",sizeRBT(p) == 0
+        || getTNODEmaxDepth(getRBTroot(p)) < 2 * log ? "yes" : "no");
+    statisticsRBT(p,stdout);
+    }
+
+static void
+checkGST(GST *p,int op)
+    {
+    int i, bad = 0, size = 0, dups = 0;
+    for (i = 0; i < KEYS; ++i)
+        {
+        int f = expected(op,countA[i],countB[i]);
+        INTEGER *a = newINTEGER(i);
+        if (freqGST(p,a) != f) ++bad;
+        freeINTEGER(a);
+        if (f) { ++size; dups += f - 1; }
+        }
+    printf("mismatches: %d, size %s, duplicates %s\n",bad,
+        size == sizeGST(p) ? "ok" : "WRONG",
+        dups == duplicatesGST(p) ? "ok" : "WRONG");
+    }
+
+int
+main(void)
+    {
+    srandom(32);
+    printf("INTEGER test of RBT and GST, join, split and set operations\n");
+    static const char *names[] = { "union", "intersection", "difference" };
+    int i, op;
+    for (op = 0; op < 3; ++op)
+        {
+        RBT *a = buildRBT(countA,2000,0,1000);
+        RBT *b = buildRBT(countB,600,500,1000);
+        if (op == 0) a = unionRBT(a,b);
+        else if (op == 1) a = intersectionRBT(a,b);
+        else a = differenceRBT(a,b);
+        printf("RBT %s: ",names[op]);
+        checkRBT(a,op);
+        freeRBT(a);
+        }
+    for (op = 0; op < 3; ++op)
+        {
+        GST *a = buildGST(countA,2000,0,1000);
+        GST *b = buildGST(countB,600,500,1000);
+        if (op == 0) a = unionGST(a,b);
+        else if (op == 1) a = intersectionGST(a,b);
+        else a = differenceGST(a,b);
+        printf("GST %s: ",names[op]);
+        checkGST(a,op);
+        freeGST(a);
+        }
+
+    /* split a tree in two, check the halves, then put it back together */
+    RBT *a = buildRBT(countA,3000,0,1000);
+    RBT *hi = newRBT(compareINTEGER);
+    setRBTdisplay(hi,displayINTEGER);
+    setRBTfree(hi,freeINTEGER);
+    INTEGER *key = newINTEGER(700);
+    splitRBT(a,key,hi);
+    printf("split at 700: low ends at %d, high starts at %d\n",
+        getINTEGER(unwrapRBT(lastRBT(a))),getINTEGER(unwrapRBT(firstRBT(hi))));
+    for (i = 0; i < KEYS; ++i) countB[i] = 0;
+    a = unionRBT(a,hi);
+    printf("rejoined: ");
+    checkRBT(a,0);
+    freeINTEGER(key);
+    freeRBT(a);
+
+    RBT *left = newRBT(compareINTEGER);
+    RBT *right = newRBT(compareINTEGER);
+    setRBTdisplay(left,displayINTEGER);
+    setRBTdisplay(right,displayINTEGER);
+    setRBTfree(left,freeINTEGER);
+    setRBTfree(right,freeINTEGER);
+    for (i = 0; i < 15; ++i) insertRBT(left,newINTEGER(i));
+    for (i = 20; i < 23; ++i) insertRBT(right,newINTEGER(i));
+    left = joinRBT(left,newINTEGER(17),right);
+    printf("joinRBT of 0-14, 17 and 20-22:\n");
+    displayRBT(left,stdout);
+    statisticsRBT(left,stdout);
+    freeRBT(left);
+
+    /* a large union of interleaved keys stays balanced */
+    a = newRBT(compareINTEGER);
+    RBT *b = newRBT(compareINTEGER);
+    setRBTfree(a,freeINTEGER);
+    setRBTfree(b,freeINTEGER);
+    for (i = 0; i < 200000; ++i)
+        insertRBT(i % 3 ? a : b,newINTEGER(i));
+    a = unionRBT(a,b);
+    printf("union of 200000 interleaved keys:\n");
+    statisticsRBT(a,stdout);
+    freeRBT(a);
+    return 0;
+    }
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gst.h"
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+#define KEYS 50000
+
+static int count[KEYS];
+
+static void
+check(RBT *p,const char *what)
+    {
+    int i, bad = 0, size = 0, dups = 0, log = 0;
+    for (i = 0; i < KEYS; ++i)
+        {
+        INTEGER *a = newINTEGER(i);
+        if (freqRBT(p,a) != count[i]) ++bad;
+        freeINTEGER(a);
+        if (count[i]) { ++size; dups += count[i] - 1; }
+        }
+    while ((1 << log) <= sizeRBT(p)) ++log;
+    printf("%s: mismatches %d, size %s, duplicates %s, height within 2 log n? %s\n",
+        what,bad,size == sizeRBT(p) ? "ok" : "WRONG",
+        dups == duplicatesRBT(p) ? "ok" : "WRONG",
+        sizeRBT(p) == 0 || getTNODEmaxDepth(getRBTroot(p)) < 2 * log
+        ? "yes" : "no");
+    }
+
+int
+main(void)
+    {
+    srandom(34);
+    printf("INTEGER test of RBT, batched inserts and deletes\n");
+    static void *batch[100000];
+    int i, round;
+    RBT *p = newRBT(compareINTEGER);
+    setRBTdisplay(p,displayINTEGER);
+    setRBTfree(p,freeINTEGER);
+    insertManyRBT(p,batch,0);
+    check(p,"empty batch");
+    for (i = 0; i < 20; ++i)
+        {
+        ++count[i % 7];
+        batch[i] = newINTEGER(i % 7);
+        }
+    insertManyRBT(p,batch,20);
+    displayRBT(p,stdout);
+    statisticsRBT(p,stdout);
+    int sizes[] = { 1, 10, 1000, 100000, 50 };
+    for (round = 0; round < 5; ++round)
+        {
+        int n = sizes[round];
+        for (i = 0; i < n; ++i)
+            {
+            int k = random() % KEYS;
+            ++count[k];
+            batch[i] = newINTEGER(k);
+            }
+        insertManyRBT(p,batch,n);
+        printf("insert %6d",n);
+        check(p,"");
+        for (i = 0; i < n; ++i)
+            {
+            int k = random() % KEYS;
+            if (count[k] > 0) --count[k];
+            batch[i] = newINTEGER(k);
+            }
+        deleteManyRBT(p,batch,n);
+        for (i = 0; i < n; ++i) freeINTEGER(batch[i]);
+        printf("delete %6d",n);
+        check(p,"");
+        }
+    for (i = 0; i < KEYS; ++i)
+        {
+        if (count[i] > 0) --count[i];
+        batch[i] = newINTEGER(i);
+        }
+    deleteManyRBT(p,batch,KEYS);
+    for (i = 0; i < KEYS; ++i) freeINTEGER(batch[i]);
+    check(p,"delete every key once");
+    freeRBT(p);
+    return 0;
+    }
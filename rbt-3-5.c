@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gst.h"
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+#define KEYS 20000
+
+static long compares;
+
+static int
+counting(void *a,void *b)
+    {
+    ++compares;
+    return compareINTEGER(a,b);
+    }
+
+/* a nearly sorted stream: ascending, with one key in ten displaced by a
+ * few places and one in twenty repeated */
+static int
+stream(int i)
+    {
+    if (i % 10 == 3) return i - 1 - random() % 5;
+    if (i % 20 == 7) return i - 7;
+    return i;
+    }
+
+static int
+same(RBT *p,RBT *q)
+    {
+    FILE *fp = tmpfile(), *fq = tmpfile();
+    int c, d, result = 1;
+    displayRBT(p,fp);
+    displayRBT(q,fq);
+    rewind(fp);
+    rewind(fq);
+    do
+        {
+        c = fgetc(fp);
+        d = fgetc(fq);
+        if (c != d) result = 0;
+        }
+    while (c != EOF && d != EOF);
+    fclose(fp);
+    fclose(fq);
+    return result;
+    }
+
+int
+main(void)
+    {
+    printf("INTEGER test of RBT, hinted and finger insertion\n");
+    int i, keys[KEYS];
+    srandom(35);
+    for (i = 0; i < KEYS; ++i) keys[i] = stream(i);
+
+    RBT *p = newRBT(counting);
+    RBT *q = newRBT(counting);
+    RBT *r = newRBT(counting);
+    setRBTdisplay(p,displayINTEGER);
+    setRBTdisplay(q,displayINTEGER);
+    setRBTdisplay(r,displayINTEGER);
+    setRBTfree(p,freeINTEGER);
+    setRBTfree(q,freeINTEGER);
+    setRBTfree(r,freeINTEGER);
+    setRBTfinger(q,1);
+    compares = 0;
+    for (i = 0; i < KEYS; ++i) insertRBT(p,newINTEGER(keys[i]));
+    printf("from the root: %.1f comparisons per insert\n",(double)compares / KEYS);
+    compares = 0;
+    for (i = 0; i < KEYS; ++i) insertRBT(q,newINTEGER(keys[i]));
+    printf("finger mode:   %.1f comparisons per insert\n",(double)compares / KEYS);
+    TNODE *hint = 0;
+    compares = 0;
+    for (i = 0; i < KEYS; ++i)
+        {
+        TNODE *n = insertRBThint(r,hint,newINTEGER(keys[i]));
+        if (n) hint = n;
+        }
+    printf("hinted:        %.1f comparisons per insert\n",(double)compares / KEYS);
+    printf("same trees? %s\n",same(p,q) && same(p,r) ? "yes" : "no");
+    statisticsRBT(q,stdout);
+
+    /* deletes drop the finger; inserts after them must still land right */
+    for (i = 0; i < KEYS; i += 3)
+        {
+        INTEGER *a = newINTEGER(random() % KEYS);
+        INTEGER *x = findRBT(p,a);
+        if (x)
+            {
+            INTEGER *y = findRBT(q,a);
+            if (freqRBT(p,a) == 1)
+                {
+                deleteRBT(p,a);
+                deleteRBT(q,a);
+                freeINTEGER(x);
+                freeINTEGER(y);
+                }
+            else
+                {
+                deleteRBT(p,a);
+                deleteRBT(q,a);
+                }
+            }
+        freeINTEGER(a);
+        int k = KEYS + i;
+        insertRBT(p,newINTEGER(k));
+        insertRBT(q,newINTEGER(k));
+        }
+    printf("after mixed deletes and inserts, same trees? %s\n",
+        same(p,q) ? "yes" : "no");
+    statisticsRBT(q,stdout);
+    freeRBT(p);
+    freeRBT(q);
+    freeRBT(r);
+
+    /* a GST fed a descending stream through its finger */
+    GST *g = newGST(counting);
+    setGSTfree(g,freeINTEGER);
+    setGSTfinger(g,1);
+    compares = 0;
+    for (i = KEYS / 4 - 1; i >= 0; --i) insertGST(g,newINTEGER(keys[i]));
+    printf("GST, descending, finger mode: %.1f comparisons per insert\n",
+        (double)compares / (KEYS / 4));
+    statisticsGST(g,stdout);
+    freeGST(g);
+    return 0;
+    }
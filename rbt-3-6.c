@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gst.h"
+#include "rbt.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* records compare by key alone, so equal keys are duplicates whose
+ * payloads, told apart by id, must all survive in multiset mode */
+
+#define KEYS 100
+#define RECORDS 5000
+
+typedef struct rec
+    {
+    int key;
+    int id;
+    } REC;
+
+static int live;
+
+static REC *
+newREC(int key,int id)
+    {
+    REC *r = malloc(sizeof(REC));
+    r->key = key;
+    r->id = id;
+    ++live;
+    return r;
+    }
+
+static int
+compareREC(void *a,void *b)
+    {
+    return ((REC *)a)->key - ((REC *)b)->key;
+    }
+
+static void
+displayREC(void *a,FILE *fp)
+    {
+    fprintf(fp,"%d",((REC *)a)->key);
+    }
+
+static void
+freeREC(void *a)
+    {
+    --live;
+    free(a);
+    }
+
+/* counts the nodes whose instances are missing, out of insertion order
+ * or not the tree's to hold; ids rise with insertion time */
+static int
+check(RBT *p,int *instances)
+    {
+    int bad = 0;
+    TNODE *n;
+    *instances = 0;
+    for (n = firstRBT(p); n != 0; n = nextRBT(p,n))
+        {
+        int i, freq = nodeFreqGST(n);
+        *instances += freq;
+        if (instanceRBT(n,0) != unwrapRBT(n)) ++bad;
+        for (i = 0; i < freq; ++i)
+            {
+            REC *r = instanceRBT(n,i);
+            if (r->key != ((REC *)unwrapRBT(n))->key) ++bad;
+            if (i > 0 && r->id <= ((REC *)instanceRBT(n,i - 1))->id) ++bad;
+            }
+        }
+    return bad;
+    }
+
+static void
+report(RBT *p,const char *what)
+    {
+    int instances, bad = check(p,&instances);
+    printf("%s: size %d, instances %d, live records %d, bad nodes %d\n",
+        what,sizeRBT(p),instances,live,bad);
+    }
+
+static RBT *
+newTree(void)
+    {
+    RBT *p = newRBT(compareREC);
+    setRBTdisplay(p,displayREC);
+    setRBTfree(p,freeREC);
+    setRBTmultiset(p,1);
+    return p;
+    }
+
+int
+main(void)
+    {
+    srandom(36);
+    printf("record test of RBT and GST, multiset payloads\n");
+    int i, id = 0, misses = 0;
+    RBT *p = newTree();
+    for (i = 0; i < RECORDS; ++i)
+        insertRBT(p,newREC(random() % KEYS,id++));
+    report(p,"inserted");
+
+    REC probe;
+    for (i = 0; i < RECORDS / 2; ++i)
+        {
+        probe.key = random() % KEYS;
+        int freq = freqRBT(p,&probe);
+        TNODE *n = locateRBT(p,&probe);
+        REC *newest = n ? instanceRBT(n,freq - 1) : 0;
+        REC *r = popRBT(p,&probe);
+        if (r != newest || freqRBT(p,&probe) != (freq ? freq - 1 : 0)) ++misses;
+        if (r) freeREC(r);
+        }
+    printf("pops that missed the newest instance: %d\n",misses);
+    report(p,"popped");
+
+    for (i = 0; i < RECORDS / 4; ++i)
+        {
+        probe.key = random() % KEYS;
+        if (freqRBT(p,&probe) > 1) deleteRBT(p,&probe);
+        }
+    report(p,"deleted");
+
+    RBT *q = newTree();
+    void *batch[RECORDS];
+    for (i = 0; i < RECORDS; ++i)
+        batch[i] = newREC(random() % (2 * KEYS),id++);
+    insertManyRBT(q,batch,RECORDS);
+    report(q,"batch");
+    p = unionRBT(p,q);
+    report(p,"union");
+
+    q = newTree();
+    for (i = 0; i < KEYS; ++i)
+        insertRBT(q,newREC(i * 3,id++));
+    p = intersectionRBT(p,q);
+    report(p,"intersection");
+    freeRBT(p);
+    printf("live records after free: %d\n",live);
+
+    GST *g = newGST(compareREC);
+    setGSTdisplay(g,displayREC);
+    setGSTfree(g,freeREC);
+    setGSTmultiset(g,1);
+    for (i = 0; i < 10; ++i)
+        insertGST(g,newREC(i % 3,id++));
+    TNODE *n;
+    for (n = firstGST(g); n != 0; n = nextGST(g,n))
+        {
+        int j;
+        printf("key %d:",((REC *)unwrapGST(n))->key);
+        for (j = 0; j < nodeFreqGST(n); ++j)
+            printf(" %d",((REC *)instanceGST(n,j))->id - (id - 10));
+        printf("\n");
+        }
+    probe.key = 1;
+    REC *r = popGST(g,&probe);
+    printf("popped key %d id %d, %d left\n",r->key,r->id - (id - 10),
+        freqGST(g,&probe));
+    freeREC(r);
+    deleteGST(g,&probe);
+    displayGST(g,stdout);
+    printf("\n");
+    freeGST(g);
+    printf("live records after free: %d\n",live);
+    return 0;
+    }
@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gst.h"
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* an indexed and a plain tree take the same mix of updates, then every key
+ * is looked up in both */
+
+#define KEYS 3000
+
+static int
+differences(RBT *p,RBT *q)
+    {
+    int i, bad = 0;
+    int fp[KEYS], fq[KEYS];
+    INTEGER *keys[KEYS];
+    for (i = 0; i < KEYS; ++i)
+        {
+        keys[i] = newINTEGER(i);
+        if (freqRBT(p,keys[i]) != freqRBT(q,keys[i])) ++bad;
+        if ((findRBT(p,keys[i]) == 0) != (findRBT(q,keys[i]) == 0)) ++bad;
+        }
+    freqManyRBT(p,(void **)keys,KEYS,fp);
+    freqManyRBT(q,(void **)keys,KEYS,fq);
+    for (i = 0; i < KEYS; ++i)
+        {
+        if (fp[i] != fq[i]) ++bad;
+        freeINTEGER(keys[i]);
+        }
+    return bad;
+    }
+
+static RBT *
+newTree(int indexed)
+    {
+    RBT *p = newRBT(compareINTEGER);
+    setRBTdisplay(p,displayINTEGER);
+    setRBTfree(p,freeINTEGER);
+    if (indexed) setRBTindex(p,hashINTEGER);
+    return p;
+    }
+
+int
+main(void)
+    {
+    srandom(40);
+    printf("INTEGER test of RBT and GST, hash index\n");
+    int i, j;
+    RBT *p = newTree(1), *q = newTree(0);
+    for (i = 0; i < 4000; ++i)
+        {
+        j = random() % KEYS;
+        insertRBT(p,newINTEGER(j));
+        insertRBT(q,newINTEGER(j));
+        }
+    printf("after inserts: %d differences\n",differences(p,q));
+    for (i = 0; i < 3000; ++i)
+        {
+        INTEGER *a = newINTEGER(random() % KEYS);
+        INTEGER *x = findRBT(p,a), *y = findRBT(q,a);
+        int dp = deleteRBT(p,a), dq = deleteRBT(q,a);
+        if (dp != dq) printf("delete results differ\n");
+        if (dp == 0) { freeINTEGER(x); freeINTEGER(y); }
+        freeINTEGER(a);
+        }
+    printf("after deletes: %d differences\n",differences(p,q));
+
+    RBT *b = newTree(1), *c = newTree(0);
+    void *batch[2000], *copy[2000];
+    for (i = 0; i < 2000; ++i)
+        {
+        j = random() % KEYS;
+        batch[i] = newINTEGER(j);
+        copy[i] = newINTEGER(j);
+        }
+    insertManyRBT(b,batch,2000);
+    insertManyRBT(c,copy,2000);
+    p = unionRBT(p,b);
+    q = unionRBT(q,c);
+    printf("after a union: %d differences\n",differences(p,q));
+    for (i = 0; i < 100; ++i)
+        {
+        j = random() % KEYS;
+        insertRBT(p,newINTEGER(j));
+        insertRBT(q,newINTEGER(j));
+        INTEGER *a = newINTEGER(random() % KEYS);
+        INTEGER *x = popRBT(p,a), *y = popRBT(q,a);
+        // a popped value stays in the tree until its last instance goes
+        if (x && freqRBT(p,a) == 0) freeINTEGER(x);
+        if (y && freqRBT(q,a) == 0) freeINTEGER(y);
+        freeINTEGER(a);
+        }
+    printf("after inserts and pops: %d differences\n",differences(p,q));
+    b = newTree(1);
+    c = newTree(0);
+    INTEGER *pivot = newINTEGER(KEYS / 2);
+    splitRBT(p,pivot,b);
+    splitRBT(q,pivot,c);
+    printf("after a split: %d and %d differences\n",
+        differences(p,q),differences(b,c));
+    freeINTEGER(pivot);
+    printf("index bytes per key: %ld\n",
+        indexBytesRBT(p) / (sizeRBT(p) ? sizeRBT(p) : 1));
+    printf("plain tree index bytes: %ld\n",indexBytesRBT(q));
+    freeRBT(p);
+    freeRBT(q);
+    freeRBT(b);
+    freeRBT(c);
+
+    // an index set on a tree already holding values covers them too
+    p = newTree(0);
+    q = newTree(0);
+    for (i = 0; i < 2000; ++i)
+        {
+        j = random() % KEYS;
+        insertRBT(p,newINTEGER(j));
+        insertRBT(q,newINTEGER(j));
+        }
+    setRBTindex(p,hashINTEGER);
+    printf("indexed after inserts: %d differences\n",differences(p,q));
+    freeRBT(p);
+    freeRBT(q);
+
+    GST *g = newGST(compareINTEGER);
+    setGSTfree(g,freeINTEGER);
+    setGSTindex(g,hashINTEGER);
+    for (i = 0; i < 1000; ++i)
+        insertGST(g,newINTEGER(i % 300));
+    int bad = 0;
+    for (i = 0; i < 400; ++i)
+        {
+        INTEGER *a = newINTEGER(i);
+        if (freqGST(g,a) != (i < 300 ? (i < 100 ? 4 : 3) : 0)) ++bad;
+        if (i < 300 && getINTEGER(findGST(g,a)) != i) ++bad;
+        freeINTEGER(a);
+        }
+    printf("GST lookups wrong: %d\n",bad);
+    freeGST(g);
+    return 0;
+    }
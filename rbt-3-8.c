@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gst.h"
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* a filtered and a plain tree take the same mix of updates, then keys, most
+ * of them absent, are looked up in both */
+
+#define KEYS 3000
+#define PROBES 30000
+#define GROWN 100000
+
+static int
+differences(RBT *p,RBT *q)
+    {
+    int i, bad = 0;
+    static int fp[PROBES], fq[PROBES];
+    static INTEGER *keys[PROBES];
+    for (i = 0; i < PROBES; ++i)
+        {
+        keys[i] = newINTEGER(i % 10 ? KEYS + random() % (100 * KEYS) : i / 10);
+        if (freqRBT(p,keys[i]) != freqRBT(q,keys[i])) ++bad;
+        if ((findRBT(p,keys[i]) == 0) != (findRBT(q,keys[i]) == 0)) ++bad;
+        }
+    freqManyRBT(p,(void **)keys,PROBES,fp);
+    freqManyRBT(q,(void **)keys,PROBES,fq);
+    for (i = 0; i < PROBES; ++i)
+        {
+        if (fp[i] != fq[i]) ++bad;
+        freeINTEGER(keys[i]);
+        }
+    return bad;
+    }
+
+static RBT *
+newTree(int filtered)
+    {
+    RBT *p = newRBT(compareINTEGER);
+    setRBTdisplay(p,displayINTEGER);
+    setRBTfree(p,freeINTEGER);
+    if (filtered) setRBTfilter(p,hashINTEGER);
+    return p;
+    }
+
+int
+main(void)
+    {
+    srandom(42);
+    printf("INTEGER test of RBT and GST, filter for absent keys\n");
+    int i, j;
+    RBT *p = newTree(1), *q = newTree(0);
+    for (i = 0; i < 4000; ++i)
+        {
+        j = random() % KEYS;
+        insertRBT(p,newINTEGER(j));
+        insertRBT(q,newINTEGER(j));
+        }
+    printf("after inserts: %d differences\n",differences(p,q));
+    for (i = 0; i < 3000; ++i)
+        {
+        INTEGER *a = newINTEGER(random() % (2 * KEYS));
+        INTEGER *x = findRBT(p,a), *y = findRBT(q,a);
+        int dp = deleteRBT(p,a), dq = deleteRBT(q,a);
+        if (dp != dq) printf("delete results differ\n");
+        if (dp == 0) { freeINTEGER(x); freeINTEGER(y); }
+        freeINTEGER(a);
+        }
+    printf("after deletes: %d differences\n",differences(p,q));
+
+    RBT *b = newTree(1), *c = newTree(0);
+    void *batch[2000], *copy[2000];
+    for (i = 0; i < 2000; ++i)
+        {
+        j = random() % KEYS;
+        batch[i] = newINTEGER(j);
+        copy[i] = newINTEGER(j);
+        }
+    insertManyRBT(b,batch,2000);
+    insertManyRBT(c,copy,2000);
+    p = unionRBT(p,b);
+    q = unionRBT(q,c);
+    printf("after a union: %d differences\n",differences(p,q));
+    b = newTree(1);
+    c = newTree(0);
+    INTEGER *pivot = newINTEGER(KEYS / 2);
+    splitRBT(p,pivot,b);
+    splitRBT(q,pivot,c);
+    printf("after a split: %d and %d differences\n",
+        differences(p,q),differences(b,c));
+    freeINTEGER(pivot);
+    statisticsRBT(p,stdout);
+    freeRBT(b);
+    freeRBT(c);
+
+    // a filter set on a full tree, beside an index
+    b = newTree(0);
+    c = newTree(0);
+    for (i = 0; i < 2 * KEYS; ++i)
+        {
+        insertRBT(b,newINTEGER(i / 2));
+        insertRBT(c,newINTEGER(i / 2));
+        }
+    setRBTindex(b,hashINTEGER);
+    setRBTfilter(b,hashINTEGER);
+    printf("filter set late: %d differences\n",differences(b,c));
+    freeRBT(b);
+    freeRBT(c);
+    freeRBT(p);
+    freeRBT(q);
+
+    GST *g = newGST(compareINTEGER);
+    setGSTfree(g,freeINTEGER);
+    setGSTfilter(g,hashINTEGER);
+    int bad = 0;
+    for (i = 0; i < GROWN; ++i)
+        {
+        // even keys in a scattered order; odd keys are never inserted
+        insertGST(g,newINTEGER(2 * (i * 7919L % GROWN)));
+        j = random() % (i + 1);
+        INTEGER *a = newINTEGER(2 * (j * 7919L % GROWN) + random() % 2);
+        if (freqGST(g,a) != 1 - getINTEGER(a) % 2) ++bad;
+        freeINTEGER(a);
+        }
+    printf("GST lookups wrong while growing: %d\n",bad);
+    statisticsGST(g,stdout);
+    freeGST(g);
+    return 0;
+    }
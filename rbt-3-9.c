@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gst.h"
+#include "rbt.h"
+#include "integer.h"
+
+void srandom(unsigned int);
+long int random(void);
+
+/* a cached and a plain tree take the same updates between bursts of
+ * lookups of a few hot keys, then are compared key by key */
+
+#define KEYS 3000
+#define ROUNDS 400
+#define HOT 16
+
+// a burst of lookups of HOT keys, then an update to one of them
+static int
+burst(RBT *p,RBT *q)
+    {
+    int i, bad = 0, hot[HOT];
+    for (i = 0; i < HOT; ++i) hot[i] = random() % KEYS;
+    for (i = 0; i < 20 * HOT; ++i)
+        {
+        INTEGER *a = newINTEGER(hot[random() % HOT]);
+        if (freqRBT(p,a) != freqRBT(q,a)) ++bad;
+        if ((findRBT(p,a) == 0) != (findRBT(q,a) == 0)) ++bad;
+        freeINTEGER(a);
+        }
+    INTEGER *a = newINTEGER(hot[0]);
+    if (random() % 2)
+        {
+        INTEGER *x = findRBT(p,a), *y = findRBT(q,a);
+        int dp = deleteRBT(p,a), dq = deleteRBT(q,a);
+        if (dp != dq) ++bad;
+        if (dp == 0) { freeINTEGER(x); freeINTEGER(y); }
+        }
+    else
+        {
+        insertRBT(p,newINTEGER(hot[0]));
+        insertRBT(q,newINTEGER(hot[0]));
+        }
+    if (freqRBT(p,a) != freqRBT(q,a)) ++bad;
+    freeINTEGER(a);
+    return bad;
+    }
+
+static int
+differences(RBT *p,RBT *q)
+    {
+    int i, bad = 0;
+    for (i = 0; i < KEYS; ++i)
+        {
+        INTEGER *a = newINTEGER(i);
+        if (freqRBT(p,a) != freqRBT(q,a)) ++bad;
+        freeINTEGER(a);
+        }
+    return bad;
+    }
+
+static RBT *
+newTree(int cached)
+    {
+    RBT *p = newRBT(compareINTEGER);
+    setRBTdisplay(p,displayINTEGER);
+    setRBTfree(p,freeINTEGER);
+    if (cached) setRBTcache(p,64,hashINTEGER);
+    return p;
+    }
+
+int
+main(void)
+    {
+    srandom(43);
+    printf("INTEGER test of RBT and GST, lookup cache\n");
+    int i, j, bad = 0;
+    RBT *p = newTree(1), *q = newTree(0);
+    for (i = 0; i < 4000; ++i)
+        {
+        j = random() % KEYS;
+        insertRBT(p,newINTEGER(j));
+        insertRBT(q,newINTEGER(j));
+        }
+    for (i = 0; i < ROUNDS; ++i) bad += burst(p,q);
+    printf("bursts: %d differences\n",bad);
+    printf("after bursts: %d differences\n",differences(p,q));
+
+    RBT *b = newTree(1), *c = newTree(0);
+    for (i = 0; i < 2000; ++i)
+        {
+        j = random() % KEYS;
+        insertRBT(b,newINTEGER(j));
+        insertRBT(c,newINTEGER(j));
+        }
+    p = intersectionRBT(p,b);
+    q = intersectionRBT(q,c);
+    printf("after an intersection: %d differences\n",differences(p,q));
+    for (bad = i = 0; i < ROUNDS / 4; ++i) bad += burst(p,q);
+    printf("bursts: %d differences\n",bad);
+    statisticsRBT(p,stdout);
+    freeRBT(p);
+    freeRBT(q);
+
+    GST *g = newGST(compareINTEGER);
+    setGSTfree(g,freeINTEGER);
+    setGSTmultiset(g,1);
+    setGSTcache(g,8,hashINTEGER);
+    for (i = 0; i < 10; ++i) insertGST(g,newINTEGER(i % 3));
+    INTEGER *a = newINTEGER(1);
+    printf("freq of 1: %d",freqGST(g,a));
+    freeINTEGER(popGST(g,a));
+    printf(", after a pop: %d",freqGST(g,a));
+    deleteGST(g,a);
+    INTEGER *x = findGST(g,a);
+    deleteGST(g,a);
+    freeINTEGER(x);
+    printf(", after two deletes: %d\n",freqGST(g,a));
+    freeINTEGER(a);
+    statisticsGST(g,stdout);
+    freeGST(g);
+    return 0;
+    }
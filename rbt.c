@@ -8,26 +8,49 @@
  #include "gst.h"
  #include "rbt.h"
  #include "tnode.h"
+ #include "mapped.h"
 
  typedef struct rbtval RBTVAL;
 
+ // keys wrapped per call to locateManyGST
+ #define BATCH 64
+
+ // batches under 1/FOLD of the tree's size are applied value by value
+ #define FOLD 16
+
+ // the first bytes of an RBT's snapshot, so a GST's is not taken for one
+ #define SNAPSHOT "RBT\001"
+
  struct rbt {
    GST * tree;
    int (*compare)(void * one, void * two);
    void (*display)(void * ptr, FILE *fp);
    void (*swap)(TNODE * one, TNODE * two);
    void (*freeMethod)(void * ptr);
+   unsigned long (*hash)(void * ptr);
  };
 
+ // the tree and value codec of saveRBT and loadRBT
+ typedef struct coded {
+   RBT * t;
+   void (*put)(void * value, FILE *fp);
+   void *(*get)(FILE *fp);
+ } CODED;
+
  struct rbtval {
    void * value;
    int color;
    int (*compare)(void * one, void * two);
    void (*display)(void * ptr, FILE *fp);
    void (*freeMethod)(void * ptr);
+   unsigned long (*hash)(void * ptr);
  };
 
  static RBTVAL *newRBTVAL(RBT *t, void *v);
+ static unsigned long hashRBTVAL(RBTVAL *v);
+ static void setRBThash(RBT *t, unsigned long (*h)(void * ptr));
+ static void putRBTVAL(void *v, FILE *fp, void *arg);
+ static void *getRBTVAL(FILE *fp, void *arg);
 
  static TNODE *grandparent(TNODE *n);
  static TNODE *parent(TNODE *n);
@@ -55,6 +78,12 @@
  static void setColor(RBTVAL *v, int c);
  static void rightRotate(GST *tree, TNODE *n);
  static void leftRotate(GST *tree, TNODE * n);
+ static TNODE *joinRBTNodes(GST *g, TNODE *l, TNODE *k, TNODE *r);
+ static TNODE *joinSpine(GST *g, TNODE *big, TNODE *k, TNODE *small,
+     int height, int right);
+ static TNODE *child(TNODE *n, int right);
+ static int blackHeight(TNODE *n);
+ static void blackenRoot(RBT *t);
 
  extern RBT * newRBT(int (*c)(void * x, void * y)) {
    RBT * t = malloc(sizeof(RBT));
@@ -63,7 +92,9 @@
    t->display = 0;
    t->compare = c;
    t->freeMethod = 0;
+   t->hash = 0;
    setRBTswapper(t, (void *)swapRBTVals);
+   setGSTjoiner(t->tree, joinRBTNodes);
 
    return t;
  }
@@ -76,6 +107,7 @@
    v->display = t->display;
    v->compare = t->compare;
    v->freeMethod = t->freeMethod;
+   v->hash = t->hash;
 
    return v;
  }
@@ -114,6 +146,15 @@
    setGSTsize(tree, s);
  }
 
+ /* in relink mode a node handed out by insertRBT or locateRBT keeps its
+ * value until that value is deleted; deletion walks the node itself, rather
+ * than its value, down to a leaf before the fixup
+ */
+ extern void setRBTrelink(RBT *t, int on) {
+   GST * tree = t->tree;
+   setGSTrelink(tree, on);
+ }
+
  extern TNODE * insertRBT(RBT *t, void *value) {
    RBTVAL * newVal = newRBTVAL(t, value);
    GST * tree = t->tree;
@@ -124,22 +165,38 @@
    return temp;
  }
 
- extern void * findRBT(RBT *t, void *value) {
+ // inserts value, starting the search from hint; see insertGSThint
+ extern TNODE *insertRBThint(RBT *t, TNODE *hint, void *value) {
    RBTVAL * newVal = newRBTVAL(t, value);
-   TNODE * n = findRBTNode(t, newVal);
-   if (n == 0) {
-     free(newVal);
-     return 0;
+   GST * tree = t->tree;
+   TNODE * temp = insertGSThint(tree, hint, newVal);
+   if (temp) {
+     insertionFixUp(tree, temp);
    }
-   void * val = unwrapRBT(n);
-   free(newVal);
-   return val;
+   return temp;
+ }
+
+ /* in finger mode inserts start from the last node touched; rotations
+ * move nodes rather than values, so the finger survives the fixups
+ */
+ extern void setRBTfinger(RBT *t, int on) {
+   GST * tree = t->tree;
+   setGSTfinger(tree, on);
+ }
+
+ extern void * findRBT(RBT *t, void *value) {
+   RBTVAL probe;
+   probe.value = value;
+   probe.compare = t->compare;
+   probe.hash = t->hash;
+   RBTVAL * stored = findGST(t->tree, &probe);
+   return stored ? stored->value : 0;
  }
 
  extern TNODE *locateRBT(RBT *t, void *key) {
    RBTVAL * v = newRBTVAL(t, key);
    GST * tree = t->tree;
-   TNODE * ptr = locateGST(tree, key);
+   TNODE * ptr = locateGST(tree, v);
    free(v);
    return ptr;
  }
@@ -209,17 +266,23 @@
    free(t);
  }
 
+ extern void depthsRBT(RBT *t, FILE *fp) {
+   GST * tree = t->tree;
+   depthsGST(tree, fp);
+ }
+
  extern void * unwrapRBT(TNODE *n) {
    RBTVAL *rVal = (RBTVAL *)unwrapGST(n);
    return rVal->value;
  }
 
  extern int freqRBT(RBT *g, void *key) {
-   RBTVAL * newVal = newRBTVAL(g, key);
+   RBTVAL probe;
+   probe.value = key;
+   probe.compare = g->compare;
+   probe.hash = g->hash;
    GST * tree = g->tree;
-   int freq = freqGST(tree, newVal);
-   free(newVal);
-   return freq;
+   return freqGST(tree, &probe);
  }
 
  extern int duplicatesRBT(RBT *g) {
@@ -227,6 +290,308 @@
    return duplicatesGST(tree);
  }
 
+ // see setGSTmultiset; the payloads kept are the values inserted
+ extern void setRBTmultiset(RBT *t, int on) {
+   GST * tree = t->tree;
+   setGSTmultiset(tree, on);
+ }
+
+ // see popGST; a node's last instance leaves with a full RB delete
+ extern void *popRBT(RBT *t, void *key) {
+   GST * tree = t->tree;
+   RBTVAL * probe = newRBTVAL(t, key);
+   TNODE * n = findRBTNode(t, probe);
+   if (n == 0) {
+     free(probe);
+     return 0;
+   }
+   void * value = unwrapRBT(n);
+   if (nodeFreqGST(n) == 1) {
+     free(probe);
+     deleteRBT(t, key);
+     return value;
+   }
+   RBTVAL * v = popGST(tree, probe);
+   free(probe);
+   if (v != unwrapGST(n)) {
+     value = v->value;
+     free(v);
+   }
+   return value;
+ }
+
+ extern void *instanceRBT(TNODE *n, int i) {
+   RBTVAL * v = instanceGST(n, i);
+   return v->value;
+ }
+
+ // see setGSTindex; rotations move nodes, not values, so they cost it nothing
+ extern void setRBTindex(RBT *t, unsigned long (*h)(void * ptr)) {
+   setRBThash(t, h);
+   setGSTindex(t->tree, (void *)hashRBTVAL);
+ }
+
+ // see setGSTfilter; absent keys are turned away before any descent
+ extern void setRBTfilter(RBT *t, unsigned long (*h)(void * ptr)) {
+   setRBThash(t, h);
+   setGSTfilter(t->tree, (void *)hashRBTVAL);
+ }
+
+ // see setGSTcache; findRBT and freqRBT answer repeated keys from it
+ extern void setRBTcache(RBT *t, int entries,
+     unsigned long (*h)(void * ptr)) {
+   setRBThash(t, h);
+   setGSTcache(t->tree, entries, (void *)hashRBTVAL);
+ }
+
+ extern long indexBytesRBT(RBT *t) {
+   return indexBytesGST(t->tree);
+ }
+
+ // see publishGST; only keys and counts are published, not colors or shape
+ extern int publishRBT(RBT *t, char *path, char *(*text)(void * value)) {
+   int n = sizeRBT(t), i = 0;
+   char ** keys = malloc(sizeof(char *) * (n + 1));
+   int * freqs = malloc(sizeof(int) * (n + 1));
+   for (TNODE * at = firstRBT(t); at; at = nextRBT(t, at)) {
+     keys[i] = text(unwrapRBT(at));
+     freqs[i++] = nodeFreqGST(at);
+   }
+   int result = writeMAPPED(path, keys, freqs, n);
+   free(keys);
+   free(freqs);
+   return result;
+ }
+
+ // see saveGST; each node's color is saved with its value
+ extern int saveRBT(RBT *t, char *path, void (*put)(void * value, FILE *fp)) {
+   CODED codec = { t, put, 0 };
+   return saveGSTwith(t->tree, path, SNAPSHOT, putRBTVAL, &codec);
+ }
+
+ /* see loadGST; the colors come back with the shape, so the tree needs no
+ * fixing up; t must be empty, with its compare and free methods set
+ */
+ extern int loadRBT(RBT *t, char *path, void *(*get)(FILE *fp)) {
+   CODED codec = { t, 0, get };
+   return loadGSTwith(t->tree, path, SNAPSHOT, getRBTVAL, &codec);
+ }
+
+ // see topKGST; unwrap the results with unwrapRBT
+ extern int topKRBT(RBT *t, int k, TNODE **results) {
+   GST * tree = t->tree;
+   return topKGST(tree, k, results);
+ }
+
+ /* join and split are the GST's, run with the red-black joiner, so each
+ * costs O(log n) and the set operations are work-optimal; see unionGST
+ */
+ extern RBT *joinRBT(RBT *left, void *pivot, RBT *right) {
+   joinGST(left->tree, newRBTVAL(left, pivot), right->tree);
+   free(right);
+   blackenRoot(left);
+   return left;
+ }
+
+ extern void splitRBT(RBT *t, void *key, RBT *right) {
+   RBTVAL probe;
+   probe.value = key;
+   splitGST(t->tree, &probe, right->tree);
+   blackenRoot(t);
+   blackenRoot(right);
+ }
+
+ extern RBT *unionRBT(RBT *a, RBT *b) {
+   unionGST(a->tree, b->tree);
+   free(b);
+   blackenRoot(a);
+   return a;
+ }
+
+ extern RBT *intersectionRBT(RBT *a, RBT *b) {
+   intersectionGST(a->tree, b->tree);
+   free(b);
+   blackenRoot(a);
+   return a;
+ }
+
+ extern RBT *differenceRBT(RBT *a, RBT *b) {
+   differenceGST(a->tree, b->tree);
+   free(b);
+   blackenRoot(a);
+   return a;
+ }
+
+ /* like insertManyGST and deleteManyGST, which do the work for big
+ * batches; a small batch is sorted here and applied value by value, with
+ * the usual fixups
+ */
+ extern void insertManyRBT(RBT *t, void **values, int n) {
+   GST * tree = t->tree;
+   void ** wrapped = malloc(sizeof(void *) * (n + 1));
+   assert(wrapped != NULL);
+   for (int i = 0; i < n; ++i) {
+     wrapped[i] = newRBTVAL(t, values[i]);
+   }
+   if (n < sizeRBT(t) / FOLD) {
+     sortGST(tree, wrapped, n);
+     for (int i = 0; i < n; ++i) {
+       TNODE * temp = insertGST(tree, wrapped[i]);
+       if (temp) {
+         insertionFixUp(tree, temp);
+       }
+     }
+   }
+   else {
+     insertManyGST(tree, wrapped, n);
+     blackenRoot(t);
+   }
+   free(wrapped);
+ }
+
+ extern void deleteManyRBT(RBT *t, void **keys, int n) {
+   RBTVAL * probe = malloc(sizeof(RBTVAL) * (n + 1));
+   void ** wrapped = malloc(sizeof(void *) * (n + 1));
+   assert(probe != NULL && wrapped != NULL);
+   for (int i = 0; i < n; ++i) {
+     probe[i].value = keys[i];
+     probe[i].compare = t->compare;
+     wrapped[i] = &probe[i];
+   }
+   if (n < sizeRBT(t) / FOLD) {
+     sortGST(t->tree, wrapped, n);
+     for (int i = 0; i < n; ++i) {
+       void * key = ((RBTVAL *)wrapped[i])->value;
+       void * stored = findRBT(t, key);
+       if (deleteRBT(t, key) == 0 && t->freeMethod) {
+         t->freeMethod(stored);
+       }
+     }
+   }
+   else {
+     deleteManyGST(t->tree, wrapped, n);
+     blackenRoot(t);
+   }
+   free(wrapped);
+   free(probe);
+ }
+
+ // see setGSTpool
+ extern void setRBTpool(RBT *t, POOL *p) {
+   setGSTpool(t->tree, p);
+ }
+
+ // merges trees[1] to trees[n-1] into trees[0] and frees them; see mergeGST
+ extern RBT *mergeRBT(RBT **trees, int n) {
+   GST ** inner = malloc(sizeof(GST *) * n);
+   assert(inner != NULL);
+   for (int i = 0; i < n; ++i) {
+     inner[i] = trees[i]->tree;
+   }
+   mergeGST(inner, n);
+   for (int i = 1; i < n; ++i) {
+     free(trees[i]);
+   }
+   free(inner);
+   blackenRoot(trees[0]);
+   return trees[0];
+ }
+
+ /* cursors and point queries delegate to the underlying GST
+ * keys are wrapped in an RBTVAL on the stack so no step allocates
+ */
+ extern TNODE *firstRBT(RBT *t) {
+   return firstGST(t->tree);
+ }
+
+ extern TNODE *lastRBT(RBT *t) {
+   return lastGST(t->tree);
+ }
+
+ extern TNODE *nextRBT(RBT *t, TNODE *n) {
+   return nextGST(t->tree, n);
+ }
+
+ extern TNODE *prevRBT(RBT *t, TNODE *n) {
+   return prevGST(t->tree, n);
+ }
+
+ extern TNODE *seekRBT(RBT *t, void *key) {
+   RBTVAL probe;
+   probe.value = key;
+   return seekGST(t->tree, &probe);
+ }
+
+ extern TNODE *floorRBT(RBT *t, void *key) {
+   RBTVAL probe;
+   probe.value = key;
+   return floorGST(t->tree, &probe);
+ }
+
+ extern TNODE *ceilingRBT(RBT *t, void *key) {
+   RBTVAL probe;
+   probe.value = key;
+   return ceilingGST(t->tree, &probe);
+ }
+
+ extern TNODE *predecessorRBT(RBT *t, void *key) {
+   RBTVAL probe;
+   probe.value = key;
+   return predecessorGST(t->tree, &probe);
+ }
+
+ extern TNODE *successorRBT(RBT *t, void *key) {
+   RBTVAL probe;
+   probe.value = key;
+   return successorGST(t->tree, &probe);
+ }
+
+ extern int rangeRBT(RBT *t, void *lo, void *hi,
+     void (*f)(TNODE *n, void *arg), void *arg) {
+   RBTVAL low, high;
+   low.value = lo;
+   high.value = hi;
+   return rangeGST(t->tree, &low, &high, f, arg);
+ }
+
+ // wraps the keys a batch at a time on the stack and hands them to the GST
+ extern void locateManyRBT(RBT *t, void **keys, int n, TNODE **results) {
+   RBTVAL probe[BATCH];
+   void * wrapped[BATCH];
+   for (int base = 0; base < n; base += BATCH) {
+     int count = n - base < BATCH ? n - base : BATCH;
+     for (int i = 0; i < count; ++i) {
+       probe[i].value = keys[base + i];
+       wrapped[i] = &probe[i];
+     }
+     locateManyGST(t->tree, wrapped, count, results + base);
+   }
+ }
+
+ extern void findManyRBT(RBT *t, void **keys, int n, void **results) {
+   locateManyRBT(t, keys, n, (TNODE **)results);
+   for (int i = 0; i < n; ++i) {
+     if (results[i]) {
+       results[i] = unwrapRBT(results[i]);
+     }
+   }
+ }
+
+ extern void freqManyRBT(RBT *t, void **keys, int n, int *results) {
+   RBTVAL probe[BATCH];
+   void * wrapped[BATCH];
+   for (int base = 0; base < n; base += BATCH) {
+     int count = n - base < BATCH ? n - base : BATCH;
+     for (int i = 0; i < count; ++i) {
+       probe[i].value = keys[base + i];
+       probe[i].compare = t->compare;
+       probe[i].hash = t->hash;
+       wrapped[i] = &probe[i];
+     }
+     freqManyGST(t->tree, wrapped, count, results + base);
+   }
+ }
+
  static void swapRBTVals(TNODE *a, TNODE *b) {
    void *va = getTNODEvalue(a);
    void *vb = getTNODEvalue(b);
@@ -422,7 +787,7 @@
 
    setTNODEright(n, oldParent);
    setTNODEparent(oldParent, n);
-
+   refreshGST(tree, oldParent);
  }
 
  static void leftRotate(GST *tree, TNODE *n) {
@@ -448,6 +813,113 @@
    }
    setTNODEleft(n, oldParent);
    setTNODEparent(oldParent, n);
+   refreshGST(tree, oldParent);
+ }
+
+ /* joins red-black subtrees l < k < r; after blackening both roots, k goes
+ * red in place of the first black node of matching black height on the
+ * facing spine of the taller tree, and red-red pairs left on the way up are
+ * fixed with a recolor and a rotation, as in Blelloch, Ferizovic and Sun
+ */
+ static TNODE *joinRBTNodes(GST *g, TNODE *l, TNODE *k, TNODE *r) {
+   if (l) {
+     colorBlack(l);
+   }
+   if (r) {
+     colorBlack(r);
+   }
+   int hl = blackHeight(l);
+   int hr = blackHeight(r);
+   if (hl > hr) {
+     return joinSpine(g, l, k, r, hr, 1);
+   }
+   if (hr > hl) {
+     return joinSpine(g, r, k, l, hl, 0);
+   }
+   colorRed(k);
+   setTNODEleft(k, l);
+   setTNODEright(k, r);
+   if (l) {
+     setTNODEparent(l, k);
+   }
+   if (r) {
+     setTNODEparent(r, k);
+   }
+   setTNODEparent(k, k);
+   updateGST(g, k);
+   return k;
+ }
+
+ // joins the shorter tree small onto the right (or left) spine of big
+ static TNODE *joinSpine(GST *g, TNODE *big, TNODE *k, TNODE *small,
+     int height, int right) {
+   TNODE * at = big;
+   TNODE * top = 0;
+   int h = blackHeight(big);
+   while (at && (isRed(at) || h > height)) {
+     if (!isRed(at)) {
+       --h;
+     }
+     top = at;
+     at = child(at, right);
+   }
+   colorRed(k);
+   setTNODEleft(k, right ? at : small);
+   setTNODEright(k, right ? small : at);
+   if (at) {
+     setTNODEparent(at, k);
+   }
+   if (small) {
+     setTNODEparent(small, k);
+   }
+   setTNODEparent(k, top);
+   if (right) {
+     setTNODEright(top, k);
+   }
+   else {
+     setTNODEleft(top, k);
+   }
+   updateGST(g, k);
+   TNODE * n = top;
+   while (n) {
+     TNODE * up = parent(n) == n ? 0 : parent(n);
+     TNODE * c = child(n, right);
+     if (!isRed(n) && isRed(c) && isRed(child(c, right))) {
+       colorBlack(child(c, right));
+       n = rotateUpGST(g, c);
+     }
+     else {
+       updateGST(g, n);
+     }
+     top = n;
+     n = up;
+   }
+   if (isRed(top) && isRed(child(top, right))) {
+     colorBlack(top);
+   }
+   return top;
+ }
+
+ static TNODE *child(TNODE *n, int right) {
+   return right ? getTNODEright(n) : getTNODEleft(n);
+ }
+
+ // counts the black nodes down the left spine; null leaves count as 0
+ static int blackHeight(TNODE *n) {
+   int h = 0;
+   while (n) {
+     if (!isRed(n)) {
+       ++h;
+     }
+     n = getTNODEleft(n);
+   }
+   return h;
+ }
+
+ static void blackenRoot(RBT *t) {
+   if (sizeRBT(t) > 0) {
+     colorBlack(getRBTroot(t));
+   }
  }
 
  static int getColor(RBTVAL *v) {
@@ -571,3 +1043,32 @@
      return getTNODEleft(parent(n));
    }
  }
+
+ static unsigned long hashRBTVAL(RBTVAL *v) {
+   return v->hash(v->value);
+ }
+
+ static void putRBTVAL(void *v, FILE *fp, void *arg) {
+   fputc(getColor(v), fp);
+   ((CODED *)arg)->put(((RBTVAL *)v)->value, fp);
+ }
+
+ static void *getRBTVAL(FILE *fp, void *arg) {
+   CODED * codec = arg;
+   int color = fgetc(fp);
+   void * value = color == 0 || color == 1 ? codec->get(fp) : 0;
+   if (value == 0) {
+     return 0;
+   }
+   RBTVAL * v = newRBTVAL(codec->t, value);
+   setColor(v, color);
+   return v;
+ }
+
+ // gives h to t and to the values it already holds
+ static void setRBThash(RBT *t, unsigned long (*h)(void * ptr)) {
+   t->hash = h;
+   for (TNODE * n = firstRBT(t); n; n = nextRBT(t, n)) {
+     ((RBTVAL *)unwrapGST(n))->hash = h;
+   }
+ }
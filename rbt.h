@@ -5,6 +5,7 @@
 
 #include <stdio.h>
 #include "tnode.h"
+#include "pool.h"
 
 typedef struct rbt RBT;
 
@@ -15,7 +16,10 @@ extern void   setRBTfree(RBT *t,void (*)(void *));
 extern TNODE *getRBTroot(RBT *t);
 extern void   setRBTroot(RBT *t,TNODE *replacement);
 extern void   setRBTsize(RBT *t,int s);
+extern void   setRBTrelink(RBT *t,int on);
 extern TNODE *insertRBT(RBT *t,void *value);
+extern TNODE *insertRBThint(RBT *t,TNODE *hint,void *value);
+extern void   setRBTfinger(RBT *t,int on);
 extern void  *findRBT(RBT *t,void *key);
 extern TNODE *locateRBT(RBT *t,void *key);
 extern int    deleteRBT(RBT *t,void *key);
@@ -26,8 +30,49 @@ extern void   statisticsRBT(RBT *t,FILE *fp);
 extern void   displayRBT(RBT *t,FILE *fp);
 extern int    debugRBT(RBT *t,int level);
 extern void   freeRBT(RBT *t);
+extern void   depthsRBT(RBT *t,FILE *fp);
 extern void   *unwrapRBT(TNODE *n);
 extern int    freqRBT(RBT *g,void *key);
 extern int    duplicatesRBT(RBT *g);
+extern void   setRBTmultiset(RBT *t,int on);
+extern void  *popRBT(RBT *t,void *key);
+extern void  *instanceRBT(TNODE *n,int i);
+extern int    topKRBT(RBT *t,int k,TNODE **results);
+extern void   setRBTindex(RBT *t,unsigned long (*h)(void *));
+extern long   indexBytesRBT(RBT *t);
+extern void   setRBTfilter(RBT *t,unsigned long (*h)(void *));
+extern void   setRBTcache(RBT *t,int entries,unsigned long (*h)(void *));
+extern int    publishRBT(RBT *t,char *path,char *(*text)(void *));
+extern int    saveRBT(RBT *t,char *path,void (*put)(void *,FILE *));
+extern int    loadRBT(RBT *t,char *path,void *(*get)(FILE *));
+
+/* join-based set operations; b is consumed and the result left in a */
+extern RBT   *joinRBT(RBT *left,void *pivot,RBT *right);
+extern void   splitRBT(RBT *t,void *key,RBT *right);
+extern RBT   *unionRBT(RBT *a,RBT *b);
+extern RBT   *intersectionRBT(RBT *a,RBT *b);
+extern RBT   *differenceRBT(RBT *a,RBT *b);
+extern void   setRBTpool(RBT *t,POOL *p);
+extern RBT   *mergeRBT(RBT **trees,int n);
+extern void   insertManyRBT(RBT *t,void **values,int n);
+extern void   deleteManyRBT(RBT *t,void **keys,int n);
+
+/* batched lookups; results[i] answers keys[i] */
+extern void   locateManyRBT(RBT *t,void **keys,int n,TNODE **results);
+extern void   findManyRBT(RBT *t,void **keys,int n,void **results);
+extern void   freqManyRBT(RBT *t,void **keys,int n,int *results);
+
+/* ordered cursors and point queries; unwrap results with unwrapRBT */
+extern TNODE *firstRBT(RBT *t);
+extern TNODE *lastRBT(RBT *t);
+extern TNODE *nextRBT(RBT *t,TNODE *n);
+extern TNODE *prevRBT(RBT *t,TNODE *n);
+extern TNODE *seekRBT(RBT *t,void *key);
+extern TNODE *floorRBT(RBT *t,void *key);
+extern TNODE *ceilingRBT(RBT *t,void *key);
+extern TNODE *predecessorRBT(RBT *t,void *key);
+extern TNODE *successorRBT(RBT *t,void *key);
+extern int    rangeRBT(RBT *t,void *lo,void *hi,
+                void (*f)(TNODE *n,void *arg),void *arg);
 
 #endif /* rbt.h */
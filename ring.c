@@ -0,0 +1,99 @@
+/*File: ring.c
+ *Implements functions found in ring.h: a bounded ring buffer that passes
+ *items from one producing thread to one consuming thread without locks
+*/
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <sched.h>
+#include <time.h>
+#include "ring.h"
+
+// a cache line, so the two ends of a ring never share one
+#define LINE 64
+
+// a waiting thread yields this many times before it starts to nap
+#define SPINS 64
+
+// the longest nap, in nanoseconds, of a thread waiting on an idle ring
+#define NAP 1000000
+
+/* the producer alone writes tail and the consumer alone writes head, and
+* each reads the other's with acquire ordering, so an item stored before
+* tail moves past it is seen by the consumer whole; both count up without
+* wrapping and the slot is the count masked by the capacity, a power of 2;
+* a thread that finds the ring full or empty yields, then naps for spans
+* that double up to NAP, so an idle stream does not hold a CPU
+*/
+struct ring {
+  unsigned long head;
+  char padHead[LINE - sizeof(unsigned long)];
+  unsigned long tail;
+  char padTail[LINE - sizeof(unsigned long)];
+  unsigned long mask;
+  void **items;
+};
+
+static void idle(int *waits);
+
+// a ring of at least capacity slots
+extern RING *newRING(int capacity) {
+  RING *r = malloc(sizeof(RING));
+  assert(r != NULL);
+  unsigned long size = 1;
+  while (size < (unsigned long) capacity) {
+    size *= 2;
+  }
+  r->head = 0;
+  r->tail = 0;
+  r->mask = size - 1;
+  r->items = malloc(sizeof(void *) * size);
+  assert(r->items != NULL);
+  return r;
+}
+
+// called by the producer only; waits while the ring is full
+extern void putRING(RING *r, void *item) {
+  unsigned long tail = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+  int waits = 0;
+  while (tail - __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) > r->mask) {
+    idle(&waits);
+  }
+  r->items[tail & r->mask] = item;
+  __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+// called by the consumer only; waits while the ring is empty
+extern void *getRING(RING *r) {
+  unsigned long head = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+  int waits = 0;
+  while (__atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) == head) {
+    idle(&waits);
+  }
+  void *item = r->items[head & r->mask];
+  __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+  return item;
+}
+
+// called by the consumer only; the items it can take without waiting
+extern int readyRING(RING *r) {
+  return __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)
+      - __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+}
+
+// frees the ring, but not any items left in it
+extern void freeRING(RING *r) {
+  free(r->items);
+  free(r);
+}
+
+static void idle(int *waits) {
+  if (++*waits <= SPINS) {
+    sched_yield();
+    return;
+  }
+  long nap = 1000L << (*waits - SPINS < 10 ? *waits - SPINS : 10);
+  struct timespec t = { 0, nap < NAP ? nap : NAP };
+  nanosleep(&t, 0);
+}
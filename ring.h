@@ -0,0 +1,12 @@
+#ifndef __RING_INCLUDED__
+#define __RING_INCLUDED__
+
+typedef struct ring RING;
+
+extern RING *newRING(int capacity);
+extern void  putRING(RING *r,void *item);
+extern void *getRING(RING *r);
+extern int   readyRING(RING *r);
+extern void  freeRING(RING *r);
+
+#endif
@@ -45,6 +45,10 @@ static void *reallocateMsg(void *s,size_t size,char *where);
  *        the caller should free the returned string
  *      - returns 0 if end of file; feof will subsequently return true
  *      - usage example: char *x = readString(stdin);
+ *    readStringChecked(FILE *fp)
+ *      - as readString, but a malformed string is reported and 0 returned
+ *        rather than the program exited; feof then tells end of file apart
+ *      - usage example: char *x = readStringChecked(stdin);
  *    readLine(FILE *fp)
  *      - reads in a line or remainder of a line
  *      - returns a malloc'd string; the newline is not included
@@ -59,6 +63,7 @@ static void *reallocateMsg(void *s,size_t size,char *where);
 
 static void skipWhiteSpace(FILE *);
 static char convertEscapedChar(int);
+static char *scanString(FILE *,int *);
 
 /********** public functions **********************/
 
@@ -140,75 +145,17 @@ readRawChar(FILE *fp)
 char *
 readString(FILE *fp)
     {
-    int ch,index;
-    char *buffer;
-    int size = 512;
-
-    /* advance to the double quote */
-
-    skipWhiteSpace(fp);
-
-    if (feof(fp)) return 0;
-
-    ch = fgetc(fp);
-
-    if (ch == EOF) return 0;
-
-    /* allocate the buffer */
-
-    buffer = allocateMsg(size,"readString");
-
-    if (ch != '\"')
-        {
-        fprintf(stderr,"SCAN ERROR: attempt to read a string failed\n");
-        fprintf(stderr,"first character was <%c>\n",ch);
-        exit(4);
-        }
-
-    /* toss the double quote, skip to the next character */
-
-    ch = fgetc(fp);
-
-    /* initialize the buffer index */
-
-    index = 0;
-
-    /* collect characters until the closing double quote */
-
-    while (ch != '\"')
-        {
-        if (ch == EOF)
-            {
-            fprintf(stderr,"SCAN ERROR: attempt to read a string failed\n");
-            fprintf(stderr,"no closing double quote\n");
-            exit(6);
-            }
-        if (index > size - 2)
-            {
-            ++size;
-            buffer = reallocateMsg(buffer,size,"readString");
-            }
-
-        if (ch == '\\')
-            {
-            ch = fgetc(fp);
-            if (ch == EOF)
-                {
-                fprintf(stderr,"SCAN ERROR: attempt to read a string failed\n");
-                fprintf(stderr,"escaped character missing\n");
-                exit(6);
-                }
-            buffer[index] = convertEscapedChar(ch);
-            }
-        else
-            buffer[index] = ch;
-        ++index;
-        ch = fgetc(fp);
-        }
-
-    buffer[index] = '\0';
+    int failure;
+    char *s = scanString(fp,&failure);
+    if (failure) exit(failure);
+    return s;
+    }
 
-    return buffer;
+char *
+readStringChecked(FILE *fp)
+    {
+    int failure;
+    return scanString(fp,&failure);
     }
 
 char *
@@ -315,6 +262,93 @@ skipWhiteSpace(FILE *fp)
     if (ch != EOF) ungetc(ch,fp);
     }
 
+/* the body of readString; a malformed string is reported, its buffer
+ * freed and 0 returned, with *failure set to the exit status readString
+ * gives it; otherwise *failure is 0
+ */
+
+static char *
+scanString(FILE *fp,int *failure)
+    {
+    int ch,index;
+    char *buffer;
+    int size = 512;
+
+    *failure = 0;
+
+    /* advance to the double quote */
+
+    skipWhiteSpace(fp);
+
+    if (feof(fp)) return 0;
+
+    ch = fgetc(fp);
+
+    if (ch == EOF) return 0;
+
+    if (ch != '\"')
+        {
+        fprintf(stderr,"SCAN ERROR: attempt to read a string failed\n");
+        fprintf(stderr,"first character was <%c>\n",ch);
+        ungetc(ch,fp);
+        *failure = 4;
+        return 0;
+        }
+
+    /* allocate the buffer */
+
+    buffer = allocateMsg(size,"readString");
+
+    /* toss the double quote, skip to the next character */
+
+    ch = fgetc(fp);
+
+    /* initialize the buffer index */
+
+    index = 0;
+
+    /* collect characters until the closing double quote */
+
+    while (ch != '\"')
+        {
+        if (ch == EOF)
+            {
+            fprintf(stderr,"SCAN ERROR: attempt to read a string failed\n");
+            fprintf(stderr,"no closing double quote\n");
+            free(buffer);
+            *failure = 6;
+            return 0;
+            }
+        if (index > size - 2)
+            {
+            ++size;
+            buffer = reallocateMsg(buffer,size,"readString");
+            }
+
+        if (ch == '\\')
+            {
+            ch = fgetc(fp);
+            if (ch == EOF)
+                {
+                fprintf(stderr,"SCAN ERROR: attempt to read a string failed\n");
+                fprintf(stderr,"escaped character missing\n");
+                free(buffer);
+                *failure = 6;
+                return 0;
+                }
+            buffer[index] = convertEscapedChar(ch);
+            }
+        else
+            buffer[index] = ch;
+        ++index;
+        ch = fgetc(fp);
+        }
+
+    buffer[index] = '\0';
+
+    return buffer;
+    }
+
 static char
 convertEscapedChar(int ch)
     {
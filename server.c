@@ -0,0 +1,440 @@
+/*File: server.c
+ *Implements functions found in server.h: a Unix domain socket that many
+ *clients may send command streams to at once, each answered in turn by a
+ *single event loop, so the changes they make are applied in order
+*/
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "server.h"
+
+// the events taken from the kernel at a time
+#define EVENTS 64
+
+// the bytes read from, or written to, a socket at a time
+#define CHUNK 65536
+
+// a client that cannot be reached for this long is given up on
+#define PATIENCE 5000
+
+/* a client's bytes gather in its input until a whole command has come;
+* the commands are handed to serve together, and what serve writes waits
+* in the client's output until the socket takes it; a client that has
+* shut its side is closed once its output is gone
+*/
+typedef struct client {
+  int fd;
+  char *in;
+  long used;
+  long capacity;
+  char *out;
+  long sent;
+  long pending;
+  int closing;
+  int watching; // the events asked of epoll
+  struct client *prev;
+  struct client *next;
+} CLIENT;
+
+struct server {
+  char *path;
+  int listener;
+  int poller;
+  int served; // clients accepted in all
+  CLIENT *clients;
+};
+
+static volatile sig_atomic_t stopping = 0;
+
+static void stop(int signal);
+static int address(char *path, struct sockaddr_un *a);
+static void admit(SERVER *s);
+static int receive(CLIENT *c);
+static void answer(CLIENT *c, void (*serve)(FILE *, FILE *, void *),
+    void *arg);
+static long frame(char *text, long length, int closing);
+static int flush(SERVER *s, CLIENT *c);
+static void drop(SERVER *s, CLIENT *c);
+static int watch(SERVER *s, CLIENT *c, int events);
+
+/* binds a socket at path and listens on it; a socket left there by a run
+* that has gone is replaced, but one still answering is not; returns 0 if
+* the socket cannot be made
+*/
+extern SERVER *newSERVER(char *path) {
+  struct sockaddr_un a;
+  struct stat st;
+  if (address(path, &a) != 0) {
+    return 0;
+  }
+  if (lstat(path, &st) == 0) {
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    int live = probe >= 0 && S_ISSOCK(st.st_mode)
+        && connect(probe, (struct sockaddr *)&a, sizeof(a)) == 0;
+    if (probe >= 0) {
+      close(probe);
+    }
+    if (live || !S_ISSOCK(st.st_mode)) {
+      return 0;
+    }
+    unlink(path);
+  }
+  SERVER *s = malloc(sizeof(SERVER));
+  s->path = strcpy(malloc(strlen(path) + 1), path);
+  s->served = 0;
+  s->clients = 0;
+  s->poller = -1;
+  s->listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (s->listener < 0
+      || bind(s->listener, (struct sockaddr *)&a, sizeof(a)) != 0
+      || listen(s->listener, SOMAXCONN) != 0
+      || fcntl(s->listener, F_SETFL, O_NONBLOCK) != 0
+      || (s->poller = epoll_create1(0)) < 0) {
+    if (s->listener >= 0) {
+      close(s->listener);
+      unlink(path);
+    }
+    if (s->poller >= 0) {
+      close(s->poller);
+    }
+    free(s->path);
+    free(s);
+    return 0;
+  }
+  struct epoll_event e;
+  e.events = EPOLLIN;
+  e.data.ptr = 0;
+  epoll_ctl(s->poller, EPOLL_CTL_ADD, s->listener, &e);
+  return s;
+}
+
+/* answers clients until a SIGINT or SIGTERM comes; serve reads whole
+* commands from in and writes its answers to out, and is never called for
+* two clients at once; returns 0 once stopped, or -1 if the loop fails
+*/
+extern int runSERVER(SERVER *s, void (*serve)(FILE *in, FILE *out, void *arg),
+    void *arg) {
+  struct sigaction action, oldInt, oldTerm;
+  struct epoll_event events[EVENTS];
+  int result = 0;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = stop;
+  sigemptyset(&action.sa_mask);
+  // no SA_RESTART, so a signal ends the wait below
+  sigaction(SIGINT, &action, &oldInt);
+  sigaction(SIGTERM, &action, &oldTerm);
+  stopping = 0;
+  while (!stopping) {
+    int n = epoll_wait(s->poller, events, EVENTS, -1);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      result = -1;
+      break;
+    }
+    for (int i = 0; i < n; ++i) {
+      CLIENT *c = events[i].data.ptr;
+      if (c == 0) {
+        admit(s);
+        continue;
+      }
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        if (receive(c) != 0) {
+          drop(s, c);
+          continue;
+        }
+        answer(c, serve, arg);
+      }
+      if (flush(s, c) != 0) {
+        drop(s, c);
+      }
+    }
+  }
+  sigaction(SIGINT, &oldInt, 0);
+  sigaction(SIGTERM, &oldTerm, 0);
+  return result;
+}
+
+// the clients accepted since the server was made
+extern int clientsSERVER(SERVER *s) {
+  return s->served;
+}
+
+// closes every client, then the socket, which is removed
+extern void freeSERVER(SERVER *s) {
+  while (s->clients) {
+    drop(s, s->clients);
+  }
+  close(s->poller);
+  close(s->listener);
+  unlink(s->path);
+  free(s->path);
+  free(s);
+}
+
+/* sends what is in to the server at path and copies its answers to out
+* until it closes the connection; a server that is starting is waited for
+* a while; returns 0, or -1 if the server cannot be reached
+*/
+extern int talkSERVER(char *path, FILE *in, FILE *out) {
+  struct sockaddr_un a;
+  if (address(path, &a) != 0) {
+    return -1;
+  }
+  int fd = -1;
+  for (int waited = 0; fd < 0 && waited < PATIENCE; waited += 10) {
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr *)&a, sizeof(a)) != 0) {
+      close(fd);
+      fd = -1;
+      poll(0, 0, 10);
+    }
+  }
+  if (fd < 0) {
+    return -1;
+  }
+  // sends and receives together, so neither side waits on a full buffer
+  char *buffer = malloc(CHUNK), *reply = malloc(CHUNK);
+  long held = 0, at = 0;
+  int sending = 1, result = 0;
+  for (;;) {
+    struct pollfd p;
+    if (sending && at == held) {
+      held = fread(buffer, 1, CHUNK, in);
+      at = 0;
+      if (held == 0) {
+        shutdown(fd, SHUT_WR);
+        sending = 0;
+      }
+    }
+    p.fd = fd;
+    p.events = POLLIN | (sending ? POLLOUT : 0);
+    if (poll(&p, 1, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      result = -1;
+      break;
+    }
+    if (p.revents & (POLLIN | POLLHUP | POLLERR)) {
+      ssize_t got = read(fd, reply, CHUNK);
+      if (got <= 0) {
+        result = got < 0 ? -1 : 0;
+        break;
+      }
+      fwrite(reply, 1, got, out);
+    }
+    if (sending && (p.revents & POLLOUT)) {
+      ssize_t put = send(fd, buffer + at, held - at, MSG_NOSIGNAL);
+      if (put < 0) {
+        result = -1;
+        break;
+      }
+      at += put;
+    }
+  }
+  close(fd);
+  free(buffer);
+  free(reply);
+  return result;
+}
+
+static void stop(int signal) {
+  (void) signal;
+  stopping = 1;
+}
+
+static int address(char *path, struct sockaddr_un *a) {
+  memset(a, 0, sizeof(*a));
+  a->sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(a->sun_path)) {
+    return -1;
+  }
+  strcpy(a->sun_path, path);
+  return 0;
+}
+
+// accepts every client waiting
+static void admit(SERVER *s) {
+  int fd;
+  while ((fd = accept(s->listener, 0, 0)) >= 0) {
+    CLIENT *c = calloc(1, sizeof(CLIENT));
+    c->fd = fd;
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    c->next = s->clients;
+    if (s->clients) {
+      s->clients->prev = c;
+    }
+    s->clients = c;
+    ++s->served;
+    if (watch(s, c, EPOLLIN) != 0) {
+      drop(s, c);
+    }
+  }
+}
+
+// reads all a client has sent; returns -1 if the connection has failed
+static int receive(CLIENT *c) {
+  while (!c->closing) {
+    if (c->capacity - c->used < CHUNK) {
+      c->capacity = c->capacity * 2 + CHUNK;
+      c->in = realloc(c->in, c->capacity);
+    }
+    ssize_t got = read(c->fd, c->in + c->used, c->capacity - c->used);
+    if (got > 0) {
+      c->used += got;
+    }
+    else if (got == 0) {
+      c->closing = 1;
+    }
+    else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      break;
+    }
+    else if (errno != EINTR) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+// hands the whole commands a client has sent to serve
+static void answer(CLIENT *c, void (*serve)(FILE *, FILE *, void *),
+    void *arg) {
+  long cut = frame(c->in, c->used, c->closing);
+  if (cut > 0) {
+    char *text = 0;
+    size_t size = 0;
+    FILE *in = fmemopen(c->in, cut, "r");
+    FILE *out = open_memstream(&text, &size);
+    serve(in, out, arg);
+    fclose(in);
+    fclose(out);
+    if (c->sent + c->pending + (long) size > 0) {
+      c->out = realloc(c->out, c->sent + c->pending + size);
+      memcpy(c->out + c->sent + c->pending, text, size);
+      c->pending += size;
+    }
+    free(text);
+  }
+  // an unfinished quoted string at the end of a stream is dropped
+  c->used = c->closing ? 0 : c->used - cut;
+  memmove(c->in, c->in + cut, c->used);
+}
+
+/* the length of the whole commands at the start of text, read as the
+* interpreter reads them: a command is a letter, and 'f', 'd', 'i' and 'k'
+* take the next word, or a double-quoted string that may span lines; a
+* cut comes only at a newline between commands; once the client has
+* closed its side every command left is whole, unless a quoted string was
+* never closed
+*/
+static long frame(char *text, long length, int closing) {
+  enum { COMMAND, ARGUMENT, WORD, QUOTED } state = COMMAND;
+  long cut = 0;
+  int command = 0;
+  for (long i = 0; i < length; ++i) {
+    int c = text[i];
+    switch (state) {
+      case COMMAND:
+        if (c == '\n') {
+          cut = i + 1;
+        }
+        else if (c && strchr("fdik", c)) {
+          state = ARGUMENT;
+          command = c;
+        }
+        break;
+      case ARGUMENT:
+        if (c == '"' && command != 'k') {
+          state = QUOTED;
+        }
+        else if (!isspace(c)) {
+          state = WORD;
+        }
+        break;
+      case WORD:
+        if (isspace(c)) {
+          state = COMMAND;
+          cut = c == '\n' ? i + 1 : cut;
+        }
+        break;
+      case QUOTED:
+        if (c == '\\') {
+          ++i;
+        }
+        else if (c == '"') {
+          state = COMMAND;
+        }
+        break;
+    }
+  }
+  return closing && state != QUOTED ? length : cut;
+}
+
+/* writes what a client's socket will take; returns -1 once the client is
+* done with or the connection has failed
+*/
+static int flush(SERVER *s, CLIENT *c) {
+  while (c->pending > 0) {
+    ssize_t put = send(c->fd, c->out + c->sent, c->pending, MSG_NOSIGNAL);
+    if (put > 0) {
+      c->sent += put;
+      c->pending -= put;
+    }
+    else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      break;
+    }
+    else if (errno != EINTR) {
+      return -1;
+    }
+  }
+  if (c->pending == 0) {
+    c->sent = 0;
+    if (c->closing) {
+      return -1;
+    }
+  }
+  // a closing client is waited on only until its output is gone
+  int events = (c->closing ? 0 : EPOLLIN) | (c->pending ? EPOLLOUT : 0);
+  return watch(s, c, events);
+}
+
+static void drop(SERVER *s, CLIENT *c) {
+  if (c->prev) {
+    c->prev->next = c->next;
+  }
+  else {
+    s->clients = c->next;
+  }
+  if (c->next) {
+    c->next->prev = c->prev;
+  }
+  close(c->fd);
+  free(c->in);
+  free(c->out);
+  free(c);
+}
+
+static int watch(SERVER *s, CLIENT *c, int events) {
+  if (events == c->watching) {
+    return 0;
+  }
+  struct epoll_event e;
+  e.events = events;
+  e.data.ptr = c;
+  int op = c->watching ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+  c->watching = events;
+  return epoll_ctl(s->poller, op, c->fd, &e);
+}
@@ -0,0 +1,15 @@
+#ifndef __SERVER_INCLUDED__
+#define __SERVER_INCLUDED__
+
+#include <stdio.h>
+
+typedef struct server SERVER;
+
+extern SERVER *newSERVER(char *path);
+extern int     runSERVER(SERVER *s,void (*serve)(FILE *in,FILE *out,void *arg),
+                 void *arg);
+extern int     clientsSERVER(SERVER *s);
+extern void    freeSERVER(SERVER *s);
+extern int     talkSERVER(char *path,FILE *in,FILE *out);
+
+#endif
@@ -0,0 +1,98 @@
+/*File: sketch.c
+ *Implements functions found in sketch.h: a Count-Min sketch, which counts
+ *a stream of hashed keys in fixed space and never underestimates a count
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "sketch.h"
+
+#define E 2.718281828459045
+
+/* depth rows of width counters; a key adds to one counter per row and its
+* estimate is the smallest of them, which exceeds the true count by more
+* than epsilon times the stream length with probability at most delta
+*/
+struct sketch {
+  double epsilon;
+  double delta;
+  int width;
+  int depth;
+  long total; // the stream length, net of removals
+  long *counts;
+  unsigned long *seeds; // one odd multiplier per row
+};
+
+static int column(SKETCH *s, int row, unsigned long hash);
+static unsigned long mix(unsigned long *state);
+
+// width is e / epsilon and depth ln(1 / delta), both rounded up
+extern SKETCH *newSKETCH(double epsilon, double delta) {
+  SKETCH *s = malloc(sizeof(SKETCH));
+  assert(s != NULL);
+  s->epsilon = epsilon;
+  s->delta = delta;
+  s->width = (int)(E / epsilon);
+  if (s->width < E / epsilon) { ++s->width; }
+  s->depth = 1;
+  for (double p = 1 / E; p > delta; p /= E) { ++s->depth; }
+  s->total = 0;
+  s->counts = calloc((size_t)s->width * s->depth, sizeof(long));
+  s->seeds = malloc(sizeof(unsigned long) * s->depth);
+  assert(s->counts != NULL && s->seeds != NULL);
+  unsigned long state = 0x5ce7c4ULL;
+  for (int i = 0; i < s->depth; ++i) { s->seeds[i] = mix(&state) | 1; }
+  return s;
+}
+
+// count may be negative to take back earlier additions
+extern void addSKETCH(SKETCH *s, unsigned long hash, long count) {
+  for (int i = 0; i < s->depth; ++i) {
+    s->counts[(size_t)i * s->width + column(s, i, hash)] += count;
+  }
+  s->total += count;
+}
+
+extern long estimateSKETCH(SKETCH *s, unsigned long hash) {
+  long least = s->counts[column(s, 0, hash)];
+  for (int i = 1; i < s->depth; ++i) {
+    long c = s->counts[(size_t)i * s->width + column(s, i, hash)];
+    if (c < least) { least = c; }
+  }
+  return least;
+}
+
+extern long totalSKETCH(SKETCH *s) {
+  return s->total;
+}
+
+// the overestimate that an estimate exceeds with probability at most delta
+extern long boundSKETCH(SKETCH *s) {
+  return (long)(s->epsilon * s->total);
+}
+
+extern void statisticsSKETCH(SKETCH *s, FILE *fp) {
+  fprintf(fp, "Sketch: %d x %d counters, epsilon %g, delta %g\n",
+      s->depth, s->width, s->epsilon, s->delta);
+  fprintf(fp, "Stream: %ld, error bound: %ld\n", s->total, boundSKETCH(s));
+}
+
+extern void freeSKETCH(SKETCH *s) {
+  free(s->counts);
+  free(s->seeds);
+  free(s);
+}
+
+// multiply-shift hashing, with the high bits picking the column
+static int column(SKETCH *s, int row, unsigned long hash) {
+  unsigned long long h = (unsigned long long)hash * s->seeds[row];
+  return (int)(((h >> 32) * (unsigned long long)s->width) >> 32);
+}
+
+// splitmix64, to draw the row multipliers
+static unsigned long mix(unsigned long *state) {
+  unsigned long long z = (*state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return (unsigned long)(z ^ (z >> 31));
+}
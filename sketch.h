@@ -0,0 +1,16 @@
+#ifndef __SKETCH_INCLUDED__
+#define __SKETCH_INCLUDED__
+
+#include <stdio.h>
+
+typedef struct sketch SKETCH;
+
+extern SKETCH *newSKETCH(double epsilon,double delta);
+extern void    addSKETCH(SKETCH *s,unsigned long hash,long count);
+extern long    estimateSKETCH(SKETCH *s,unsigned long hash);
+extern long    totalSKETCH(SKETCH *s);
+extern long    boundSKETCH(SKETCH *s);
+extern void    statisticsSKETCH(SKETCH *s,FILE *fp);
+extern void    freeSKETCH(SKETCH *s);
+
+#endif
@@ -38,3 +38,33 @@ void freeSTRING(void *v){
     free(((STRING *)v)->value);
     free((STRING *) v);
 }
+
+unsigned long hashSTRING(void *v){
+    unsigned long long h = 0xcbf29ce484222325ULL;
+    for (char *c = getSTRING(v); *c; ++c) {
+        h = (h ^ (unsigned char) *c) * 0x100000001b3ULL;
+    }
+    return (unsigned long) h;
+}
+
+// writes v for readSTRING, as its length and then its characters
+void writeSTRING(void *v,FILE *fp){
+    char *s = getSTRING(v);
+    int length = strlen(s);
+    fwrite(&length,sizeof(int),1,fp);
+    fwrite(s,1,length,fp);
+}
+
+// returns null if the file ends first
+void *readSTRING(FILE *fp){
+    int length;
+    if (fread(&length,sizeof(int),1,fp) != 1 || length < 0) return 0;
+    char *s = malloc(length + 1);
+    assert(s != 0);
+    if (fread(s,1,length,fp) != (size_t) length) {
+        free(s);
+        return 0;
+    }
+    s[length] = '\0';
+    return newSTRING(s);
+}
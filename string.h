@@ -11,5 +11,8 @@ extern char* setSTRING(STRING *,char*);
 extern int compareSTRING(void *,void *);
 extern void displaySTRING(void *,FILE *);
 extern void freeSTRING(void *);
+extern unsigned long hashSTRING(void *);
+extern void writeSTRING(void *,FILE *);
+extern void *readSTRING(FILE *);
 
 #endif
@@ -19,6 +19,11 @@ struct tnode {
   TNODE * parent;
   FM freeMethod;
   DM displayMethod;
+  // statistics of the subtree rooted here, depths relative to this node
+  int size;
+  int minDepth; // depth of the shallowest node missing a child
+  int maxDepth;
+  long long pathLength; // sum of the depths of every node in the subtree
 };
 
 extern TNODE * newTNODE(void * val, TNODE * l, TNODE * r, TNODE * p) {
@@ -33,6 +38,10 @@ extern TNODE * newTNODE(void * val, TNODE * l, TNODE * r, TNODE * p) {
   node->freeMethod = 0;
   node->displayMethod = 0;
   node->debugVal = 0;
+  node->size = 1;
+  node->minDepth = 0;
+  node->maxDepth = 0;
+  node->pathLength = 0;
 
   return node;
 }
@@ -122,3 +131,50 @@ extern void freeTNODE(TNODE * n) {
   }
   free(n);
 }
+/* recomputes a node's cached subtree statistics from its children's
+* the children must already be up to date
+*/
+extern void refreshTNODE(TNODE * n) {
+  TNODE * l = n->left;
+  TNODE * r = n->right;
+  n->size = 1;
+  n->maxDepth = 0;
+  n->pathLength = 0;
+  if (l) {
+    n->size += l->size;
+    n->maxDepth = l->maxDepth + 1;
+    n->pathLength += l->pathLength + l->size;
+  }
+  if (r) {
+    n->size += r->size;
+    if (r->maxDepth + 1 > n->maxDepth) {
+      n->maxDepth = r->maxDepth + 1;
+    }
+    n->pathLength += r->pathLength + r->size;
+  }
+  if (l == 0 || r == 0) {
+    n->minDepth = 0;
+  }
+  else if (l->minDepth < r->minDepth) {
+    n->minDepth = l->minDepth + 1;
+  }
+  else {
+    n->minDepth = r->minDepth + 1;
+  }
+}
+// returns the number of nodes in the subtree rooted at n
+extern int getTNODEsize(TNODE * n) {
+  return n->size;
+}
+// returns the depth of the shallowest node below n with fewer than two children
+extern int getTNODEminDepth(TNODE * n) {
+  return n->minDepth;
+}
+// returns the depth of the deepest node below n
+extern int getTNODEmaxDepth(TNODE * n) {
+  return n->maxDepth;
+}
+// returns the sum of the depths of every node below n
+extern long long getTNODEpathLength(TNODE * n) {
+  return n->pathLength;
+}
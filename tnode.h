@@ -20,4 +20,11 @@ extern void   displayTNODE(TNODE *n, FILE *fp);
 extern int    debugTNODE(TNODE *n, int level);
 extern void   freeTNODE(TNODE *n);
 
+/* cached subtree statistics, kept current by the owning tree */
+extern void   refreshTNODE(TNODE *n);
+extern int    getTNODEsize(TNODE *n);
+extern int    getTNODEminDepth(TNODE *n);
+extern int    getTNODEmaxDepth(TNODE *n);
+extern long long getTNODEpathLength(TNODE *n);
+
 #endif /* tnode.h */
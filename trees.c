@@ -7,7 +7,9 @@
 #include "interpreter.h"
 
 int main(int argc, char **argv) {
-  int green = 0, rbt = 0;
+  int green = 0, rbt = 0, frozen = 0, saveR = 0, saveG = 0;
+  int mapped = 0, publish = 0, logR = 0, logG = 0, server = 0, client = 0;
+  int stream = 0, compile = 0, binary = 0;
 
   if (argc == 1) printf("%d arguments!\n",argc-1);
 
@@ -19,6 +21,18 @@ int main(int argc, char **argv) {
 
     if (strcmp(argv[i], "-g") == 0) { green = i; }
     if (strcmp(argv[i], "-r") == 0) { rbt = i; }
+    if (strcmp(argv[i], "-q") == 0) { frozen = i; }
+    if (strcmp(argv[i], "-rs") == 0) { saveR = i; }
+    if (strcmp(argv[i], "-gs") == 0) { saveG = i; }
+    if (strcmp(argv[i], "-m") == 0) { mapped = i; }
+    if (strcmp(argv[i], "-ms") == 0) { publish = i; }
+    if (strcmp(argv[i], "-rl") == 0) { logR = i; }
+    if (strcmp(argv[i], "-gl") == 0) { logG = i; }
+    if (strcmp(argv[i], "-u") == 0) { server = i; }
+    if (strcmp(argv[i], "-uc") == 0) { client = i; }
+    if (strcmp(argv[i], "-p") == 0) { stream = i; }
+    if (strcmp(argv[i], "-b") == 0) { compile = i; }
+    if (strcmp(argv[i], "-rb") == 0) { binary = i; }
 
   }
   
@@ -29,6 +43,78 @@ int main(int argc, char **argv) {
     GSTInterpreter(tree, argv, stdout);
     freeGST(tree);
   }
+  else if (frozen) {
+    GST * tree = newGST(compareSTRING);
+    setGSTfree(tree, freeSTRING);
+    setGSTdisplay(tree, displaySTRING);
+    FrozenInterpreter(tree, argv, stdout);
+    freeGST(tree);
+  }
+  else if (saveR) {
+    RBT * tree = newRBT(compareSTRING);
+    setRBTfree(tree, freeSTRING);
+    setRBTdisplay(tree, displaySTRING);
+    RBTSnapshot(tree, argv, stdout);
+    freeRBT(tree);
+  }
+  else if (saveG) {
+    GST * tree = newGST(compareSTRING);
+    setGSTfree(tree, freeSTRING);
+    setGSTdisplay(tree, displaySTRING);
+    GSTSnapshot(tree, argv, stdout);
+    freeGST(tree);
+  }
+  else if (publish) {
+    RBT * tree = newRBT(compareSTRING);
+    setRBTfree(tree, freeSTRING);
+    setRBTdisplay(tree, displaySTRING);
+    RBTPublish(tree, argv, stdout);
+    freeRBT(tree);
+  }
+  else if (mapped) {
+    MappedInterpreter(argv, stdout);
+  }
+  else if (logR) {
+    RBT * tree = newRBT(compareSTRING);
+    setRBTfree(tree, freeSTRING);
+    setRBTdisplay(tree, displaySTRING);
+    RBTJournal(tree, argv, stdout);
+    freeRBT(tree);
+  }
+  else if (logG) {
+    GST * tree = newGST(compareSTRING);
+    setGSTfree(tree, freeSTRING);
+    setGSTdisplay(tree, displaySTRING);
+    GSTJournal(tree, argv, stdout);
+    freeGST(tree);
+  }
+  else if (server) {
+    RBT * tree = newRBT(compareSTRING);
+    setRBTfree(tree, freeSTRING);
+    setRBTdisplay(tree, displaySTRING);
+    RBTServer(tree, argv, stdout);
+    freeRBT(tree);
+  }
+  else if (client) {
+    ClientInterpreter(argv, stdout);
+  }
+  else if (stream) {
+    RBT * tree = newRBT(compareSTRING);
+    setRBTfree(tree, freeSTRING);
+    setRBTdisplay(tree, displaySTRING);
+    RBTStream(tree, argv, stdout);
+    freeRBT(tree);
+  }
+  else if (compile) {
+    CompileCommands(argv, stdout);
+  }
+  else if (binary) {
+    RBT * tree = newRBT(compareSTRING);
+    setRBTfree(tree, freeSTRING);
+    setRBTdisplay(tree, displaySTRING);
+    RBTBinary(tree, argv, stdout);
+    freeRBT(tree);
+  }
   else if (rbt == 1 || (rbt == 0 && green == 0)) {
     RBT * tree = newRBT(compareSTRING);
 	setRBTfree(tree, freeSTRING);
@@ -37,7 +123,7 @@ int main(int argc, char **argv) {
     freeRBT(tree);
   }
   else {
-    printf("Error: invalid flag. Valid flags are: '-v' | '-g' | '-r'\n");
+    printf("Error: invalid flag. Valid flags are: '-v' | '-g' | '-r' | '-q' | '-rs' | '-gs' | '-m' | '-ms' | '-rl' | '-gl' | '-u' | '-uc' | '-p' | '-b' | '-rb'\n");
   }
 
   return 0;
@@ -0,0 +1,334 @@
+/*File: wal.c
+ *Implements functions found in wal.h: an append-only log of changes to a
+ *tree, kept beside snapshots of it, from which the tree can be rebuilt
+ *after a crash
+*/
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "wal.h"
+
+// the first bytes of a log, the last being the format's version
+#define MAGIC "WAL\001"
+
+// a key longer than this marks a damaged record
+#define LONGEST (1 << 24)
+
+/* a log starts with a header naming its generation, and then holds one
+* record per change: the operation's byte, the key's length, seven bits a
+* byte, the key and a checksum of all three; a checkpoint writes the tree
+* to the snapshot of the next generation and then starts a log of that
+* generation by renaming a fresh one over the old, fsyncing the directory
+* after each rename and before the old snapshot is removed, so a crash at
+* any point leaves a log and the snapshot it follows, and recovery replays
+* only the changes made since; records gather in memory and reach the disk
+* in groups, one write and one fsync committing each, so a crash loses at
+* most the group in progress
+*/
+struct wal {
+  char *path;
+  char *name; // the snapshot the log follows, or the next one
+  FILE *fp; // read in replay; records are written to its descriptor
+  char *buffer; // the group in progress
+  int used;
+  int capacity;
+  int generation; // 0 until the first checkpoint, which has no snapshot
+  int group; // records appended between fsyncs
+  int pending; // records appended since the last fsync
+  int replayed;
+  long records; // records since the last checkpoint
+};
+
+static int start(char *path, int generation, FILE **stream);
+static void label(WAL *w, int generation);
+static int settle(char *path);
+static uint32_t checksum(int op, char *key, int length);
+static int getCount(FILE *fp, unsigned long *n);
+static int getByte(FILE *fp, int *c);
+
+/* opens the log at path, or starts one if there is none; returns 0 if the
+* file is not a log or cannot be written; replay it before logging
+*/
+extern WAL *openWAL(char *path, int group) {
+  if (access(path, F_OK) != 0 && start(path, 0, 0) != 0) {
+    return 0;
+  }
+  FILE * fp = fopen(path, "r+b");
+  unsigned char head[8];
+  if (fp == 0) {
+    return 0;
+  }
+  if (fread(head, 1, 8, fp) != 8 || memcmp(head, MAGIC, 4) != 0) {
+    fclose(fp);
+    return 0;
+  }
+  WAL * w = malloc(sizeof(WAL));
+  assert(w != NULL);
+  w->path = malloc(strlen(path) + 1);
+  w->name = malloc(strlen(path) + 16);
+  assert(w->path != NULL && w->name != NULL);
+  strcpy(w->path, path);
+  w->fp = fp;
+  w->capacity = 4096;
+  w->used = 0;
+  w->buffer = malloc(w->capacity);
+  assert(w->buffer != NULL);
+  w->group = group > 0 ? group : 1;
+  w->pending = 0;
+  w->replayed = 0;
+  w->records = 0;
+  label(w, head[4] | head[5] << 8 | head[6] << 16 | (int)head[7] << 24);
+  return w;
+}
+
+// the snapshot to load before replaying the log, or 0 if there is none yet
+extern char *snapshotWAL(WAL *w) {
+  return w->generation ? w->name : 0;
+}
+
+/* passes each record in the log to apply, oldest first, and returns their
+* number; a damaged or partly written record ends the log, and it and all
+* after it are cut off, so new records follow the last good one
+*/
+extern long replayWAL(WAL *w, void (*apply)(int op, char *key, int length,
+    void * arg), void *arg) {
+  assert(w->replayed == 0);
+  long good = 8;
+  int capacity = 64;
+  char * key = malloc(capacity);
+  assert(key != NULL);
+  for (;;) {
+    int op, c;
+    unsigned long length;
+    uint32_t sum = 0;
+    if (getByte(w->fp, &op) != 0 || getCount(w->fp, &length) != 0
+        || length > LONGEST) {
+      break;
+    }
+    if ((int)length >= capacity) {
+      capacity = (int)length + 1;
+      key = realloc(key, capacity);
+      assert(key != NULL);
+    }
+    if (fread(key, 1, length, w->fp) != length) {
+      break;
+    }
+    int ok = 1;
+    for (int i = 0; ok && i < 4; ++i) {
+      ok = getByte(w->fp, &c) == 0;
+      sum |= (uint32_t)c << (8 * i);
+    }
+    if (!ok || sum != checksum(op, key, (int)length)) {
+      break;
+    }
+    key[length] = '\0';
+    apply(op, key, (int)length, arg);
+    ++w->records;
+    good = ftell(w->fp);
+  }
+  free(key);
+  if (ftruncate(fileno(w->fp), good) != 0) {
+    good = -1;
+  }
+  w->replayed = 1;
+  return good < 0 ? -1 : w->records;
+}
+
+// appends a record of op on key, committing the group once it is full
+extern void logWAL(WAL *w, int op, char *key, int length) {
+  uint32_t sum = checksum(op, key, length);
+  w->replayed = 1;
+  if (w->used + length + 16 > w->capacity) {
+    while (w->used + length + 16 > w->capacity) {
+      w->capacity *= 2;
+    }
+    w->buffer = realloc(w->buffer, w->capacity);
+    assert(w->buffer != NULL);
+  }
+  unsigned char * at = (unsigned char *)w->buffer + w->used;
+  *at++ = (unsigned char)op;
+  for (unsigned long n = (unsigned long)length; ; n >>= 7) {
+    *at++ = (n & 0x7f) | (n >= 0x80 ? 0x80 : 0);
+    if (n < 0x80) {
+      break;
+    }
+  }
+  memcpy(at, key, length);
+  at += length;
+  for (int i = 0; i < 4; ++i) {
+    *at++ = (sum >> (8 * i)) & 0xff;
+  }
+  w->used = (int)(at - (unsigned char *)w->buffer);
+  ++w->records;
+  if (++w->pending >= w->group) {
+    syncWAL(w);
+  }
+}
+
+// commits every record appended so far; returns 0, or -1 on failure
+extern int syncWAL(WAL *w) {
+  int fd = fileno(w->fp), done = 0;
+  w->pending = 0;
+  if (lseek(fd, 0, SEEK_END) < 0) {
+    return -1;
+  }
+  while (done < w->used) {
+    ssize_t wrote = write(fd, w->buffer + done, w->used - done);
+    if (wrote <= 0) {
+      return -1;
+    }
+    done += (int)wrote;
+  }
+  w->used = 0;
+  return fsync(fd) == 0 ? 0 : -1;
+}
+
+// the records logged, or replayed, since the last checkpoint
+extern long recordsWAL(WAL *w) {
+  return w->records;
+}
+
+/* has save write the tree to the path it is given, then starts the log
+* afresh; returns 0, or -1, with the log going on as before, if the
+* snapshot or the new log cannot be written
+*/
+extern int checkpointWAL(WAL *w, int (*save)(char *path, void * arg),
+    void *arg) {
+  char * old = malloc(strlen(w->name) + 1);
+  char * temporary = malloc(strlen(w->path) + 24);
+  assert(old != NULL && temporary != NULL);
+  strcpy(old, w->name);
+  int previous = w->generation, fd = -1;
+  label(w, previous + 1);
+  sprintf(temporary, "%s.tmp", w->name);
+  int ok = syncWAL(w) == 0 && save(temporary, arg) == 0
+      && (fd = open(temporary, O_RDONLY)) >= 0 && fsync(fd) == 0
+      && rename(temporary, w->name) == 0 && settle(w->name) == 0;
+  if (fd >= 0) {
+    close(fd);
+  }
+  FILE * fp = 0;
+  // the old log and snapshot stay in force until start renames the new
+  // log over the old, which commits the checkpoint; nothing after it fails
+  ok = ok && start(w->path, w->generation, &fp) == 0;
+  if (ok) {
+    fclose(w->fp);
+    w->fp = fp;
+    w->records = 0;
+    w->pending = 0;
+    // the old snapshot is needed until the new log's rename is on disk
+    if (previous && settle(w->path) == 0) {
+      remove(old);
+    }
+  }
+  else {
+    remove(temporary);
+    remove(w->name);
+    label(w, previous);
+  }
+  free(old);
+  free(temporary);
+  return ok ? 0 : -1;
+}
+
+// commits the last group and closes the log
+extern void closeWAL(WAL *w) {
+  syncWAL(w);
+  fclose(w->fp);
+  free(w->buffer);
+  free(w->path);
+  free(w->name);
+  free(w);
+}
+
+/* writes an empty log of the given generation over any at path, leaving
+* it open in *stream if stream is not null, so once the log is in place
+* there is nothing left to fail
+*/
+static int start(char *path, int generation, FILE **stream) {
+  char * temporary = malloc(strlen(path) + 8);
+  assert(temporary != NULL);
+  sprintf(temporary, "%s.tmp", path);
+  unsigned char head[8] = { 'W', 'A', 'L', 1, generation & 0xff,
+    (generation >> 8) & 0xff, (generation >> 16) & 0xff,
+    (generation >> 24) & 0xff };
+  FILE * fp = fopen(temporary, "w+b");
+  int ok = fp != 0 && fwrite(head, 1, 8, fp) == 8 && fflush(fp) == 0
+      && fsync(fileno(fp)) == 0 && rename(temporary, path) == 0;
+  if (ok && stream) {
+    *stream = fp;
+  }
+  else if (fp) {
+    fclose(fp);
+  }
+  if (!ok) {
+    remove(temporary);
+  }
+  free(temporary);
+  return ok ? 0 : -1;
+}
+
+// sets the log's generation and the name of its snapshot
+static void label(WAL *w, int generation) {
+  w->generation = generation;
+  sprintf(w->name, "%s.%d", w->path, generation);
+}
+
+// fsyncs the directory holding path, so a rename into it survives a crash
+static int settle(char *path) {
+  char * directory = malloc(strlen(path) + 2);
+  assert(directory != NULL);
+  strcpy(directory, path);
+  char * slash = strrchr(directory, '/');
+  if (slash == 0) {
+    strcpy(directory, ".");
+  }
+  else {
+    slash[slash == directory ? 1 : 0] = '\0';
+  }
+  int fd = open(directory, O_RDONLY);
+  int ok = fd >= 0 && fsync(fd) == 0;
+  if (fd >= 0) {
+    close(fd);
+  }
+  free(directory);
+  return ok ? 0 : -1;
+}
+
+// FNV-1a over the operation, the length and the key
+static uint32_t checksum(int op, char *key, int length) {
+  uint32_t h = 2166136261u;
+  h = (h ^ (uint32_t)(op & 0xff)) * 16777619u;
+  for (int i = 0; i < 4; ++i) {
+    h = (h ^ (((uint32_t)length >> (8 * i)) & 0xff)) * 16777619u;
+  }
+  for (int i = 0; i < length; ++i) {
+    h = (h ^ (unsigned char)key[i]) * 16777619u;
+  }
+  return h;
+}
+
+// reads a count written seven bits a byte, low bits first, the high bit
+// marking more
+static int getCount(FILE *fp, unsigned long *n) {
+  int c, shift = 0;
+  *n = 0;
+  do {
+    if (shift > 28 || getByte(fp, &c) != 0) {
+      return -1;
+    }
+    *n |= (unsigned long)(c & 0x7f) << shift;
+    shift += 7;
+  } while (c & 0x80);
+  return 0;
+}
+
+static int getByte(FILE *fp, int *c) {
+  *c = fgetc(fp);
+  return *c == EOF ? -1 : 0;
+}
@@ -0,0 +1,16 @@
+#ifndef __WAL_INCLUDED__
+#define __WAL_INCLUDED__
+
+typedef struct wal WAL;
+
+extern WAL  *openWAL(char *path,int group);
+extern char *snapshotWAL(WAL *w);
+extern long  replayWAL(WAL *w,void (*apply)(int op,char *key,int length,void *arg),
+               void *arg);
+extern void  logWAL(WAL *w,int op,char *key,int length);
+extern int   syncWAL(WAL *w);
+extern long  recordsWAL(WAL *w);
+extern int   checkpointWAL(WAL *w,int (*save)(char *path,void *arg),void *arg);
+extern void  closeWAL(WAL *w);
+
+#endif